@@ -6,6 +6,7 @@
 
 #include <osmium/handler.hpp>
 #include <osmium/io/any_input.hpp>
+#include <osmium/parallel_visitor.hpp>
 #include <osmium/visitor.hpp>
 
 #include <cstdint>
@@ -34,21 +35,38 @@ struct CountHandler : public osmium::handler::Handler {
         ++all;
     }
 
+    void merge(const CountHandler& other) {
+        counter += other.counter;
+        all += other.all;
+    }
+
 };
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " OSMFILE\n";
+    if (argc != 2 && argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE [serial|parallel]\n";
         return 1;
     }
 
     try {
         const std::string input_filename{argv[1]};
+        const std::string mode{argc == 3 ? argv[2] : "serial"};
 
         osmium::io::Reader reader{input_filename};
 
         CountHandler handler;
-        osmium::apply(reader, handler);
+        if (mode == "serial") {
+            osmium::apply(reader, handler);
+        } else if (mode == "parallel") {
+            handler = osmium::parallel_apply_reduce(reader, []() {
+                return CountHandler{};
+            }, [](CountHandler& result, CountHandler&& other) {
+                result.merge(other);
+            });
+        } else {
+            std::cerr << "Unknown mode: " << mode << '\n';
+            return 1;
+        }
         reader.close();
 
         std::cout << "r_all=" << handler.all << " r_counter=" << handler.counter << '\n';
@@ -0,0 +1,125 @@
+/*
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+#include <osmium/area/detail/segment_list.hpp>
+#include <osmium/handler/node_locations_for_ways.hpp>
+#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/io/any_input.hpp>
+#include <osmium/relations/relations_manager.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+
+using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
+
+enum class algorithm {
+    automatic,
+    nested_loop,
+    sweep
+};
+
+class IntersectionsManager : public osmium::relations::RelationsManager<IntersectionsManager, false, true, false> {
+
+    algorithm m_algorithm;
+
+public:
+
+    uint64_t relations = 0;
+    uint64_t segments = 0;
+    uint64_t intersections = 0;
+
+    explicit IntersectionsManager(algorithm algo) :
+        m_algorithm(algo) {
+    }
+
+    bool new_relation(const osmium::Relation& relation) const {
+        const char* type = relation.tags().get_value_by_key("type");
+        return type && (!std::strcmp(type, "multipolygon") || !std::strcmp(type, "boundary"));
+    }
+
+    void complete_relation(const osmium::Relation& relation) {
+        std::vector<const osmium::Way*> ways;
+        for (const auto& member : relation.members()) {
+            if (member.ref() != 0) {
+                ways.push_back(this->get_member_way(member.ref()));
+            }
+        }
+
+        osmium::area::detail::SegmentList segment_list{false};
+        uint64_t duplicate_nodes = 0;
+        uint64_t duplicate_ways = 0;
+        uint64_t duplicate_segments = 0;
+        uint64_t overlapping_segments = 0;
+        segment_list.extract_segments_from_ways(nullptr, duplicate_nodes, duplicate_ways, relation, ways);
+        segment_list.sort();
+        segment_list.erase_duplicate_segments(nullptr, duplicate_segments, overlapping_segments);
+
+        ++relations;
+        segments += segment_list.size();
+        switch (m_algorithm) {
+            case algorithm::automatic:
+                intersections += segment_list.find_intersections(nullptr);
+                break;
+            case algorithm::nested_loop:
+                intersections += segment_list.find_intersections_nested_loop(nullptr);
+                break;
+            case algorithm::sweep:
+                intersections += segment_list.find_intersections_sweep(nullptr);
+                break;
+        }
+    }
+
+};
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE ALGORITHM\n"
+                  << "ALGORITHM can be 'auto', 'nested_loop', or 'sweep'.\n";
+        return 1;
+    }
+
+    try {
+        const osmium::io::File input_file{argv[1]};
+        const std::string algorithm_name{argv[2]};
+
+        algorithm algo = algorithm::automatic;
+        if (algorithm_name == "nested_loop") {
+            algo = algorithm::nested_loop;
+        } else if (algorithm_name == "sweep") {
+            algo = algorithm::sweep;
+        } else if (algorithm_name != "auto") {
+            std::cerr << "Unknown algorithm '" << algorithm_name << "'\n";
+            return 1;
+        }
+
+        IntersectionsManager manager{algo};
+        osmium::relations::read_relations(input_file, manager);
+
+        index_type index;
+        location_handler_type location_handler{index};
+        location_handler.ignore_errors();
+
+        osmium::io::Reader reader{input_file};
+        osmium::apply(reader, location_handler, manager.handler());
+        reader.close();
+
+        std::cout << "Relations: "     << manager.relations     << '\n';
+        std::cout << "Segments: "      << manager.segments      << '\n';
+        std::cout << "Intersections: " << manager.intersections << '\n';
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -14,7 +14,9 @@
 #include <cstdlib>
 #include <iostream>
 #include <string>
+#include <vector>
 
+// Create WKB point geometries in mercator projection.
 struct GeomHandler : public osmium::handler::Handler {
 
     osmium::geom::WKBFactory<osmium::geom::MercatorProjection> factory;
@@ -25,19 +27,84 @@ struct GeomHandler : public osmium::handler::Handler {
 
 };
 
+// Project node locations one by one.
+struct ProjectHandler : public osmium::handler::Handler {
+
+    osmium::geom::MercatorProjection projection;
+    double sum = 0.0;
+
+    void node(const osmium::Node& node) {
+        const auto c = projection(node.location());
+        sum += c.x + c.y;
+    }
+
+};
+
+// Collect node locations and project them in batches.
+struct BatchProjectHandler : public osmium::handler::Handler {
+
+    enum : std::size_t {
+        batch_size = 1024
+    };
+
+    osmium::geom::MercatorProjection projection;
+    std::vector<osmium::Location> locations;
+    std::vector<double> x;
+    std::vector<double> y;
+    double sum = 0.0;
+
+    BatchProjectHandler() :
+        x(batch_size),
+        y(batch_size) {
+        locations.reserve(batch_size);
+    }
+
+    void flush() {
+        projection(locations.data(), locations.size(), x.data(), y.data());
+        for (std::size_t i = 0; i < locations.size(); ++i) {
+            sum += x[i] + y[i];
+        }
+        locations.clear();
+    }
+
+    void node(const osmium::Node& node) {
+        locations.push_back(node.location());
+        if (locations.size() == batch_size) {
+            flush();
+        }
+    }
+
+};
+
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " OSMFILE\n";
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE [wkb|single|batch]\n";
         return 1;
     }
 
     try {
         const std::string input_filename{argv[1]};
+        const std::string mode{argc == 3 ? argv[2] : "wkb"};
 
         osmium::io::Reader reader{input_filename};
 
-        GeomHandler handler;
-        osmium::apply(reader, handler);
+        if (mode == "wkb") {
+            GeomHandler handler;
+            osmium::apply(reader, handler);
+        } else if (mode == "single") {
+            ProjectHandler handler;
+            osmium::apply(reader, handler);
+            std::cout << handler.sum << '\n';
+        } else if (mode == "batch") {
+            BatchProjectHandler handler;
+            osmium::apply(reader, handler);
+            handler.flush();
+            std::cout << handler.sum << '\n';
+        } else {
+            std::cerr << "Unknown mode: " << mode << '\n';
+            return 1;
+        }
+
         reader.close();
     } catch (const std::exception& e) {
         std::cerr << e.what() << '\n';
@@ -46,4 +113,3 @@ int main(int argc, char* argv[]) {
 
     return 0;
 }
-
@@ -0,0 +1,25 @@
+#!/bin/sh
+#
+#  run_benchmark_find_intersections.sh
+#
+
+set -e
+
+BENCHMARK_NAME=find_intersections
+
+. @CMAKE_BINARY_DIR@/benchmarks/setup.sh
+
+CMD=$OB_DIR/osmium_benchmark_$BENCHMARK_NAME
+
+ALGORITHMS="nested_loop sweep auto"
+
+echo "# file size num mem time cpu_kernel cpu_user cpu_percent cmd options"
+for data in $OB_DATA_FILES; do
+    filename=`basename $data`
+    filesize=`stat --format="%s" --dereference $data`
+    for algorithm in $ALGORITHMS; do
+        for n in $OB_SEQ; do
+            $OB_TIME_CMD -f "$filename $filesize $n $OB_TIME_FORMAT" $CMD $data $algorithm 2>&1 >/dev/null | sed -e "s%$DATA_DIR/%%" | sed -e "s%$OB_DIR/%%"
+        done
+    done
+done
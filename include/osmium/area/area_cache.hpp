@@ -0,0 +1,332 @@
+#ifndef OSMIUM_AREA_AREA_CACHE_HPP
+#define OSMIUM_AREA_AREA_CACHE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/memory/item.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/crc.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace osmium {
+
+    namespace area {
+
+        namespace detail {
+
+            // Layout of a file written by AreaCacheWriter. All numbers are
+            // in native byte order. The file starts with the header,
+            // followed by one record for each area. A record is a record
+            // header followed by the area as it is stored in a buffer
+            // (padded to a multiple of 8 bytes).
+
+            struct area_cache_file_header {
+                char magic[8];
+            };
+
+            struct area_cache_record_header {
+                uint64_t fingerprint;
+                uint64_t size;
+            };
+
+            constexpr const char area_cache_file_magic[8] = {'O', 'S', 'M', 'A', 'R', 'C', '0', '1'};
+
+            /**
+             * 64 bit FNV-1a hash for use with the osmium::CRC class. The
+             * fingerprints of the inputs of millions of areas are compared,
+             * a 32 bit checksum would give false matches too often.
+             */
+            class fingerprint_hash {
+
+                uint64_t m_hash = 0xcbf29ce484222325ULL;
+
+            public:
+
+                void process_byte(const unsigned char byte) noexcept {
+                    m_hash ^= byte;
+                    m_hash *= 0x100000001b3ULL;
+                }
+
+                void process_bytes(const void* buffer, std::size_t byte_count) noexcept {
+                    const auto* data = static_cast<const unsigned char*>(buffer);
+                    for (std::size_t i = 0; i < byte_count; ++i) {
+                        process_byte(data[i]);
+                    }
+                }
+
+                uint64_t checksum() const noexcept {
+                    return m_hash;
+                }
+
+            }; // class fingerprint_hash
+
+        } // namespace detail
+
+        /**
+         * Calculate the fingerprint of the input needed to assemble an
+         * area from a closed way. This covers all attributes and tags of
+         * the way and the IDs and locations of its nodes.
+         */
+        inline uint64_t area_fingerprint(const osmium::Way& way) noexcept {
+            osmium::CRC<detail::fingerprint_hash> crc;
+            crc.update(way);
+            return crc().checksum();
+        }
+
+        /**
+         * Calculate the fingerprint of the input needed to assemble an
+         * area from a multipolygon relation and its member ways.
+         */
+        inline uint64_t area_fingerprint(const osmium::Relation& relation, const std::vector<const osmium::Way*>& members) noexcept {
+            osmium::CRC<detail::fingerprint_hash> crc;
+            crc.update(relation);
+            for (const osmium::Way* way : members) {
+                crc.update(*way);
+            }
+            return crc().checksum();
+        }
+
+        /**
+         * Writes areas together with the fingerprints of their input into
+         * a file that can be read with the AreaCache class on the next run.
+         * The format uses the native byte order, so it is not portable
+         * between machines with different endianness.
+         */
+        class AreaCacheWriter {
+
+            enum : std::size_t {
+                max_buffer_size = 1024UL * 1024UL
+            };
+
+            std::vector<char> m_buffer;
+            int m_fd;
+            std::size_t m_count = 0;
+
+            template <typename T>
+            void append(const T* data, std::size_t size) {
+                const auto* begin = reinterpret_cast<const char*>(data);
+                m_buffer.insert(m_buffer.end(), begin, begin + size);
+            }
+
+            void flush() {
+                if (!m_buffer.empty()) {
+                    osmium::io::detail::reliable_write(m_fd, m_buffer.data(), m_buffer.size());
+                    m_buffer.clear();
+                }
+            }
+
+        public:
+
+            /**
+             * Create a new area cache file.
+             *
+             * @param fd File descriptor of the file to write to. The
+             *           caller is responsible for closing it after close()
+             *           was called.
+             * @throws std::system_error If the file could not be written.
+             */
+            explicit AreaCacheWriter(const int fd) :
+                m_fd(fd) {
+                m_buffer.reserve(max_buffer_size);
+                detail::area_cache_file_header header; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+                std::copy_n(detail::area_cache_file_magic, sizeof(header.magic), header.magic);
+                append(&header, sizeof(header));
+            }
+
+            AreaCacheWriter(const AreaCacheWriter&) = delete;
+            AreaCacheWriter& operator=(const AreaCacheWriter&) = delete;
+
+            AreaCacheWriter(AreaCacheWriter&&) = delete;
+            AreaCacheWriter& operator=(AreaCacheWriter&&) = delete;
+
+            ~AreaCacheWriter() noexcept {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            /**
+             * Add an area to the cache.
+             *
+             * @param area The area.
+             * @param fingerprint The fingerprint of the input the area was
+             *                    assembled from (see area_fingerprint()).
+             * @throws std::system_error If the file could not be written.
+             */
+            void add(const osmium::Area& area, uint64_t fingerprint) {
+                const detail::area_cache_record_header header{fingerprint, area.padded_size()};
+                append(&header, sizeof(header));
+                append(&area, area.padded_size());
+                ++m_count;
+                if (m_buffer.size() >= max_buffer_size) {
+                    flush();
+                }
+            }
+
+            /// The number of areas written.
+            std::size_t size() const noexcept {
+                return m_count;
+            }
+
+            /**
+             * Write out all buffered data. Call this before closing the
+             * file descriptor.
+             *
+             * @throws std::system_error If the file could not be written.
+             */
+            void close() {
+                flush();
+            }
+
+        }; // class AreaCacheWriter
+
+        /**
+         * Read-only access to areas written to a file with the
+         * AreaCacheWriter. The file is memory mapped, the areas are used
+         * directly from the mapped data. This is used to get an area
+         * assembled on an earlier run if its input didn't change.
+         *
+         * The cache doesn't know which AssemblerConfig was used to
+         * assemble the areas. Use a new cache if the config changes.
+         */
+        class AreaCache {
+
+            struct entry {
+                osmium::object_id_type id;
+                uint64_t fingerprint;
+                std::size_t offset;
+
+                bool operator<(const entry& other) const noexcept {
+                    return id < other.id;
+                }
+            };
+
+            osmium::util::MemoryMapping m_mapping;
+            std::vector<entry> m_index;
+
+            static std::size_t check_size(std::size_t size) {
+                if (size < sizeof(detail::area_cache_file_header)) {
+                    throw std::runtime_error{"Area cache file too small"};
+                }
+                return size;
+            }
+
+        public:
+
+            /**
+             * Map area cache file and build the index of all areas in it.
+             *
+             * @param fd File descriptor of file written by AreaCacheWriter.
+             * @throws std::runtime_error If the file format is wrong.
+             * @throws std::system_error If the mapping fails.
+             */
+            explicit AreaCache(const int fd) :
+                m_mapping(check_size(osmium::file_size(fd)), osmium::util::MemoryMapping::mapping_mode::readonly, fd) {
+                const char* data = m_mapping.get_addr<const char>();
+                if (!std::equal(detail::area_cache_file_magic, detail::area_cache_file_magic + sizeof(detail::area_cache_file_magic), data)) {
+                    throw std::runtime_error{"Not an area cache file"};
+                }
+
+                const std::size_t size = m_mapping.size();
+                std::size_t offset = sizeof(detail::area_cache_file_header);
+                while (offset < size) {
+                    if (size - offset < sizeof(detail::area_cache_record_header)) {
+                        throw std::runtime_error{"Area cache file truncated"};
+                    }
+                    const auto* header = reinterpret_cast<const detail::area_cache_record_header*>(data + offset);
+                    offset += sizeof(detail::area_cache_record_header);
+                    if (header->size < sizeof(osmium::Area) || header->size > size - offset) {
+                        throw std::runtime_error{"Area cache file truncated"};
+                    }
+                    const auto& item = *reinterpret_cast<const osmium::memory::Item*>(data + offset);
+                    if (item.type() != osmium::item_type::area || item.padded_size() != header->size) {
+                        throw std::runtime_error{"Invalid area in area cache file"};
+                    }
+                    m_index.push_back({static_cast<const osmium::Area&>(item).id(), header->fingerprint, offset});
+                    offset += header->size;
+                }
+
+                std::stable_sort(m_index.begin(), m_index.end());
+            }
+
+            /// The number of areas in the cache.
+            std::size_t size() const noexcept {
+                return m_index.size();
+            }
+
+            /// Is the cache empty?
+            bool empty() const noexcept {
+                return m_index.empty();
+            }
+
+            /**
+             * Get the area with the specified id if it was assembled from
+             * input with the specified fingerprint.
+             *
+             * @param area_id The ID of the area.
+             * @param fingerprint The fingerprint of the current input.
+             * @returns Pointer to the area or nullptr if there is no such
+             *          area in the cache or if it was assembled from
+             *          different input.
+             */
+            const osmium::Area* get(osmium::object_id_type area_id, uint64_t fingerprint) const noexcept {
+                const auto range = std::equal_range(m_index.begin(), m_index.end(), entry{area_id, 0, 0});
+                for (auto it = range.first; it != range.second; ++it) {
+                    if (it->fingerprint == fingerprint) {
+                        return reinterpret_cast<const osmium::Area*>(m_mapping.get_addr<const char>() + it->offset);
+                    }
+                }
+                return nullptr;
+            }
+
+        }; // class AreaCache
+
+    } // namespace area
+
+} // namespace osmium
+
+#endif // OSMIUM_AREA_AREA_CACHE_HPP
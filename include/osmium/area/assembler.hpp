@@ -57,6 +57,12 @@ namespace osmium {
         /**
          * Assembles area objects from closed ways or multipolygon relations
          * and their members.
+         *
+         * An assembler can be used for any number of ways and relations,
+         * one after the other. The memory it needs internally is kept
+         * between runs, so it is much cheaper to reuse an assembler than to
+         * create a new one for each object. Assemblers are not thread-safe,
+         * use one per thread. The stats() always refer to the last run.
          */
         class Assembler : public detail::BasicAssemblerWithTags {
 
@@ -119,6 +125,8 @@ namespace osmium {
              *          area, true otherwise.
              */
             bool operator()(const osmium::Way& way, osmium::memory::Buffer& out_buffer) {
+                reset();
+
                 if (!config().create_way_polygons) {
                     return true;
                 }
@@ -177,6 +185,8 @@ namespace osmium {
              *          area(s), true otherwise.
              */
             bool operator()(const osmium::Relation& relation, const std::vector<const osmium::Way*>& members, osmium::memory::Buffer& out_buffer) {
+                reset();
+
                 if (!config().create_new_style_polygons) {
                     return true;
                 }
@@ -35,6 +35,9 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/util/compatibility.hpp>
 
+#include <chrono>
+#include <cstdint>
+
 namespace osmium {
 
     namespace area {
@@ -124,6 +127,29 @@ namespace osmium {
              */
             bool ignore_invalid_locations = false;
 
+            /**
+             * Maximum amount of work the assembler is allowed to do for a
+             * single area. The work is counted in the inner loops of the
+             * assembler, so it is roughly proportional to the run time. The
+             * work needed is available from area_stats::work after each
+             * run. If the limit is exceeded, the assembler stops, reports
+             * this through ProblemReporter::report_assembly_aborted() and
+             * treats the area as invalid.
+             *
+             * If this is set to 0 (the default), there is no limit.
+             */
+            uint64_t max_work = 0;
+
+            /**
+             * Maximum (wall clock) time the assembler is allowed to take for
+             * a single area. This works like max_work. The clock is only
+             * checked every few thousand work units, so the limit can be
+             * exceeded a little.
+             *
+             * If this is set to 0 (the default), there is no limit.
+             */
+            std::chrono::milliseconds max_time{0};
+
             AssemblerConfig() noexcept = default;
 
             /**
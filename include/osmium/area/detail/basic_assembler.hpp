@@ -49,11 +49,14 @@ DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <exception>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <list>
 #include <unordered_map>
 #include <unordered_set>
@@ -97,10 +100,84 @@ namespace osmium {
                 return lhs.location < rhs.location;
             }
 
+            /**
+             * Index over the x ranges of the segments in a sorted
+             * SegmentList. It is a binary tree over the segment positions
+             * storing the largest x coordinate of the second (right)
+             * location of all segments below each node. This allows finding
+             * all segments at or before some position in the list that
+             * reach at least to some x coordinate without looking at all the
+             * segments that end before it.
+             */
+            class segment_x_index {
+
+                std::vector<int32_t> m_max_x;
+                std::size_t m_leaves = 0;
+
+                template <typename TFunc>
+                void visit(std::size_t node, std::size_t lo, std::size_t hi, std::size_t last, int32_t x, TFunc&& func) const {
+                    if (lo > last || m_max_x[node] < x) {
+                        return;
+                    }
+                    if (hi - lo == 1) {
+                        std::forward<TFunc>(func)(lo);
+                        return;
+                    }
+                    const std::size_t mid = lo + (hi - lo) / 2;
+                    visit(node * 2 + 1, mid, hi, last, x, func);
+                    visit(node * 2, lo, mid, last, x, func);
+                }
+
+            public:
+
+                bool empty() const noexcept {
+                    return m_max_x.empty();
+                }
+
+                void clear() noexcept {
+                    m_max_x.clear();
+                    m_leaves = 0;
+                }
+
+                void build(const SegmentList& segments) {
+                    m_leaves = 1;
+                    while (m_leaves < segments.size()) {
+                        m_leaves *= 2;
+                    }
+                    m_max_x.assign(m_leaves * 2, std::numeric_limits<int32_t>::min());
+                    std::size_t n = 0;
+                    for (const auto& segment : segments) {
+                        m_max_x[m_leaves + n] = segment.second().location().x();
+                        ++n;
+                    }
+                    for (std::size_t i = m_leaves - 1; i > 0; --i) {
+                        m_max_x[i] = std::max(m_max_x[i * 2], m_max_x[i * 2 + 1]);
+                    }
+                }
+
+                /**
+                 * Call func with the position of all segments at positions
+                 * up to and including last whose second location has an
+                 * x coordinate of at least x. The positions are visited in
+                 * descending order.
+                 */
+                template <typename TFunc>
+                void for_each_reaching(std::size_t last, int32_t x, TFunc&& func) const {
+                    if (!m_max_x.empty()) {
+                        visit(1, 0, m_leaves, last, x, std::forward<TFunc>(func));
+                    }
+                }
+
+            }; // class segment_x_index
+
             /**
              * Class for assembling ways and relations into multipolygons
              * (areas). Contains the basic functionality needed but is not
              * used directly. Use the osmium::area::Assembler class instead.
+             *
+             * Derived classes must call reset() at the start of each run,
+             * the assembler can then be reused without allocating all its
+             * data structures again.
              */
             class BasicAssembler {
 
@@ -159,18 +236,74 @@ namespace osmium {
                 // The rings we are building from the segments
                 std::list<ProtoRing> m_rings;
 
+                // Rings not in use any more. They are kept around so that
+                // their memory can be reused for new rings.
+                std::list<ProtoRing> m_spare_rings;
+
                 // All node locations
                 std::vector<slocation> m_locations;
 
                 // All locations where more than two segments start/end
                 std::vector<Location> m_split_locations;
 
+                // Index over the x ranges of the segments in m_segment_list,
+                // built on first use by find_enclosing_ring()
+                segment_x_index m_segment_index;
+
                 // Statistics
                 area_stats m_stats;
 
                 // The number of members the multipolygon relation has
                 std::size_t m_num_members = 0;
 
+                // When assembly of the current area started
+                std::chrono::steady_clock::time_point m_start_time{};
+
+                // Check work and time budget when m_stats.work reaches this
+                uint64_t m_next_budget_check = 0;
+
+                // Thrown by add_work() when the budget is exceeded
+                struct exceeded_budget : public std::exception {};
+
+                enum : uint64_t {
+                    // When there is a time limit, check the clock after
+                    // this much work.
+                    work_between_time_checks = 4096
+                };
+
+                uint64_t elapsed_us() const {
+                    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start_time).count());
+                }
+
+                void set_next_budget_check() noexcept {
+                    m_next_budget_check = std::numeric_limits<uint64_t>::max();
+                    if (m_config.max_work > 0) {
+                        m_next_budget_check = m_config.max_work + 1;
+                    }
+                    if (m_config.max_time.count() > 0) {
+                        m_next_budget_check = std::min(m_next_budget_check, m_stats.work + work_between_time_checks);
+                    }
+                }
+
+                /**
+                 * Account for some work done. Throws exceeded_budget if
+                 * the work or time budget set in the config is used up.
+                 */
+                void add_work(uint64_t amount = 1) {
+                    m_stats.work += amount;
+                    if (m_stats.work < m_next_budget_check) {
+                        return;
+                    }
+                    if (m_config.max_work > 0 && m_stats.work > m_config.max_work) {
+                        throw exceeded_budget{};
+                    }
+                    if (m_config.max_time.count() > 0 &&
+                        elapsed_us() > static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(m_config.max_time).count())) {
+                        throw exceeded_budget{};
+                    }
+                    set_next_budget_check();
+                }
+
                 template <typename TBuilder>
                 static void build_ring_from_proto_ring(osmium::builder::AreaBuilder& builder, const ProtoRing& ring) {
                     TBuilder ring_builder{builder};
@@ -280,6 +413,9 @@ namespace osmium {
 
                 using rings_stack = std::vector<rings_stack_element>;
 
+                // Scratch space for find_enclosing_ring()
+                rings_stack m_outer_rings;
+
                 static void remove_duplicates(rings_stack& outer_rings) {
                     while (true) {
                         const auto it = std::adjacent_find(outer_rings.begin(), outer_rings.end());
@@ -290,6 +426,20 @@ namespace osmium {
                     }
                 }
 
+                /**
+                 * Add a new ring starting with the given segment. Reuses
+                 * a spare ring if there is one.
+                 */
+                ProtoRing* add_ring(NodeRefSegment* segment) {
+                    if (m_spare_rings.empty()) {
+                        m_rings.emplace_back(segment);
+                    } else {
+                        m_rings.splice(m_rings.end(), m_spare_rings, m_spare_rings.begin());
+                        m_rings.back().reset(segment);
+                    }
+                    return &m_rings.back();
+                }
+
                 ProtoRing* find_enclosing_ring(NodeRefSegment* segment) {
                     if (debug()) {
                         std::cerr << "    Looking for ring enclosing " << *segment << "\n";
@@ -307,19 +457,31 @@ namespace osmium {
 
                     int nesting = 0;
 
-                    rings_stack outer_rings;
-                    while (segment >= &m_segment_list.front()) {
-                        if (!segment->is_direction_done()) {
-                            --segment;
-                            continue;
+                    rings_stack& outer_rings = m_outer_rings;
+                    outer_rings.clear();
+
+                    // Only segments that reach at least to the x coordinate
+                    // of the location can be below it. Look at those in the
+                    // same order a backwards scan through the segment list
+                    // would, so the result doesn't depend on the index.
+                    if (m_segment_index.empty()) {
+                        m_segment_index.build(m_segment_list);
+                    }
+                    NodeRefSegment* const first_segment = &m_segment_list.front();
+                    const auto last = static_cast<std::size_t>(segment - first_segment);
+                    m_segment_index.for_each_reaching(last, location.x(), [&](const std::size_t n) {
+                        add_work();
+                        NodeRefSegment* const candidate = first_segment + n; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                        if (!candidate->is_direction_done()) {
+                            return;
                         }
                         if (debug()) {
-                            std::cerr << "      Checking against " << *segment << "\n";
+                            std::cerr << "      Checking against " << *candidate << "\n";
                         }
-                        const osmium::Location& a = segment->first().location();
-                        const osmium::Location& b = segment->second().location();
+                        const osmium::Location& a = candidate->first().location();
+                        const osmium::Location& b = candidate->second().location();
 
-                        if (segment->first().location() == location) {
+                        if (candidate->first().location() == location) {
                             const int64_t ax = a.x();
                             const int64_t bx = b.x();
                             const int64_t lx = end_location.x();
@@ -331,15 +493,15 @@ namespace osmium {
                                 std::cerr << "      Segment z=" << z << '\n';
                             }
                             if (z > 0) {
-                                nesting += segment->is_reverse() ? -1 : 1;
+                                nesting += candidate->is_reverse() ? -1 : 1;
                                 if (debug()) {
                                     std::cerr << "        Segment is below (nesting=" << nesting << ")\n";
                                 }
-                                if (segment->ring()->is_outer()) {
+                                if (candidate->ring()->is_outer()) {
                                     if (debug()) {
-                                        std::cerr << "        Segment belongs to outer ring (y=" << a.y() << " ring=" << *segment->ring() << ")\n";
+                                        std::cerr << "        Segment belongs to outer ring (y=" << a.y() << " ring=" << *candidate->ring() << ")\n";
                                     }
-                                    outer_rings.emplace_back(a.y(), segment->ring());
+                                    outer_rings.emplace_back(a.y(), candidate->ring());
                                 }
                             }
                         } else if (a.x() <= location.x() && location.x() < b.x()) {
@@ -356,22 +518,21 @@ namespace osmium {
                             const auto z = (bx - ax)*(ly - ay) - (by - ay)*(lx - ax);
 
                             if (z >= 0) {
-                                nesting += segment->is_reverse() ? -1 : 1;
+                                nesting += candidate->is_reverse() ? -1 : 1;
                                 if (debug()) {
                                     std::cerr << "        Segment is below (nesting=" << nesting << ")\n";
                                 }
-                                if (segment->ring()->is_outer()) {
+                                if (candidate->ring()->is_outer()) {
                                     const double y = static_cast<double>(ay) +
                                                      static_cast<double>((by - ay) * (lx - ax)) / static_cast<double>(bx - ax);
                                     if (debug()) {
-                                        std::cerr << "        Segment belongs to outer ring (y=" << y << " ring=" << *segment->ring() << ")\n";
+                                        std::cerr << "        Segment belongs to outer ring (y=" << y << " ring=" << *candidate->ring() << ")\n";
                                     }
-                                    outer_rings.emplace_back(y, segment->ring());
+                                    outer_rings.emplace_back(y, candidate->ring());
                                 }
                             }
                         }
-                        --segment;
-                    }
+                    });
 
                     if (nesting % 2 == 0) {
                         if (debug()) {
@@ -427,8 +588,7 @@ namespace osmium {
                     }
                     segment->mark_direction_done();
 
-                    m_rings.emplace_back(segment);
-                    ProtoRing* ring = &m_rings.back();
+                    ProtoRing* ring = add_ring(segment);
                     if (outer_ring) {
                         if (debug()) {
                             std::cerr << "    This is an inner ring. Outer ring is " << *outer_ring << "\n";
@@ -445,6 +605,7 @@ namespace osmium {
                     uint32_t nodes = 1;
                     while (first_location != last_location) {
                         ++nodes;
+                        add_work();
                         NodeRefSegment* next_segment = get_next_segment(last_location);
                         next_segment->mark_direction_done();
                         if (next_segment->start().location() != last_location) {
@@ -478,8 +639,7 @@ namespace osmium {
                         segment->reverse();
                     }
 
-                    m_rings.emplace_back(segment);
-                    ProtoRing* ring = &m_rings.back();
+                    ProtoRing* ring = add_ring(segment);
 
                     const osmium::Location& first_location = node.location(m_segment_list);
                     osmium::Location last_location = segment->stop().location();
@@ -487,6 +647,7 @@ namespace osmium {
                     uint32_t nodes = 1;
                     while (first_location != last_location && !is_split_location(last_location)) {
                         ++nodes;
+                        add_work();
                         NodeRefSegment* next_segment = get_next_segment(last_location);
                         if (next_segment->start().location() != last_location) {
                             next_segment->reverse();
@@ -655,7 +816,7 @@ namespace osmium {
                     }
 
                     open_ring_its.erase(std::find(open_ring_its.begin(), open_ring_its.end(), r2));
-                    m_rings.erase(r2);
+                    m_spare_rings.splice(m_spare_rings.end(), m_rings, r2);
 
                     if (r1->closed()) {
                         open_ring_its.erase(std::find(open_ring_its.begin(), open_ring_its.end(), r1));
@@ -671,6 +832,7 @@ namespace osmium {
                         std::cerr << "    Trying to merge " << open_ring_its.size() << " open rings (try_to_merge)\n";
                     }
 
+                    add_work(open_ring_its.size());
                     std::vector<location_to_ring_map> xrings = create_location_to_ring_map(open_ring_its);
 
                     auto it = xrings.cbegin();
@@ -745,6 +907,7 @@ namespace osmium {
                     assert(!cand.rings.empty());
                     const ProtoRing* ring_leading_here = &cand.rings.back().first.ring();
                     for (const location_to_ring_map& m : connections) {
+                        add_work();
                         const ProtoRing& ring = m.ring();
 
                         if (&ring != ring_leading_here) {
@@ -817,6 +980,7 @@ namespace osmium {
                         std::cerr << "    Trying to merge " << open_ring_its.size() << " open rings (join_connected_rings)\n";
                     }
 
+                    add_work(open_ring_its.size());
                     std::vector<location_to_ring_map> xrings = create_location_to_ring_map(open_ring_its);
 
                     const auto ring_min = std::min_element(xrings.begin(), xrings.end(), [](const location_to_ring_map& lhs, const location_to_ring_map& rhs) {
@@ -979,51 +1143,7 @@ namespace osmium {
                     return true;
                 }
 
-#ifdef OSMIUM_WITH_TIMER
-                static bool print_header() {
-                    std::cout << "nodes outer_rings inner_rings sort dupl intersection locations split simple_case complex_case roles_check\n";
-                    return true;
-                }
-
-                static bool init_header() {
-                    static bool printed_print_header = print_header();
-                    return printed_print_header;
-                }
-#endif
-
-            protected:
-
-                const std::list<ProtoRing>& rings() const noexcept {
-                    return m_rings;
-                }
-
-                void set_num_members(std::size_t size) noexcept {
-                    m_num_members = size;
-                }
-
-                SegmentList& segment_list() noexcept {
-                    return m_segment_list;
-                }
-
-                /**
-                 * Append each outer ring together with its inner rings to the
-                 * area in the buffer.
-                 */
-                void add_rings_to_area(osmium::builder::AreaBuilder& builder) const {
-                    for (const ProtoRing& ring : m_rings) {
-                        if (ring.is_outer()) {
-                            build_ring_from_proto_ring<osmium::builder::OuterRingBuilder>(builder, ring);
-                            for (const ProtoRing* inner : ring.inner_rings()) {
-                                build_ring_from_proto_ring<osmium::builder::InnerRingBuilder>(builder, *inner);
-                            }
-                        }
-                    }
-                }
-
-                /**
-                 * Create rings from segments.
-                 */
-                bool create_rings() {
+                bool create_rings_impl() {
                     m_stats.nodes += m_segment_list.size();
 
                     // Sort the list of segments (from left to right and bottom
@@ -1031,6 +1151,7 @@ namespace osmium {
                     osmium::Timer timer_sort;
                     m_segment_list.sort();
                     timer_sort.stop();
+                    add_work(m_segment_list.size());
 
                     // Remove duplicate segments. Removal is in pairs, so if there
                     // are two identical segments, they will both be removed. If
@@ -1039,6 +1160,11 @@ namespace osmium {
                     m_segment_list.erase_duplicate_segments(m_config.problem_reporter, m_stats.duplicate_segments, m_stats.overlapping_segments);
                     timer_dupl.stop();
 
+                    // The segment list has changed, the index will be
+                    // rebuilt when needed.
+                    m_segment_index.clear();
+                    m_stats.segments = m_segment_list.size();
+
                     // If there are no segments left at this point, this isn't
                     // a valid area.
                     if (m_segment_list.empty()) {
@@ -1062,6 +1188,7 @@ namespace osmium {
                     osmium::Timer timer_intersection;
                     m_stats.intersections = m_segment_list.find_intersections(m_config.problem_reporter);
                     timer_intersection.stop();
+                    add_work(m_segment_list.size());
 
                     if (m_stats.intersections) {
                         return false;
@@ -1183,6 +1310,92 @@ namespace osmium {
                     return true;
                 }
 
+#ifdef OSMIUM_WITH_TIMER
+                static bool print_header() {
+                    std::cout << "nodes outer_rings inner_rings sort dupl intersection locations split simple_case complex_case roles_check\n";
+                    return true;
+                }
+
+                static bool init_header() {
+                    static bool printed_print_header = print_header();
+                    return printed_print_header;
+                }
+#endif
+
+            protected:
+
+                /**
+                 * Reset the assembler so it can be used for the next way
+                 * or relation. All data and the statistics from the last
+                 * run are removed, but the memory allocated for them is
+                 * kept. Derived classes call this at the beginning of each
+                 * run.
+                 */
+                void reset() {
+                    m_segment_list.clear();
+                    m_spare_rings.splice(m_spare_rings.end(), m_rings);
+                    m_locations.clear();
+                    m_split_locations.clear();
+                    m_segment_index.clear();
+                    m_stats = area_stats{};
+                    m_num_members = 0;
+                }
+
+                const std::list<ProtoRing>& rings() const noexcept {
+                    return m_rings;
+                }
+
+                void set_num_members(std::size_t size) noexcept {
+                    m_num_members = size;
+                }
+
+                SegmentList& segment_list() noexcept {
+                    return m_segment_list;
+                }
+
+                /**
+                 * Append each outer ring together with its inner rings to the
+                 * area in the buffer.
+                 */
+                void add_rings_to_area(osmium::builder::AreaBuilder& builder) const {
+                    for (const ProtoRing& ring : m_rings) {
+                        if (ring.is_outer()) {
+                            build_ring_from_proto_ring<osmium::builder::OuterRingBuilder>(builder, ring);
+                            for (const ProtoRing* inner : ring.inner_rings()) {
+                                build_ring_from_proto_ring<osmium::builder::InnerRingBuilder>(builder, *inner);
+                            }
+                        }
+                    }
+                }
+
+                /**
+                 * Create rings from segments.
+                 *
+                 * If the work or time budget from the config is exceeded,
+                 * this is reported to the problem reporter and the area is
+                 * treated as invalid.
+                 */
+                bool create_rings() {
+                    m_start_time = std::chrono::steady_clock::now();
+                    set_next_budget_check();
+
+                    bool okay = false;
+                    try {
+                        okay = create_rings_impl();
+                    } catch (const exceeded_budget&) {
+                        ++m_stats.aborted;
+                        if (m_config.debug_level > 0) {
+                            std::cerr << "  Aborted assembly after work=" << m_stats.work << "\n";
+                        }
+                        if (m_config.problem_reporter) {
+                            m_config.problem_reporter->report_assembly_aborted(m_stats.work, elapsed_us());
+                        }
+                    }
+
+                    m_stats.assembly_time_us = elapsed_us();
+                    return okay;
+                }
+
             public:
 
                 using config_type = osmium::area::AssemblerConfig;
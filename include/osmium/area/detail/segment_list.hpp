@@ -43,13 +43,19 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/way.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <numeric>
+#include <queue>
+#include <set>
+#include <tuple>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace osmium {
@@ -88,6 +94,12 @@ namespace osmium {
 
                 bool m_debug;
 
+                // Segment lists smaller than this are checked for
+                // intersections with a simple nested loop.
+                enum : std::size_t {
+                    min_segments_for_sweep = 256
+                };
+
                 static role_type parse_role(const char* role) noexcept {
                     if (role[0] == '\0') {
                         return role_type::empty;
@@ -101,6 +113,28 @@ namespace osmium {
                     return role_type::unknown;
                 }
 
+                // The number of bits needed for the height of the segment.
+                static unsigned int height_level(const NodeRefSegment& segment) noexcept {
+                    const std::pair<int32_t, int32_t> y = std::minmax(segment.first().location().y(), segment.second().location().y());
+                    auto height = static_cast<uint64_t>(static_cast<int64_t>(y.second) - static_cast<int64_t>(y.first));
+                    unsigned int level = 0;
+                    while (height != 0) {
+                        height >>= 1U;
+                        ++level;
+                    }
+                    return level;
+                }
+
+                void report_intersection(ProblemReporter* problem_reporter, const NodeRefSegment& s1, const NodeRefSegment& s2, const osmium::Location intersection) const {
+                    if (m_debug) {
+                        std::cerr << "  segments " << s1 << " and " << s2 << " intersecting at " << intersection << "\n";
+                    }
+                    if (problem_reporter) {
+                        problem_reporter->report_intersection(s1.way()->id(), s1.first().location(), s1.second().location(),
+                                                              s2.way()->id(), s2.first().location(), s2.second().location(), intersection);
+                    }
+                }
+
                 /**
                  * Calculate the number of segments in all the ways together.
                  */
@@ -165,6 +199,15 @@ namespace osmium {
                     return m_segments.empty();
                 }
 
+                /**
+                 * Remove all segments from the list. The memory used is
+                 * kept, so the list can be filled again without new
+                 * allocations.
+                 */
+                void clear() noexcept {
+                    m_segments.clear();
+                }
+
                 using const_iterator = slist_type::const_iterator;
                 using iterator = slist_type::iterator;
 
@@ -310,11 +353,35 @@ namespace osmium {
                 /**
                  * Find intersection between segments.
                  *
+                 * For small segment lists this uses a simple nested loop,
+                 * for larger lists a sweep line algorithm. The results are
+                 * the same in both cases.
+                 *
                  * @param problem_reporter Any intersections found are
                  *                         reported to this object.
                  * @returns true if there are intersections.
                  */
                 uint32_t find_intersections(ProblemReporter* problem_reporter) const {
+                    if (m_segments.size() < min_segments_for_sweep) {
+                        return find_intersections_nested_loop(problem_reporter);
+                    }
+                    return find_intersections_sweep(problem_reporter);
+                }
+
+                /**
+                 * Find intersection between segments by checking each
+                 * segment against all following segments in the sorted list
+                 * until they are outside the x range of the segment. This
+                 * is fast for small lists, but can need quadratic time if
+                 * many segments overlap in their x range.
+                 *
+                 * Usually you want to call find_intersections() instead.
+                 *
+                 * @param problem_reporter Any intersections found are
+                 *                         reported to this object.
+                 * @returns true if there are intersections.
+                 */
+                uint32_t find_intersections_nested_loop(ProblemReporter* problem_reporter) const {
                     if (m_segments.empty()) {
                         return 0;
                     }
@@ -336,13 +403,7 @@ namespace osmium {
                                 osmium::Location intersection{calculate_intersection(s1, s2)};
                                 if (intersection) {
                                     ++found_intersections;
-                                    if (m_debug) {
-                                        std::cerr << "  segments " << s1 << " and " << s2 << " intersecting at " << intersection << "\n";
-                                    }
-                                    if (problem_reporter) {
-                                        problem_reporter->report_intersection(s1.way()->id(), s1.first().location(), s1.second().location(),
-                                                                              s2.way()->id(), s2.first().location(), s2.second().location(), intersection);
-                                    }
+                                    report_intersection(problem_reporter, s1, s2, intersection);
                                 }
                             }
                         }
@@ -351,6 +412,92 @@ namespace osmium {
                     return found_intersections;
                 }
 
+                /**
+                 * Find intersection between segments using a sweep line
+                 * over the x axis. The segments currently crossing the sweep
+                 * line are kept in sets ordered by their lower y coordinate,
+                 * one set for each power of two of segment height. So only
+                 * segments that are near in y have to be checked. Needs
+                 * O(n log n) time for typical data. Intersections are
+                 * reported in the same order as by the nested loop version.
+                 *
+                 * Usually you want to call find_intersections() instead.
+                 *
+                 * @param problem_reporter Any intersections found are
+                 *                         reported to this object.
+                 * @returns true if there are intersections.
+                 */
+                uint32_t find_intersections_sweep(ProblemReporter* problem_reporter) const {
+                    // Set of (lower y, segment index) pairs.
+                    using active_set_type = std::set<std::pair<int64_t, std::size_t>>;
+
+                    // Set n contains the segments with a height that fits
+                    // into n bits.
+                    std::array<active_set_type, 34> active{};
+                    uint64_t non_empty_sets = 0;
+
+                    // Heap of (highest x, segment index) pairs of the active
+                    // segments to find the ones to remove.
+                    using end_type = std::pair<int32_t, std::size_t>;
+                    std::priority_queue<end_type, std::vector<end_type>, std::greater<end_type>> ends;
+
+                    std::vector<std::tuple<std::size_t, std::size_t, osmium::Location>> intersections;
+
+                    for (std::size_t n = 0; n < m_segments.size(); ++n) {
+                        const NodeRefSegment& s2 = m_segments[n];
+                        const int32_t x = s2.first().location().x();
+
+                        while (!ends.empty() && ends.top().first < x) {
+                            const auto& segment = m_segments[ends.top().second];
+                            const auto ymin = std::min(segment.first().location().y(), segment.second().location().y());
+                            const auto level = height_level(segment);
+                            active[level].erase(std::make_pair(static_cast<int64_t>(ymin), ends.top().second));
+                            if (active[level].empty()) {
+                                non_empty_sets &= ~(1ULL << level);
+                            }
+                            ends.pop();
+                        }
+
+                        const std::pair<int32_t, int32_t> y = std::minmax(s2.first().location().y(), s2.second().location().y());
+                        for (uint64_t levels = non_empty_sets; levels != 0; levels &= levels - 1) {
+                            unsigned int level = 0;
+                            while ((levels & (1ULL << level)) == 0) {
+                                ++level;
+                            }
+                            const int64_t max_height = (1LL << level) - 1;
+                            const auto& set = active[level];
+                            for (auto it = set.lower_bound(std::make_pair(static_cast<int64_t>(y.first) - max_height, std::size_t{0}));
+                                 it != set.end() && it->first <= y.second;
+                                 ++it) {
+                                const NodeRefSegment& s1 = m_segments[it->second];
+                                assert(s1 != s2); // erase_duplicate_segments() should have made sure of that
+                                if (y_range_overlap(s1, s2)) {
+                                    osmium::Location intersection{calculate_intersection(s1, s2)};
+                                    if (intersection) {
+                                        intersections.emplace_back(it->second, n, intersection);
+                                    }
+                                }
+                            }
+                        }
+
+                        const auto level = height_level(s2);
+                        active[level].emplace(static_cast<int64_t>(y.first), n);
+                        non_empty_sets |= 1ULL << level;
+                        ends.emplace(s2.second().location().x(), n);
+                    }
+
+                    std::sort(intersections.begin(), intersections.end(), [](const std::tuple<std::size_t, std::size_t, osmium::Location>& a,
+                                                                             const std::tuple<std::size_t, std::size_t, osmium::Location>& b) {
+                        return std::tie(std::get<0>(a), std::get<1>(a)) < std::tie(std::get<0>(b), std::get<1>(b));
+                    });
+
+                    for (const auto& i : intersections) {
+                        report_intersection(problem_reporter, m_segments[std::get<0>(i)], m_segments[std::get<1>(i)], std::get<2>(i));
+                    }
+
+                    return static_cast<uint32_t>(intersections.size());
+                }
+
             }; // class SegmentList
 
         } // namespace detail
@@ -77,6 +77,8 @@ namespace osmium {
              *          area, true otherwise.
              */
             bool operator()(const osmium::Way& way, osmium::memory::Buffer& out_buffer) {
+                reset();
+
                 segment_list().extract_segments_from_way(config().problem_reporter, stats().duplicate_nodes, way);
 
                 if (!create_rings()) {
@@ -103,6 +105,8 @@ namespace osmium {
              *          area, true otherwise.
              */
             bool operator()(const osmium::Relation& relation, const osmium::memory::Buffer& ways_buffer, osmium::memory::Buffer& out_buffer) {
+                reset();
+
                 for (const auto& way : ways_buffer.select<osmium::Way>()) {
                     segment_list().extract_segments_from_way(config().problem_reporter, stats().duplicate_nodes, way);
                 }
@@ -81,6 +81,10 @@ namespace osmium {
             using assembler_config_type = typename TAssembler::config_type;
             const assembler_config_type m_assembler_config;
 
+            // The assembler is reused for all areas, so the memory it
+            // allocates is reused, too.
+            TAssembler m_assembler;
+
             osmium::memory::Buffer m_output_buffer;
 
             area_stats m_stats;
@@ -113,6 +117,7 @@ namespace osmium {
             explicit MultipolygonCollector(const assembler_config_type& assembler_config) :
                 collector_type(),
                 m_assembler_config(assembler_config),
+                m_assembler(m_assembler_config),
                 m_output_buffer(initial_output_buffer_size, osmium::memory::Buffer::auto_grow::yes) {
             }
 
@@ -162,9 +167,8 @@ namespace osmium {
                     }
                     if (way.ends_have_same_location()) {
                         // way is closed and has enough nodes, build simple multipolygon
-                        TAssembler assembler{m_assembler_config};
-                        assembler(way, m_output_buffer);
-                        m_stats += assembler.stats();
+                        m_assembler(way, m_output_buffer);
+                        m_stats += m_assembler.stats();
                         possibly_flush_output_buffer();
                     }
                 } catch (const osmium::invalid_location&) {
@@ -186,9 +190,8 @@ namespace osmium {
                 }
 
                 try {
-                    TAssembler assembler{m_assembler_config};
-                    assembler(relation, ways, m_output_buffer);
-                    m_stats += assembler.stats();
+                    m_assembler(relation, ways, m_output_buffer);
+                    m_stats += m_assembler.stats();
                     possibly_flush_output_buffer();
                 } catch (const osmium::invalid_location&) {
                     // XXX ignore
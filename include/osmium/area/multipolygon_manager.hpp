@@ -33,7 +33,10 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/area/area_cache.hpp>
 #include <osmium/area/stats.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/area.hpp>
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/relation.hpp>
 #include <osmium/osm/tag.hpp>
@@ -45,12 +48,17 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/storage/item_stash.hpp>
 #include <osmium/tags/taglist.hpp>
 #include <osmium/tags/tags_filter.hpp>
+#include <osmium/thread/pool.hpp>
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <deque>
+#include <future>
+#include <utility>
 #include <vector>
 
 namespace osmium {
@@ -67,7 +75,9 @@ namespace osmium {
          * osmium::relations::RelationsManager.
          *
          * The actual assembling of the areas is done by the assembler
-         * class given as template argument.
+         * class given as template argument. Call use_thread_pool() to run
+         * the assemblers in a thread pool instead of the thread calling
+         * the handler.
          *
          * @tparam TAssembler Multipolygon Assembler class.
          * @pre The Ids of all objects must be unique in the input data.
@@ -78,10 +88,210 @@ namespace osmium {
             using assembler_config_type = typename TAssembler::config_type;
             const assembler_config_type m_assembler_config;
 
+            // The assembler used when not running in a thread pool. It is
+            // reused for all areas, so the memory it allocates is reused,
+            // too.
+            TAssembler m_assembler;
+
             area_stats m_stats;
 
             osmium::TagsFilter m_filter;
 
+            enum : std::size_t {
+                // Objects are handed to the pool in batches of this size.
+                batch_size = 512UL * 1024UL
+            };
+
+            struct batch_result {
+                osmium::memory::Buffer buffer{};
+                area_stats stats{};
+
+                // Fingerprints of the input of all areas in the buffer,
+                // only filled if the areas are written to a cache.
+                std::vector<uint64_t> fingerprints{};
+            };
+
+            struct cache_settings {
+                const AreaCache* cache = nullptr;
+                bool write = false;
+
+                bool enabled() const noexcept {
+                    return cache || write;
+                }
+            };
+
+            cache_settings m_cache_settings{};
+            AreaCacheWriter* m_cache_writer = nullptr;
+
+            // Fingerprints of the areas assembled in this thread.
+            std::vector<uint64_t> m_fingerprints{};
+
+            osmium::thread::Pool* m_pool = nullptr;
+            bool m_ordered = true;
+
+            // Relations (followed by their member ways) and closed ways
+            // not yet handed to the pool.
+            osmium::memory::Buffer m_batch{};
+
+            std::deque<std::future<batch_result>> m_pending{};
+
+            // If the cache has the area assembled from the same input, add
+            // it to the buffer and return true.
+            static bool add_from_cache(const cache_settings& settings, osmium::object_id_type area_id, uint64_t fingerprint, osmium::memory::Buffer& buffer, area_stats& stats, std::vector<uint64_t>& fingerprints) {
+                if (!settings.cache) {
+                    return false;
+                }
+                const osmium::Area* area = settings.cache->get(area_id, fingerprint);
+                if (!area) {
+                    return false;
+                }
+                buffer.add_item(*area);
+                buffer.commit();
+                ++stats.from_cache;
+                if (settings.write) {
+                    fingerprints.push_back(fingerprint);
+                }
+                return true;
+            }
+
+            // Remember the fingerprint for all areas added to the buffer
+            // after the offset.
+            static void add_fingerprints(const cache_settings& settings, const osmium::memory::Buffer& buffer, std::size_t offset, uint64_t fingerprint, std::vector<uint64_t>& fingerprints) {
+                if (settings.write) {
+                    const auto count = std::distance(buffer.get_iterator(offset), buffer.cend());
+                    fingerprints.insert(fingerprints.end(), static_cast<std::size_t>(count), fingerprint);
+                }
+            }
+
+            // Assemble one relation or closed way with the given assembler
+            // (or get it from the cache) and add the area to the buffer.
+            static void assemble(TAssembler& assembler, const cache_settings& settings, const osmium::Relation& relation, const std::vector<const osmium::Way*>& ways, osmium::memory::Buffer& buffer, area_stats& stats, std::vector<uint64_t>& fingerprints) {
+                const uint64_t fingerprint = settings.enabled() ? area_fingerprint(relation, ways) : 0;
+                if (add_from_cache(settings, osmium::object_id_to_area_id(relation.id(), osmium::item_type::relation), fingerprint, buffer, stats, fingerprints)) {
+                    return;
+                }
+                const auto offset = buffer.committed();
+                try {
+                    assembler(relation, ways, buffer);
+                    stats += assembler.stats();
+                } catch (const osmium::invalid_location&) {
+                    // XXX ignore
+                }
+                add_fingerprints(settings, buffer, offset, fingerprint, fingerprints);
+            }
+
+            static void assemble(TAssembler& assembler, const cache_settings& settings, const osmium::Way& way, osmium::memory::Buffer& buffer, area_stats& stats, std::vector<uint64_t>& fingerprints) {
+                const uint64_t fingerprint = settings.enabled() ? area_fingerprint(way) : 0;
+                if (add_from_cache(settings, osmium::object_id_to_area_id(way.id(), osmium::item_type::way), fingerprint, buffer, stats, fingerprints)) {
+                    return;
+                }
+                const auto offset = buffer.committed();
+                try {
+                    assembler(way, buffer);
+                    stats += assembler.stats();
+                } catch (const osmium::invalid_location&) {
+                    // XXX ignore
+                }
+                add_fingerprints(settings, buffer, offset, fingerprint, fingerprints);
+            }
+
+            // Write the areas in the buffer after the offset to the cache
+            // writer (if there is one).
+            void write_to_cache(const osmium::memory::Buffer& buffer, std::size_t offset, std::vector<uint64_t>& fingerprints) {
+                if (!m_cache_writer) {
+                    return;
+                }
+                auto fingerprint = fingerprints.cbegin();
+                for (auto it = buffer.get_iterator<osmium::Area>(offset); it != buffer.cend<osmium::Area>(); ++it, ++fingerprint) {
+                    assert(fingerprint != fingerprints.cend());
+                    m_cache_writer->add(*it, *fingerprint);
+                }
+                fingerprints.clear();
+            }
+
+            // This runs in the pool. The input buffer contains relations,
+            // each followed by its member ways, and closed ways.
+            static batch_result assemble_batch(const assembler_config_type& config, const cache_settings& settings, const osmium::memory::Buffer& input) {
+                batch_result result;
+                result.buffer = osmium::memory::Buffer{input.committed(), osmium::memory::Buffer::auto_grow::yes};
+
+                // One assembler is used for the whole batch.
+                TAssembler assembler{config};
+
+                std::vector<const osmium::Way*> ways;
+                for (auto it = input.begin(); it != input.end(); ++it) {
+                    if (it->type() == osmium::item_type::relation) {
+                        const auto& relation = static_cast<const osmium::Relation&>(*it);
+                        ways.clear();
+                        for (const auto& member : relation.members()) {
+                            if (member.ref() != 0) {
+                                ++it;
+                                assert(it != input.end() && it->type() == osmium::item_type::way);
+                                ways.push_back(static_cast<const osmium::Way*>(&*it));
+                            }
+                        }
+                        assemble(assembler, settings, relation, ways, result.buffer, result.stats, result.fingerprints);
+                    } else {
+                        assert(it->type() == osmium::item_type::way);
+                        assemble(assembler, settings, static_cast<const osmium::Way&>(*it), result.buffer, result.stats, result.fingerprints);
+                    }
+                }
+
+                return result;
+            }
+
+            void add_result(batch_result&& result) {
+                m_stats += result.stats;
+                write_to_cache(result.buffer, 0, result.fingerprints);
+                if (result.buffer.committed() > 0) {
+                    this->buffer().add_buffer(result.buffer);
+                    this->buffer().commit();
+                    this->possibly_flush();
+                }
+            }
+
+            // Add results of finished batches to the output. If ordered,
+            // this stops at the first batch that isn't finished yet.
+            void collect_finished() {
+                for (auto it = m_pending.begin(); it != m_pending.end();) {
+                    if (it->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                        add_result(it->get());
+                        it = m_pending.erase(it);
+                    } else if (m_ordered) {
+                        return;
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+
+            void submit_batch() {
+                if (m_batch.committed() == 0) {
+                    return;
+                }
+
+                // Limit the number of batches in flight. Wait for the oldest.
+                while (m_pending.size() >= 2 * static_cast<std::size_t>(m_pool->num_threads())) {
+                    add_result(m_pending.front().get());
+                    m_pending.pop_front();
+                }
+
+                osmium::memory::Buffer batch{batch_size, osmium::memory::Buffer::auto_grow::yes};
+                using std::swap;
+                swap(batch, m_batch);
+                m_pending.push_back(m_pool->submit([config = m_assembler_config, settings = m_cache_settings, batch = std::move(batch)]() {
+                    return assemble_batch(config, settings, batch);
+                }));
+
+                collect_finished();
+            }
+
+            void possibly_submit_batch() {
+                if (m_batch.committed() >= batch_size) {
+                    submit_batch();
+                }
+            }
+
         public:
 
             /**
@@ -95,6 +305,7 @@ namespace osmium {
              */
             explicit MultipolygonManager(assembler_config_type assembler_config, osmium::TagsFilter filter = osmium::TagsFilter{true}) :
                 m_assembler_config(std::move(assembler_config)),
+                m_assembler(m_assembler_config),
                 m_filter(std::move(filter)) {
             }
 
@@ -106,6 +317,69 @@ namespace osmium {
                 return m_stats;
             }
 
+            /**
+             * Run the assemblers in the specified thread pool instead of
+             * the thread calling the handler. Completed relations and closed
+             * ways are copied and handed to the pool in batches. The areas
+             * are added to the output buffer when their batch is done, so
+             * they are only complete after flush_output() or read() was
+             * called.
+             *
+             * If a problem reporter is set in the assembler config, it must
+             * be able to handle calls from several threads at once.
+             *
+             * @param pool The thread pool to use.
+             * @param ordered If true, the areas are output in the same
+             *                order as without the thread pool. Otherwise
+             *                the results of each batch are output as soon
+             *                as they are available.
+             */
+            void use_thread_pool(osmium::thread::Pool& pool, bool ordered = true) {
+                flush_pending();
+                m_pool = &pool;
+                m_ordered = ordered;
+                m_batch = osmium::memory::Buffer{batch_size, osmium::memory::Buffer::auto_grow::yes};
+            }
+
+            /**
+             * Use areas assembled on an earlier run and/or save the areas
+             * assembled on this run for the next one. An area is taken
+             * from the cache if the relation or closed way it is created
+             * from didn't change, including all attributes and tags, the
+             * member ways and the node locations. Otherwise it is
+             * assembled as usual.
+             *
+             * The areas in the cache must have been assembled with the
+             * same assembler config.
+             *
+             * @param cache Areas from an earlier run. Can be nullptr.
+             * @param writer All areas output by the manager are written
+             *               here, to be used as cache on the next run. Can
+             *               be nullptr.
+             */
+            void use_area_cache(const AreaCache* cache, AreaCacheWriter* writer = nullptr) {
+                flush_pending();
+                m_cache_settings.cache = cache;
+                m_cache_settings.write = writer != nullptr;
+                m_cache_writer = writer;
+            }
+
+            /**
+             * Hand all outstanding objects to the pool and wait until all
+             * areas are added to the output buffer. This is called
+             * automatically from flush_output() and read().
+             */
+            void flush_pending() {
+                if (!m_pool) {
+                    return;
+                }
+                submit_batch();
+                while (!m_pending.empty()) {
+                    add_result(m_pending.front().get());
+                    m_pending.pop_front();
+                }
+            }
+
             /**
              * We are interested in all relations tagged with type=multipolygon
              * or type=boundary with at least one way member.
@@ -133,6 +407,20 @@ namespace osmium {
              * assembler.
              */
             void complete_relation(const osmium::Relation& relation) {
+                if (m_pool) {
+                    m_batch.add_item(relation);
+                    for (const auto& member : relation.members()) {
+                        if (member.ref() != 0) {
+                            const auto* way = this->get_member_way(member.ref());
+                            assert(way != nullptr);
+                            m_batch.add_item(*way);
+                        }
+                    }
+                    m_batch.commit();
+                    possibly_submit_batch();
+                    return;
+                }
+
                 std::vector<const osmium::Way*> ways;
                 ways.reserve(relation.members().size());
                 for (const auto& member : relation.members()) {
@@ -142,13 +430,9 @@ namespace osmium {
                     }
                 }
 
-                try {
-                    TAssembler assembler{m_assembler_config};
-                    assembler(relation, ways, this->buffer());
-                    m_stats += assembler.stats();
-                } catch (const osmium::invalid_location&) {
-                    // XXX ignore
-                }
+                const auto offset = this->buffer().committed();
+                assemble(m_assembler, m_cache_settings, relation, ways, this->buffer(), m_stats, m_fingerprints);
+                write_to_cache(this->buffer(), offset, m_fingerprints);
             }
 
             void after_way(const osmium::Way& way) {
@@ -170,9 +454,16 @@ namespace osmium {
                             return;
                         }
 
-                        TAssembler assembler{m_assembler_config};
-                        assembler(way, this->buffer());
-                        m_stats += assembler.stats();
+                        if (m_pool) {
+                            m_batch.add_item(way);
+                            m_batch.commit();
+                            possibly_submit_batch();
+                            return;
+                        }
+
+                        const auto offset = this->buffer().committed();
+                        assemble(m_assembler, m_cache_settings, way, this->buffer(), m_stats, m_fingerprints);
+                        write_to_cache(this->buffer(), offset, m_fingerprints);
                         this->possibly_flush();
                     }
                 } catch (const osmium::invalid_location&) {
@@ -38,6 +38,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/types.hpp>
 
 #include <cstddef>
+#include <cstdint>
 
 namespace osmium {
 
@@ -228,6 +229,17 @@ namespace osmium {
             virtual void report_duplicate_way(const osmium::Way& way) {
             }
 
+            /**
+             * Report that the assembler gave up on an area because it
+             * needed more work or time than allowed in the AssemblerConfig.
+             *
+             * @param work     The work done until the assembler gave up.
+             * @param time_us  The time spent until the assembler gave up
+             *                 in microseconds.
+             */
+            virtual void report_assembly_aborted(uint64_t work, uint64_t time_us) {
+            }
+
             /**
              * In addition to reporting specific problems, this is used to
              * report all ways belonging to areas having problems.
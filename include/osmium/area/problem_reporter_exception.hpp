@@ -37,6 +37,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/types.hpp>
 
+#include <cstdint>
 #include <sstream>
 #include <stdexcept>
 
@@ -130,6 +131,12 @@ namespace osmium {
                 throw std::runtime_error{m_sstream.str()};
             }
 
+            void report_assembly_aborted(uint64_t work, uint64_t time_us) override {
+                m_sstream.str("");
+                ProblemReporterStream::report_assembly_aborted(work, time_us);
+                throw std::runtime_error{m_sstream.str()};
+            }
+
         }; // class ProblemReporterException
 
     } // namespace area
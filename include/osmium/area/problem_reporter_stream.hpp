@@ -40,6 +40,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/way.hpp>
 
+#include <cstdint>
 #include <ostream>
 
 namespace osmium {
@@ -128,6 +129,11 @@ namespace osmium {
                 *m_out << "way_id=" << way.id() << '\n';
             }
 
+            void report_assembly_aborted(uint64_t work, uint64_t time_us) override {
+                header("assembly aborted");
+                *m_out << "work=" << work << " time_us=" << time_us << '\n';
+            }
+
         }; // class ProblemReporterStream
 
     } // namespace area
@@ -47,12 +47,15 @@ namespace osmium {
          * there were.
          */
         struct area_stats {
+            uint64_t aborted = 0; ///< Assembly aborted because it needed too much work or time
             uint64_t area_really_complex_case = 0; ///< Most difficult case with rings touching in multiple points
             uint64_t area_simple_case = 0; ///< Simple case, no touching rings
             uint64_t area_touching_rings_case = 0; ///< More difficult case with touching rings
+            uint64_t assembly_time_us = 0; ///< Time needed to assemble the area in microseconds
             uint64_t duplicate_nodes = 0; ///< Consecutive identical nodes or consecutive nodes with same location
             uint64_t duplicate_segments = 0; ///< Segments duplicated (going back and forth)
             uint64_t duplicate_ways = 0; ///< Ways that are in relation more than once
+            uint64_t from_cache = 0; ///< Area taken from cache instead of assembling it
             uint64_t from_relations = 0; ///< Area created from multipolygon relation
             uint64_t from_ways = 0; ///< Area created from way
             uint64_t inner_rings = 0; ///< Number of inner rings
@@ -65,20 +68,25 @@ namespace osmium {
             uint64_t open_rings = 0; ///< Number of open rings in the area
             uint64_t outer_rings = 0; ///< Number of outer rings in the area
             uint64_t overlapping_segments = 0; ///< Three or more segments with same end points
+            uint64_t segments = 0; ///< Number of segments after removing duplicate segments
             uint64_t short_ways = 0; ///< Number of ways with less than two nodes
             uint64_t single_way_in_mp_relation = 0; ///< Multipolygon relation containing a single way
             uint64_t touching_rings = 0; ///< Rings touching in a node
             uint64_t ways_in_multiple_rings = 0; ///< Different segments of a way ended up in different rings
+            uint64_t work = 0; ///< Work needed to assemble the area (see AssemblerConfig::max_work)
             uint64_t wrong_role = 0; ///< Member has wrong role (not "outer", "inner", or empty)
             uint64_t invalid_locations = 0; ///< Invalid location found
 
             area_stats& operator+=(const area_stats& other) noexcept {
+                aborted += other.aborted;
                 area_really_complex_case += other.area_really_complex_case;
                 area_simple_case += other.area_simple_case;
                 area_touching_rings_case += other.area_touching_rings_case;
+                assembly_time_us += other.assembly_time_us;
                 duplicate_nodes += other.duplicate_nodes;
                 duplicate_segments += other.duplicate_segments;
                 duplicate_ways += other.duplicate_ways;
+                from_cache += other.from_cache;
                 from_relations += other.from_relations;
                 from_ways += other.from_ways;
                 inner_rings += other.inner_rings;
@@ -90,10 +98,12 @@ namespace osmium {
                 nodes += other.nodes;
                 open_rings += other.open_rings;
                 outer_rings += other.outer_rings;
+                segments += other.segments;
                 short_ways += other.short_ways;
                 single_way_in_mp_relation += other.single_way_in_mp_relation;
                 touching_rings += other.touching_rings;
                 ways_in_multiple_rings += other.ways_in_multiple_rings;
+                work += other.work;
                 wrong_role += other.wrong_role;
                 invalid_locations += invalid_locations;
                 return *this;
@@ -103,12 +113,15 @@ namespace osmium {
 
         template <typename TChar, typename TTraits>
         inline std::basic_ostream<TChar, TTraits>& operator<<(std::basic_ostream<TChar, TTraits>& out, const area_stats& s) {
-            return out << " area_really_complex_case=" << s.area_really_complex_case
+            return out << " aborted=" << s.aborted
+                       << " area_really_complex_case=" << s.area_really_complex_case
                        << " area_simple_case=" << s.area_simple_case
                        << " area_touching_rings_case=" << s.area_touching_rings_case
+                       << " assembly_time_us=" << s.assembly_time_us
                        << " duplicate_nodes=" << s.duplicate_nodes
                        << " duplicate_segments=" << s.duplicate_segments
                        << " duplicate_ways=" << s.duplicate_ways
+                       << " from_cache=" << s.from_cache
                        << " from_relations=" << s.from_relations
                        << " from_ways=" << s.from_ways
                        << " inner_rings=" << s.inner_rings
@@ -120,10 +133,12 @@ namespace osmium {
                        << " nodes=" << s.nodes
                        << " open_rings=" << s.open_rings
                        << " outer_rings=" << s.outer_rings
+                       << " segments=" << s.segments
                        << " short_ways=" << s.short_ways
                        << " single_way_in_mp_relation=" << s.single_way_in_mp_relation
                        << " touching_rings=" << s.touching_rings
                        << " ways_in_multiple_rings=" << s.ways_in_multiple_rings
+                       << " work=" << s.work
                        << " wrong_role=" << s.wrong_role
                        << " invalid_locations=" << s.invalid_locations;
         }
@@ -49,9 +49,45 @@ namespace osmium {
 
             class GeoJSONFactoryImpl {
 
-                std::string m_str;
                 int m_precision;
 
+            protected:
+
+                std::string m_str;
+
+                void write_point(std::string& str, const osmium::geom::Coordinates& xy) const {
+                    str += "{\"type\":\"Point\",\"coordinates\":";
+                    xy.append_to_string(str, '[', ',', ']', m_precision);
+                    str += "}";
+                }
+
+                void linestring_complete() {
+                    assert(!m_str.empty());
+                    m_str.back() = ']';
+                    m_str += "}";
+                }
+
+                void polygon_complete() {
+                    assert(!m_str.empty());
+                    m_str.back() = ']';
+                    m_str += "]}";
+                }
+
+                void multipolygon_complete() {
+                    assert(!m_str.empty());
+                    m_str.back() = ']';
+                    m_str += "}";
+                }
+
+                std::string take_data() {
+                    std::string str;
+
+                    using std::swap;
+                    swap(str, m_str);
+
+                    return str;
+                }
+
             public:
 
                 using point_type        = std::string;
@@ -68,9 +104,8 @@ namespace osmium {
 
                 // { "type": "Point", "coordinates": [100.0, 0.0] }
                 point_type make_point(const osmium::geom::Coordinates& xy) const {
-                    std::string str{"{\"type\":\"Point\",\"coordinates\":"};
-                    xy.append_to_string(str, '[', ',', ']', m_precision);
-                    str += "}";
+                    std::string str;
+                    write_point(str, xy);
                     return str;
                 }
 
@@ -87,15 +122,8 @@ namespace osmium {
                 }
 
                 linestring_type linestring_finish(size_t /*num_points*/) {
-                    assert(!m_str.empty());
-                    std::string str;
-
-                    using std::swap;
-                    swap(str, m_str);
-
-                    str.back() = ']';
-                    str += "}";
-                    return str;
+                    linestring_complete();
+                    return take_data();
                 }
 
                 /* Polygon */
@@ -109,15 +137,8 @@ namespace osmium {
                 }
 
                 polygon_type polygon_finish(size_t /*num_points*/) {
-                    assert(!m_str.empty());
-                    std::string str;
-
-                    using std::swap;
-                    swap(str, m_str);
-
-                    str.back() = ']';
-                    str += "]}";
-                    return str;
+                    polygon_complete();
+                    return take_data();
                 }
 
                 /* MultiPolygon */
@@ -158,24 +179,87 @@ namespace osmium {
                 }
 
                 multipolygon_type multipolygon_finish() {
-                    assert(!m_str.empty());
-                    std::string str;
+                    multipolygon_complete();
+                    return take_data();
+                }
 
-                    using std::swap;
-                    swap(str, m_str);
+            }; // class GeoJSONFactoryImpl
 
-                    str.back() = ']';
-                    str += "}";
-                    return str;
+            /**
+             * Like the GeoJSONFactoryImpl, but appends all geometries to a
+             * string given in the constructor instead of returning a new
+             * string for each geometry. The functions creating geometries
+             * return the number of bytes appended. If an exception is thrown
+             * while a geometry is created, nothing is appended.
+             */
+            class GeoJSONAppendFactoryImpl : public GeoJSONFactoryImpl {
+
+                std::string* m_out;
+
+                std::size_t append_data() {
+                    m_out->append(m_str);
+                    const auto size = m_str.size();
+                    m_str.clear();
+                    return size;
                 }
 
-            }; // class GeoJSONFactoryImpl
+            public:
+
+                using point_type        = std::size_t;
+                using linestring_type   = std::size_t;
+                using polygon_type      = std::size_t;
+                using multipolygon_type = std::size_t;
+                using ring_type         = std::size_t;
+
+                GeoJSONAppendFactoryImpl(int srid, std::string& out, int precision = 7) :
+                    GeoJSONFactoryImpl(srid, precision),
+                    m_out(&out) {
+                }
+
+                /* Point */
+
+                point_type make_point(const osmium::geom::Coordinates& xy) const {
+                    const auto offset = m_out->size();
+                    write_point(*m_out, xy);
+                    return m_out->size() - offset;
+                }
+
+                /* LineString */
+
+                linestring_type linestring_finish(size_t /*num_points*/) {
+                    linestring_complete();
+                    return append_data();
+                }
+
+                /* Polygon */
+
+                polygon_type polygon_finish(size_t /*num_points*/) {
+                    polygon_complete();
+                    return append_data();
+                }
+
+                /* MultiPolygon */
+
+                multipolygon_type multipolygon_finish() {
+                    multipolygon_complete();
+                    return append_data();
+                }
+
+            }; // class GeoJSONAppendFactoryImpl
 
         } // namespace detail
 
         template <typename TProjection = IdentityProjection>
         using GeoJSONFactory = GeometryFactory<osmium::geom::detail::GeoJSONFactoryImpl, TProjection>;
 
+        /**
+         * GeoJSON factory appending all geometries to a string given in the
+         * constructor. The create_*() functions return the number of bytes
+         * appended.
+         */
+        template <typename TProjection = IdentityProjection>
+        using GeoJSONAppendFactory = GeometryFactory<osmium::geom::detail::GeoJSONAppendFactoryImpl, TProjection>;
+
     } // namespace geom
 
 } // namespace osmium
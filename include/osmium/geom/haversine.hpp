@@ -39,6 +39,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/way.hpp>
 
 #include <cmath>
+#include <cstddef>
 #include <iterator>
 
 namespace osmium {
@@ -73,35 +74,181 @@ namespace osmium {
             }
 
             /**
-             * Calculate length of way.
+             * Distance calculation method using the exact haversine formula.
+             * This is the default.
+             *
+             * The cosine of the latitude is calculated only once per point
+             * when calculating the length of a line with several segments.
              */
-            inline double distance(const osmium::WayNodeList& wnl) {
-                double sum_length = 0;
+            struct exact {
 
-                for (const auto* it = wnl.begin(); it != wnl.end(); ++it) {
-                    if (std::next(it) != wnl.end()) {
-                        sum_length += distance(it->location(), std::next(it)->location());
-                    }
+                struct point {
+                    double lon;
+                    double lat;
+                    double cos_lat;
+                };
+
+                static point make_point(double lon, double lat) noexcept {
+                    return point{lon, lat, std::cos(deg_to_rad(lat))};
                 }
 
-                return sum_length;
+                static double distance(const point& p1, const point& p2) noexcept {
+                    double lonh = std::sin(deg_to_rad(p1.lon - p2.lon) * 0.5);
+                    lonh *= lonh;
+                    double lath = std::sin(deg_to_rad(p1.lat - p2.lat) * 0.5);
+                    lath *= lath;
+                    const double tmp = p1.cos_lat * p2.cos_lat;
+                    return 2.0 * EARTH_RADIUS_IN_METERS * std::asin(std::sqrt(lath + tmp * lonh));
+                }
+
+            }; // struct exact
+
+            /**
+             * Distance calculation method using the equirectangular
+             * approximation: The segment is projected onto a plane using the
+             * cosine of its mean latitude and the length is calculated with
+             * Pythagoras. There are no calls to trigonometric functions, so
+             * the compiler can vectorize loops using this.
+             *
+             * The relative error compared to the haversine formula is below
+             * 0.001% for segments up to 10 km long and below 0.1% for
+             * segments up to 100 km long at latitudes up to 80 degrees. This
+             * is fine for typical OSM ways, which have short segments.
+             *
+             * Segments must not cross the antimeridian (180 degree
+             * longitude).
+             */
+            struct equirectangular {
+
+                struct point {
+                    double lon;
+                    double lat;
+                };
+
+                static point make_point(double lon, double lat) noexcept {
+                    return point{deg_to_rad(lon), deg_to_rad(lat)};
+                }
+
+                // Taylor series of the cosine up to x^14. The error is below
+                // 1e-10 for the range -pi/2 to pi/2 we need for latitudes.
+                static double cos(double x) noexcept {
+                    const double x2 = x * x;
+                    return ((((((( -1.0 / 87178291200.0  * x2 +
+                                    1.0 / 479001600.0)   * x2 +
+                                   -1.0 / 3628800.0)     * x2 +
+                                    1.0 / 40320.0)       * x2 +
+                                   -1.0 / 720.0)         * x2 +
+                                    1.0 / 24.0)          * x2 +
+                                   -1.0 / 2.0)           * x2 + 1.0);
+                }
+
+                static double distance(const point& p1, const point& p2) noexcept {
+                    const double x = (p2.lon - p1.lon) * cos((p1.lat + p2.lat) * 0.5);
+                    const double y = p2.lat - p1.lat;
+                    return EARTH_RADIUS_IN_METERS * std::sqrt(x * x + y * y);
+                }
+
+            }; // struct equirectangular
+
+            /**
+             * Calculate the length of all segments of a line given as
+             * arrays of longitudes and latitudes (in degrees).
+             *
+             * @tparam TMethod The calculation method: exact (default) or
+             *                 equirectangular.
+             * @param lon Pointer to array of longitudes.
+             * @param lat Pointer to array of latitudes.
+             * @param count Number of points.
+             * @param out Pointer to array where the count - 1 segment
+             *            lengths (in meters) will be written to.
+             */
+            template <typename TMethod = exact>
+            inline void distances(const double* lon, const double* lat, std::size_t count, double* out) noexcept {
+                if (count == 0) {
+                    return;
+                }
+
+                auto p1 = TMethod::make_point(lon[0], lat[0]);
+                for (std::size_t i = 1; i < count; ++i) {
+                    const auto p2 = TMethod::make_point(lon[i], lat[i]);
+                    out[i - 1] = TMethod::distance(p1, p2);
+                    p1 = p2;
+                }
             }
 
             /**
-             * Calculate length of node list.
+             * Calculate the length of a line given as arrays of longitudes
+             * and latitudes (in degrees).
+             *
+             * @tparam TMethod The calculation method: exact (default) or
+             *                 equirectangular.
+             * @param lon Pointer to array of longitudes.
+             * @param lat Pointer to array of latitudes.
+             * @param count Number of points.
+             * @returns Length in meters.
              */
-            inline double distance(const osmium::NodeRefList& nrl) {
+            template <typename TMethod = exact>
+            inline double distance(const double* lon, const double* lat, std::size_t count) noexcept {
+                if (count == 0) {
+                    return 0.0;
+                }
+
                 double sum_length = 0;
 
-                for (const auto* it = nrl.begin(); it != nrl.end(); ++it) {
-                    if (std::next(it) != nrl.end()) {
-                        sum_length += distance(it->location(), std::next(it)->location());
-                    }
+                auto p1 = TMethod::make_point(lon[0], lat[0]);
+                for (std::size_t i = 1; i < count; ++i) {
+                    const auto p2 = TMethod::make_point(lon[i], lat[i]);
+                    sum_length += TMethod::distance(p1, p2);
+                    p1 = p2;
                 }
 
                 return sum_length;
             }
 
+            namespace detail {
+
+                template <typename TMethod, typename TIterator>
+                inline double distance(TIterator begin, TIterator end) {
+                    if (begin == end) {
+                        return 0.0;
+                    }
+
+                    double sum_length = 0;
+
+                    auto p1 = TMethod::make_point(begin->location().lon(), begin->location().lat());
+                    for (auto it = std::next(begin); it != end; ++it) {
+                        const auto p2 = TMethod::make_point(it->location().lon(), it->location().lat());
+                        sum_length += TMethod::distance(p1, p2);
+                        p1 = p2;
+                    }
+
+                    return sum_length;
+                }
+
+            } // namespace detail
+
+            /**
+             * Calculate length of way.
+             *
+             * @tparam TMethod The calculation method: exact (default) or
+             *                 equirectangular.
+             */
+            template <typename TMethod = exact>
+            inline double distance(const osmium::WayNodeList& wnl) {
+                return detail::distance<TMethod>(wnl.begin(), wnl.end());
+            }
+
+            /**
+             * Calculate length of node list.
+             *
+             * @tparam TMethod The calculation method: exact (default) or
+             *                 equirectangular.
+             */
+            template <typename TMethod = exact>
+            inline double distance(const osmium::NodeRefList& nrl) {
+                return detail::distance<TMethod>(nrl.begin(), nrl.end());
+            }
+
         } // namespace haversine
 
     } // namespace geom
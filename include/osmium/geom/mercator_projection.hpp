@@ -37,7 +37,9 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/geom/util.hpp>
 #include <osmium/osm/location.hpp>
 
+#include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <string>
 
 namespace osmium {
@@ -57,20 +59,11 @@ namespace osmium {
                 return earth_radius_for_epsg3857 * std::log(std::tan(osmium::geom::PI / 4 + deg_to_rad(lat) / 2));
             }
 
-#ifdef OSMIUM_USE_SLOW_MERCATOR_PROJECTION
-            inline double lat_to_y(double lat) {
-                return lat_to_y_with_tan(lat);
-            }
-#else
-
-            // This is a much faster implementation than the canonical
-            // implementation using the tan() function. For details
-            // see https://github.com/osmcode/mercator-projection .
-            inline double lat_to_y(double lat) { // not constexpr because math functions aren't
-                if (lat < -78.0 || lat > 78.0) {
-                    return lat_to_y_with_tan(lat);
-                }
-
+            // Rational polynomial approximation of lat_to_y_with_tan(). Only
+            // accurate enough for latitudes between -78 and +78 degrees. No
+            // branches and no function calls, so the compiler can vectorize
+            // loops using it.
+            constexpr inline double lat_to_y_polynomial(double lat) noexcept {
                 return earth_radius_for_epsg3857 *
                     ((((((((((-3.1112583378460085319e-23  * lat +
                                2.0465852743943268009e-19) * lat +
@@ -94,6 +87,21 @@ namespace osmium {
                               -3.4554675198786337842e-4)  * lat +
                               -5.4367203601085991108e-4)  * lat + 1.0);
             }
+
+#ifdef OSMIUM_USE_SLOW_MERCATOR_PROJECTION
+            inline double lat_to_y(double lat) {
+                return lat_to_y_with_tan(lat);
+            }
+#else
+            // This is a much faster implementation than the canonical
+            // implementation using the tan() function. For details
+            // see https://github.com/osmcode/mercator-projection .
+            inline double lat_to_y(double lat) { // not constexpr because math functions aren't
+                if (lat < -78.0 || lat > 78.0) {
+                    return lat_to_y_with_tan(lat);
+                }
+                return lat_to_y_polynomial(lat);
+            }
 #endif
 
             constexpr inline double x_to_lon(double x) {
@@ -124,6 +132,52 @@ namespace osmium {
             return Coordinates{detail::lon_to_x(c.x), detail::lat_to_y(c.y)};
         }
 
+        /**
+         * Convert many locations from WGS84 lon/lat to web mercator at once.
+         * This is much faster than converting them one by one, because the
+         * main loop has no branches or function calls and can be vectorized
+         * by the compiler (using SSE, AVX, NEON, etc. depending on the
+         * compiler flags). Latitudes outside the range of the fast
+         * approximation are fixed up in a second pass.
+         *
+         * Gives the same results as calling lonlat_to_mercator() on each
+         * location (up to floating point rounding differences if the
+         * compiler uses fused multiply-add instructions).
+         *
+         * @param locations Pointer to array of locations.
+         * @param count Number of locations.
+         * @param x Pointer to array of at least count doubles where the
+         *          x coordinates will be written to.
+         * @param y Pointer to array of at least count doubles where the
+         *          y coordinates will be written to.
+         *
+         * @pre All locations must be valid and in the range described for
+         *      lonlat_to_mercator(). This is not checked.
+         */
+        inline void lonlat_to_mercator(const osmium::Location* locations, std::size_t count, double* x, double* y) {
+            for (std::size_t i = 0; i < count; ++i) {
+                assert(locations[i].valid());
+                x[i] = detail::lon_to_x(locations[i].lon_without_check());
+            }
+
+#ifdef OSMIUM_USE_SLOW_MERCATOR_PROJECTION
+            for (std::size_t i = 0; i < count; ++i) {
+                y[i] = detail::lat_to_y_with_tan(locations[i].lat_without_check());
+            }
+#else
+            for (std::size_t i = 0; i < count; ++i) {
+                y[i] = detail::lat_to_y_polynomial(locations[i].lat_without_check());
+            }
+
+            for (std::size_t i = 0; i < count; ++i) {
+                const double lat = locations[i].lat_without_check();
+                if (lat < -78.0 || lat > 78.0) {
+                    y[i] = detail::lat_to_y_with_tan(lat);
+                }
+            }
+#endif
+        }
+
         /**
          * Convert the coordinates from web mercator to WGS84 lon/lat.
          *
@@ -161,6 +215,15 @@ namespace osmium {
                 return Coordinates{detail::lon_to_x(location.lon()), detail::lat_to_y(location.lat())};
             }
 
+            /**
+             * Do coordinate transformation on many locations at once. See
+             * lonlat_to_mercator(const osmium::Location*, std::size_t,
+             * double*, double*) for details.
+             */
+            void operator()(const osmium::Location* locations, std::size_t count, double* x, double* y) const {
+                lonlat_to_mercator(locations, count, x, y);
+            }
+
             static int epsg() noexcept {
                 return 3857;
             }
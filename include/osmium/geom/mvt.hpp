@@ -0,0 +1,564 @@
+#ifndef OSMIUM_GEOM_MVT_HPP
+#define OSMIUM_GEOM_MVT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/geom/coordinates.hpp>
+#include <osmium/geom/factory.hpp>
+#include <osmium/geom/mercator_projection.hpp>
+#include <osmium/geom/tile.hpp>
+#include <osmium/osm/tag.hpp>
+
+#include <protozero/pbf_builder.hpp>
+#include <protozero/pbf_writer.hpp>
+#include <protozero/types.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace geom {
+
+        /**
+         * @brief Encoding of Mapbox Vector Tiles.
+         *
+         * See https://github.com/mapbox/vector-tile-spec/tree/master/2.1
+         */
+        namespace mvt {
+
+            namespace detail {
+
+                // directly translated from
+                // https://github.com/mapbox/vector-tile-spec/blob/master/2.1/vector_tile.proto
+
+                enum class Tile : protozero::pbf_tag_type {
+                    repeated_Layer_layers = 3
+                };
+
+                enum class Layer : protozero::pbf_tag_type {
+                    required_string_name      =  1,
+                    repeated_Feature_features =  2,
+                    repeated_string_keys      =  3,
+                    repeated_Value_values     =  4,
+                    optional_uint32_extent    =  5,
+                    required_uint32_version   = 15
+                };
+
+                enum class Feature : protozero::pbf_tag_type {
+                    optional_uint64_id       = 1,
+                    packed_uint32_tags       = 2,
+                    optional_GeomType_type   = 3,
+                    packed_uint32_geometry   = 4
+                };
+
+                enum class Value : protozero::pbf_tag_type {
+                    optional_string_string_value = 1
+                };
+
+                enum command : uint32_t {
+                    move_to    = 1,
+                    line_to    = 2,
+                    close_path = 7
+                };
+
+                inline constexpr uint32_t command_integer(uint32_t id, uint32_t count) noexcept {
+                    return (id & 0x7U) | (count << 3U);
+                }
+
+                inline constexpr uint32_t zigzag(int32_t value) noexcept {
+                    return (static_cast<uint32_t>(value) << 1U) ^ static_cast<uint32_t>(-static_cast<int32_t>(static_cast<uint32_t>(value) >> 31U));
+                }
+
+            } // namespace detail
+
+            /// Type of geometry as defined in the vector tile spec.
+            enum class geom_type : uint32_t {
+                unknown    = 0,
+                point      = 1,
+                linestring = 2,
+                polygon    = 3
+            }; // enum class geom_type
+
+            /**
+             * A geometry encoded as vector tile command stream. This is
+             * created by the MVTFactory and added to a layer with
+             * layer_builder::add_feature().
+             */
+            struct geometry {
+
+                geom_type type = geom_type::unknown;
+                std::vector<uint32_t> commands;
+
+            }; // struct geometry
+
+            /**
+             * Builds a vector tile layer. Features are encoded when they are
+             * added. Keys and values are deduplicated and written into the
+             * key and value tables of the layer.
+             */
+            class layer_builder {
+
+                std::string m_name;
+                std::string m_features;
+                std::vector<std::string> m_keys;
+                std::vector<std::string> m_values;
+                std::unordered_map<std::string, uint32_t> m_key_index;
+                std::unordered_map<std::string, uint32_t> m_value_index;
+                std::size_t m_num_features = 0;
+                uint32_t m_extent;
+
+                static uint32_t index(std::unordered_map<std::string, uint32_t>& map, std::vector<std::string>& table, const char* str) {
+                    const auto result = map.emplace(str, static_cast<uint32_t>(table.size()));
+                    if (result.second) {
+                        table.emplace_back(str);
+                    }
+                    return result.first->second;
+                }
+
+            public:
+
+                /**
+                 * Create layer builder.
+                 *
+                 * @param name The name of the layer.
+                 * @param extent The extent of the tile. Must be the same as
+                 *               used in the MVTFactory.
+                 */
+                explicit layer_builder(std::string name, uint32_t extent = 4096) :
+                    m_name(std::move(name)),
+                    m_extent(extent) {
+                }
+
+                const std::string& name() const noexcept {
+                    return m_name;
+                }
+
+                uint32_t extent() const noexcept {
+                    return m_extent;
+                }
+
+                /// The number of features in this layer.
+                std::size_t num_features() const noexcept {
+                    return m_num_features;
+                }
+
+                /// Is this layer empty (i.e. has no features)?
+                bool empty() const noexcept {
+                    return m_num_features == 0;
+                }
+
+                /**
+                 * Add a feature to this layer. Only tags for which the
+                 * filter returns true are added as properties.
+                 *
+                 * @param geom The geometry as returned by the MVTFactory.
+                 * @param tags The tags to add.
+                 * @param id The feature id.
+                 * @param filter A callable taking a const osmium::Tag& and
+                 *               returning bool. This can be a TagsFilter.
+                 *
+                 * @pre @code geom.type != geom_type::unknown @endcode
+                 */
+                template <typename TFilter>
+                void add_feature(const geometry& geom, const osmium::TagList& tags, uint64_t id, TFilter&& filter) {
+                    assert(geom.type != geom_type::unknown);
+                    assert(!geom.commands.empty());
+
+                    protozero::pbf_builder<detail::Layer> pbf_layer{m_features};
+                    protozero::pbf_builder<detail::Feature> pbf_feature{pbf_layer, detail::Layer::repeated_Feature_features};
+
+                    pbf_feature.add_uint64(detail::Feature::optional_uint64_id, id);
+
+                    {
+                        protozero::packed_field_uint32 field{pbf_feature, protozero::pbf_tag_type(detail::Feature::packed_uint32_tags)};
+                        for (const auto& tag : tags) {
+                            if (filter(tag)) {
+                                field.add_element(index(m_key_index, m_keys, tag.key()));
+                                field.add_element(index(m_value_index, m_values, tag.value()));
+                            }
+                        }
+                    }
+
+                    pbf_feature.add_enum(detail::Feature::optional_GeomType_type, static_cast<int32_t>(geom.type));
+                    pbf_feature.add_packed_uint32(detail::Feature::packed_uint32_geometry, geom.commands.cbegin(), geom.commands.cend());
+
+                    ++m_num_features;
+                }
+
+                /**
+                 * Add a feature with all its tags to this layer.
+                 *
+                 * @param geom The geometry as returned by the MVTFactory.
+                 * @param tags The tags to add.
+                 * @param id The feature id.
+                 *
+                 * @pre @code geom.type != geom_type::unknown @endcode
+                 */
+                void add_feature(const geometry& geom, const osmium::TagList& tags, uint64_t id) {
+                    add_feature(geom, tags, id, [](const osmium::Tag& /*tag*/) {
+                        return true;
+                    });
+                }
+
+                /**
+                 * Get the encoded layer.
+                 */
+                std::string serialize() const {
+                    std::string data;
+                    data.reserve(m_features.size() + 64);
+
+                    protozero::pbf_builder<detail::Layer> pbf_layer{data};
+                    pbf_layer.add_uint32(detail::Layer::required_uint32_version, 2);
+                    pbf_layer.add_string(detail::Layer::required_string_name, m_name);
+                    data.append(m_features);
+
+                    for (const auto& key : m_keys) {
+                        pbf_layer.add_string(detail::Layer::repeated_string_keys, key);
+                    }
+
+                    for (const auto& value : m_values) {
+                        protozero::pbf_builder<detail::Value> pbf_value{pbf_layer, detail::Layer::repeated_Value_values};
+                        pbf_value.add_string(detail::Value::optional_string_string_value, value);
+                    }
+
+                    pbf_layer.add_uint32(detail::Layer::optional_uint32_extent, m_extent);
+
+                    return data;
+                }
+
+            }; // class layer_builder
+
+            /**
+             * Builds a vector tile from layers.
+             */
+            class tile_builder {
+
+                std::string m_data;
+
+            public:
+
+                /**
+                 * Add a layer to the tile. Empty layers are ignored.
+                 */
+                void add_layer(const layer_builder& layer) {
+                    if (layer.empty()) {
+                        return;
+                    }
+                    protozero::pbf_builder<detail::Tile> pbf_tile{m_data};
+                    pbf_tile.add_message(detail::Tile::repeated_Layer_layers, layer.serialize());
+                }
+
+                /**
+                 * Get the encoded tile. It is not compressed.
+                 */
+                const std::string& data() const noexcept {
+                    return m_data;
+                }
+
+            }; // class tile_builder
+
+        } // namespace mvt
+
+        namespace detail {
+
+            /**
+             * Geometry factory implementation creating vector tile
+             * geometries. Coordinates (in web mercator) are converted into
+             * integer coordinates relative to the top left corner of the
+             * tile. Consecutive points that end up at the same tile
+             * coordinates are merged. Polygon rings are oriented as
+             * required by the spec, rings that collapse are removed.
+             *
+             * Geometries are not clipped to the tile. Tile coordinates are
+             * clamped to +/- (2^30 - 1), so the difference between any two
+             * of them fits into an int32_t and can always be encoded.
+             */
+            class MVTFactoryImpl {
+
+                struct tile_point {
+                    int32_t x;
+                    int32_t y;
+                };
+
+                enum : int32_t {
+                    max_tile_coordinate = (1 << 30) - 1
+                };
+
+                double m_x0;
+                double m_y0;
+                double m_scale;
+
+                mvt::geometry m_geometry;
+                std::vector<tile_point> m_points;
+                tile_point m_cursor{0, 0};
+                bool m_skip_polygon = false;
+                std::size_t m_num_rings = 0;
+
+                static int32_t to_int(double value) noexcept {
+                    const auto v = std::round(value);
+                    if (v > max_tile_coordinate) {
+                        return max_tile_coordinate;
+                    }
+                    if (v < -max_tile_coordinate) {
+                        return -max_tile_coordinate;
+                    }
+                    return static_cast<int32_t>(v);
+                }
+
+                tile_point to_tile(const osmium::geom::Coordinates& xy) const noexcept {
+                    return tile_point{to_int((xy.x - m_x0) * m_scale),
+                                      to_int((m_y0 - xy.y) * m_scale)};
+                }
+
+                static void encode_point(std::vector<uint32_t>& commands, tile_point& cursor, const tile_point& point) {
+                    commands.push_back(mvt::detail::zigzag(point.x - cursor.x));
+                    commands.push_back(mvt::detail::zigzag(point.y - cursor.y));
+                    cursor = point;
+                }
+
+                void add_location(const osmium::geom::Coordinates& xy) {
+                    const auto point = to_tile(xy);
+                    if (m_points.empty() || m_points.back().x != point.x || m_points.back().y != point.y) {
+                        m_points.push_back(point);
+                    }
+                }
+
+                void start_geometry(mvt::geom_type type) {
+                    m_geometry.type = type;
+                    m_geometry.commands.clear();
+                    m_cursor = tile_point{0, 0};
+                    m_points.clear();
+                    m_num_rings = 0;
+                }
+
+                mvt::geometry finish_geometry() {
+                    mvt::geometry geom;
+                    geom.type = m_geometry.type;
+                    geom.commands = m_geometry.commands;
+                    return geom;
+                }
+
+                // Encode the ring in m_points. Returns false if the ring
+                // collapsed.
+                bool encode_ring(bool outer) {
+                    if (m_points.size() > 1 && m_points.front().x == m_points.back().x && m_points.front().y == m_points.back().y) {
+                        m_points.pop_back();
+                    }
+                    if (m_points.size() < 3) {
+                        return false;
+                    }
+
+                    // Surveyor's formula (twice the area)
+                    int64_t area = 0;
+                    for (std::size_t i = 0; i < m_points.size(); ++i) {
+                        const auto& p1 = m_points[i];
+                        const auto& p2 = m_points[(i + 1) % m_points.size()];
+                        area += static_cast<int64_t>(p1.x) * p2.y - static_cast<int64_t>(p2.x) * p1.y;
+                    }
+                    if (area == 0) {
+                        return false;
+                    }
+
+                    // Outer rings must have positive, inner rings negative
+                    // area in tile coordinates.
+                    if ((area > 0) != outer) {
+                        std::reverse(m_points.begin() + 1, m_points.end());
+                    }
+
+                    auto& commands = m_geometry.commands;
+                    commands.push_back(mvt::detail::command_integer(mvt::detail::move_to, 1));
+                    encode_point(commands, m_cursor, m_points.front());
+                    commands.push_back(mvt::detail::command_integer(mvt::detail::line_to, static_cast<uint32_t>(m_points.size() - 1)));
+                    for (auto it = std::next(m_points.cbegin()); it != m_points.cend(); ++it) {
+                        encode_point(commands, m_cursor, *it);
+                    }
+                    commands.push_back(mvt::detail::command_integer(mvt::detail::close_path, 1));
+                    ++m_num_rings;
+
+                    return true;
+                }
+
+            public:
+
+                using point_type        = mvt::geometry;
+                using linestring_type   = mvt::geometry;
+                using polygon_type      = mvt::geometry;
+                using multipolygon_type = mvt::geometry;
+                using ring_type         = mvt::geometry;
+
+                /**
+                 * Constructor.
+                 *
+                 * @param srid Must be 3857, use with MercatorProjection.
+                 * @param tile The tile the coordinates are relative to.
+                 * @param extent The extent of the tile in tile coordinates.
+                 */
+                MVTFactoryImpl(int srid, const osmium::geom::Tile& tile, uint32_t extent = 4096) :
+                    m_x0(-osmium::geom::detail::max_coordinate_epsg3857 + tile.x * tile_extent_in_zoom(tile.z)),
+                    m_y0(osmium::geom::detail::max_coordinate_epsg3857 - tile.y * tile_extent_in_zoom(tile.z)),
+                    m_scale(extent / tile_extent_in_zoom(tile.z)) {
+                    assert(srid == 3857);
+                    (void)srid;
+                }
+
+                /* Point */
+
+                point_type make_point(const osmium::geom::Coordinates& xy) const {
+                    const auto point = to_tile(xy);
+                    mvt::geometry geom;
+                    geom.type = mvt::geom_type::point;
+                    geom.commands.reserve(3);
+                    geom.commands.push_back(mvt::detail::command_integer(mvt::detail::move_to, 1));
+                    geom.commands.push_back(mvt::detail::zigzag(point.x));
+                    geom.commands.push_back(mvt::detail::zigzag(point.y));
+                    return geom;
+                }
+
+                /* LineString */
+
+                void linestring_start() {
+                    start_geometry(mvt::geom_type::linestring);
+                }
+
+                void linestring_add_location(const osmium::geom::Coordinates& xy) {
+                    add_location(xy);
+                }
+
+                linestring_type linestring_finish(std::size_t /*num_points*/) {
+                    if (m_points.size() < 2) {
+                        throw osmium::geometry_error{"linestring collapsed in tile"};
+                    }
+
+                    auto& commands = m_geometry.commands;
+                    commands.push_back(mvt::detail::command_integer(mvt::detail::move_to, 1));
+                    encode_point(commands, m_cursor, m_points.front());
+                    commands.push_back(mvt::detail::command_integer(mvt::detail::line_to, static_cast<uint32_t>(m_points.size() - 1)));
+                    for (auto it = std::next(m_points.cbegin()); it != m_points.cend(); ++it) {
+                        encode_point(commands, m_cursor, *it);
+                    }
+
+                    return finish_geometry();
+                }
+
+                /* Polygon */
+
+                void polygon_start() {
+                    start_geometry(mvt::geom_type::polygon);
+                }
+
+                void polygon_add_location(const osmium::geom::Coordinates& xy) {
+                    add_location(xy);
+                }
+
+                polygon_type polygon_finish(std::size_t /*num_points*/) {
+                    if (!encode_ring(true)) {
+                        throw osmium::geometry_error{"polygon collapsed in tile"};
+                    }
+                    return finish_geometry();
+                }
+
+                /* MultiPolygon */
+
+                void multipolygon_start() {
+                    start_geometry(mvt::geom_type::polygon);
+                }
+
+                void multipolygon_polygon_start() {
+                    m_skip_polygon = false;
+                }
+
+                void multipolygon_polygon_finish() {
+                }
+
+                void multipolygon_outer_ring_start() {
+                    m_points.clear();
+                }
+
+                void multipolygon_outer_ring_finish() {
+                    m_skip_polygon = !encode_ring(true);
+                }
+
+                void multipolygon_inner_ring_start() {
+                    m_points.clear();
+                }
+
+                void multipolygon_inner_ring_finish() {
+                    if (!m_skip_polygon) {
+                        encode_ring(false);
+                    }
+                }
+
+                void multipolygon_add_location(const osmium::geom::Coordinates& xy) {
+                    add_location(xy);
+                }
+
+                multipolygon_type multipolygon_finish() {
+                    if (m_num_rings == 0) {
+                        throw osmium::geometry_error{"multipolygon collapsed in tile"};
+                    }
+                    return finish_geometry();
+                }
+
+            }; // class MVTFactoryImpl
+
+        } // namespace detail
+
+        /**
+         * Geometry factory creating vector tile geometries for the tile
+         * given in the constructor. Add the geometries to a
+         * mvt::layer_builder.
+         *
+         * Usage:
+         * @code
+         * const osmium::geom::Tile tile{14, 8800, 5373};
+         * osmium::geom::MVTFactory factory{tile};
+         * osmium::geom::mvt::layer_builder layer{"roads"};
+         * layer.add_feature(factory.create_linestring(way), way.tags(), way.id());
+         * @endcode
+         */
+        using MVTFactory = GeometryFactory<osmium::geom::detail::MVTFactoryImpl, MercatorProjection>;
+
+    } // namespace geom
+
+} // namespace osmium
+
+#endif // OSMIUM_GEOM_MVT_HPP
@@ -76,6 +76,39 @@ namespace osmium {
                 return out;
             }
 
+            /**
+             * Append hex encoded version of the data to the string. The
+             * string is resized only once.
+             */
+            inline void append_hex(std::string& out, const char* data, std::size_t size) {
+                static const char* lookup_hex = "0123456789ABCDEF";
+                const auto offset = out.size();
+                out.resize(offset + size * 2);
+                char* ptr = &out[offset];
+
+                for (std::size_t i = 0; i < size; ++i) {
+                    const auto c = static_cast<unsigned int>(data[i]);
+                    *ptr++ = lookup_hex[(c >> 4U) & 0xfU];
+                    *ptr++ = lookup_hex[ c        & 0xfU];
+                }
+            }
+
+            /**
+             * Hex encode the part of the string starting at offset in place.
+             * Works backwards so no temporary copy is needed.
+             */
+            inline void convert_to_hex_in_place(std::string& str, std::size_t offset) {
+                static const char* lookup_hex = "0123456789ABCDEF";
+                const auto size = str.size() - offset;
+                str.resize(offset + size * 2);
+
+                for (std::size_t i = size; i > 0; --i) {
+                    const auto c = static_cast<unsigned int>(str[offset + i - 1]);
+                    str[offset + i * 2 - 1] = lookup_hex[ c        & 0xfU];
+                    str[offset + i * 2 - 2] = lookup_hex[(c >> 4U) & 0xfU];
+                }
+            }
+
             class WKBFactoryImpl {
 
                 /**
@@ -106,7 +139,12 @@ namespace osmium {
                     NDR = 1          // Little Endian
                 }; // enum class wkb_byte_order_type
 
+            protected:
+
                 std::string m_data;
+
+            private:
+
                 uint32_t m_points = 0;
                 int m_srid;
                 wkb_type m_wkb_type;
@@ -146,6 +184,43 @@ namespace osmium {
                     std::copy_n(reinterpret_cast<const char*>(&s), sizeof(uint32_t), &m_data[offset]);
                 }
 
+            protected:
+
+                bool hex_output() const noexcept {
+                    return m_out_type == out_type::hex;
+                }
+
+                void write_point(std::string& str, const osmium::geom::Coordinates& xy) const {
+                    header(str, wkbPoint, false);
+                    str_push(str, xy.x);
+                    str_push(str, xy.y);
+                }
+
+                void linestring_complete(std::size_t num_points) {
+                    set_size(m_linestring_size_offset, num_points);
+                }
+
+                void polygon_complete(std::size_t num_points) {
+                    set_size(m_ring_size_offset, num_points);
+                }
+
+                void multipolygon_complete() {
+                    set_size(m_multipolygon_size_offset, m_polygons);
+                }
+
+                std::string take_data() {
+                    std::string data;
+
+                    using std::swap;
+                    swap(data, m_data);
+
+                    if (m_out_type == out_type::hex) {
+                        return convert_to_hex(data);
+                    }
+
+                    return data;
+                }
+
             public:
 
                 using point_type        = std::string;
@@ -164,9 +239,7 @@ namespace osmium {
 
                 point_type make_point(const osmium::geom::Coordinates& xy) const {
                     std::string data;
-                    header(data, wkbPoint, false);
-                    str_push(data, xy.x);
-                    str_push(data, xy.y);
+                    write_point(data, xy);
 
                     if (m_out_type == out_type::hex) {
                         return convert_to_hex(data);
@@ -188,17 +261,8 @@ namespace osmium {
                 }
 
                 linestring_type linestring_finish(std::size_t num_points) {
-                    set_size(m_linestring_size_offset, num_points);
-                    std::string data;
-
-                    using std::swap;
-                    swap(data, m_data);
-
-                    if (m_out_type == out_type::hex) {
-                        return convert_to_hex(data);
-                    }
-
-                    return data;
+                    linestring_complete(num_points);
+                    return take_data();
                 }
 
                 /* Polygon */
@@ -216,17 +280,8 @@ namespace osmium {
                 }
 
                 polygon_type polygon_finish(std::size_t num_points) {
-                    set_size(m_ring_size_offset, num_points);
-                    std::string data;
-
-                    using std::swap;
-                    swap(data, m_data);
-
-                    if (m_out_type == out_type::hex) {
-                        return convert_to_hex(data);
-                    }
-
-                    return data;
+                    polygon_complete(num_points);
+                    return take_data();
                 }
 
                 /* MultiPolygon */
@@ -276,26 +331,106 @@ namespace osmium {
                 }
 
                 multipolygon_type multipolygon_finish() {
-                    set_size(m_multipolygon_size_offset, m_polygons);
-                    std::string data;
+                    multipolygon_complete();
+                    return take_data();
+                }
 
-                    using std::swap;
-                    swap(data, m_data);
+            }; // class WKBFactoryImpl
 
-                    if (m_out_type == out_type::hex) {
-                        return convert_to_hex(data);
+            /**
+             * Like the WKBFactoryImpl, but appends all geometries to a
+             * string given in the constructor instead of returning a new
+             * string for each geometry. The string can be reused for any
+             * number of geometries, so there are no memory allocations per
+             * geometry once it is large enough. Hex encoding is done
+             * directly into the output string.
+             *
+             * The functions creating geometries return the number of bytes
+             * appended. If an exception is thrown while a geometry is
+             * created, nothing is appended.
+             */
+            class WKBAppendFactoryImpl : public WKBFactoryImpl {
+
+                std::string* m_out;
+
+                std::size_t append_data() {
+                    const auto size = m_data.size();
+                    if (hex_output()) {
+                        append_hex(*m_out, m_data.data(), size);
+                    } else {
+                        m_out->append(m_data);
                     }
+                    m_data.clear();
+                    return hex_output() ? size * 2 : size;
+                }
 
-                    return data;
+            public:
+
+                using point_type        = std::size_t;
+                using linestring_type   = std::size_t;
+                using polygon_type      = std::size_t;
+                using multipolygon_type = std::size_t;
+                using ring_type         = std::size_t;
+
+                WKBAppendFactoryImpl(int srid, std::string& out, wkb_type wtype = wkb_type::wkb, out_type otype = out_type::binary) :
+                    WKBFactoryImpl(srid, wtype, otype),
+                    m_out(&out) {
                 }
 
-            }; // class WKBFactoryImpl
+                /* Point */
+
+                point_type make_point(const osmium::geom::Coordinates& xy) const {
+                    const auto offset = m_out->size();
+                    write_point(*m_out, xy);
+                    if (hex_output()) {
+                        convert_to_hex_in_place(*m_out, offset);
+                    }
+                    return m_out->size() - offset;
+                }
+
+                /* LineString */
+
+                linestring_type linestring_finish(std::size_t num_points) {
+                    linestring_complete(num_points);
+                    return append_data();
+                }
+
+                /* Polygon */
+
+                polygon_type polygon_finish(std::size_t num_points) {
+                    polygon_complete(num_points);
+                    return append_data();
+                }
+
+                /* MultiPolygon */
+
+                multipolygon_type multipolygon_finish() {
+                    multipolygon_complete();
+                    return append_data();
+                }
+
+            }; // class WKBAppendFactoryImpl
 
         } // namespace detail
 
         template <typename TProjection = IdentityProjection>
         using WKBFactory = GeometryFactory<osmium::geom::detail::WKBFactoryImpl, TProjection>;
 
+        /**
+         * WKB factory appending all geometries to a string given in the
+         * constructor. The create_*() functions return the number of bytes
+         * appended.
+         *
+         * Usage:
+         * @code
+         * std::string out;
+         * osmium::geom::WKBAppendFactory<> factory{out, osmium::geom::wkb_type::ewkb, osmium::geom::out_type::hex};
+         * factory.create_linestring(way);
+         * @endcode
+         */
+        template <typename TProjection = IdentityProjection>
+        using WKBAppendFactory = GeometryFactory<osmium::geom::detail::WKBAppendFactoryImpl, TProjection>;
+
     } // namespace geom
 
 } // namespace osmium
@@ -55,10 +55,44 @@ namespace osmium {
             class WKTFactoryImpl {
 
                 std::string m_srid_prefix;
-                std::string m_str;
                 int m_precision;
                 wkt_type m_wkt_type;
 
+            protected:
+
+                std::string m_str;
+
+                void write_point(std::string& str, const osmium::geom::Coordinates& xy) const {
+                    str += m_srid_prefix;
+                    str += "POINT";
+                    xy.append_to_string(str, '(', ' ', ')', m_precision);
+                }
+
+                void linestring_complete() {
+                    assert(!m_str.empty());
+                    m_str.back() = ')';
+                }
+
+                void polygon_complete() {
+                    assert(!m_str.empty());
+                    m_str.back() = ')';
+                    m_str += ")";
+                }
+
+                void multipolygon_complete() {
+                    assert(!m_str.empty());
+                    m_str.back() = ')';
+                }
+
+                std::string take_data() {
+                    std::string str;
+
+                    using std::swap;
+                    swap(str, m_str);
+
+                    return str;
+                }
+
             public:
 
                 using point_type        = std::string;
@@ -80,9 +114,8 @@ namespace osmium {
                 /* Point */
 
                 point_type make_point(const osmium::geom::Coordinates& xy) const {
-                    std::string str{m_srid_prefix};
-                    str += "POINT";
-                    xy.append_to_string(str, '(', ' ', ')', m_precision);
+                    std::string str;
+                    write_point(str, xy);
                     return str;
                 }
 
@@ -99,14 +132,8 @@ namespace osmium {
                 }
 
                 linestring_type linestring_finish(size_t /* num_points */) {
-                    assert(!m_str.empty());
-                    std::string str;
-
-                    using std::swap;
-                    swap(str, m_str);
-
-                    str.back() = ')';
-                    return str;
+                    linestring_complete();
+                    return take_data();
                 }
 
                 /* Polygon */
@@ -121,15 +148,8 @@ namespace osmium {
                 }
 
                 polygon_type polygon_finish(size_t /* num_points */) {
-                    assert(!m_str.empty());
-                    std::string str;
-
-                    using std::swap;
-                    swap(str, m_str);
-
-                    str.back() = ')';
-                    str += ")";
-                    return str;
+                    polygon_complete();
+                    return take_data();
                 }
 
                 /* MultiPolygon */
@@ -171,23 +191,87 @@ namespace osmium {
                 }
 
                 multipolygon_type multipolygon_finish() {
-                    assert(!m_str.empty());
-                    std::string str;
+                    multipolygon_complete();
+                    return take_data();
+                }
 
-                    using std::swap;
-                    swap(str, m_str);
+            }; // class WKTFactoryImpl
 
-                    str.back() = ')';
-                    return str;
+            /**
+             * Like the WKTFactoryImpl, but appends all geometries to a
+             * string given in the constructor instead of returning a new
+             * string for each geometry. The functions creating geometries
+             * return the number of bytes appended. If an exception is thrown
+             * while a geometry is created, nothing is appended.
+             */
+            class WKTAppendFactoryImpl : public WKTFactoryImpl {
+
+                std::string* m_out;
+
+                std::size_t append_data() {
+                    m_out->append(m_str);
+                    const auto size = m_str.size();
+                    m_str.clear();
+                    return size;
                 }
 
-            }; // class WKTFactoryImpl
+            public:
+
+                using point_type        = std::size_t;
+                using linestring_type   = std::size_t;
+                using polygon_type      = std::size_t;
+                using multipolygon_type = std::size_t;
+                using ring_type         = std::size_t;
+
+                WKTAppendFactoryImpl(int srid, std::string& out, int precision = 7, wkt_type wtype = wkt_type::wkt) :
+                    WKTFactoryImpl(srid, precision, wtype),
+                    m_out(&out) {
+                }
+
+                /* Point */
+
+                point_type make_point(const osmium::geom::Coordinates& xy) const {
+                    const auto offset = m_out->size();
+                    write_point(*m_out, xy);
+                    return m_out->size() - offset;
+                }
+
+                /* LineString */
+
+                linestring_type linestring_finish(size_t /* num_points */) {
+                    linestring_complete();
+                    return append_data();
+                }
+
+                /* Polygon */
+
+                polygon_type polygon_finish(size_t /* num_points */) {
+                    polygon_complete();
+                    return append_data();
+                }
+
+                /* MultiPolygon */
+
+                multipolygon_type multipolygon_finish() {
+                    multipolygon_complete();
+                    return append_data();
+                }
+
+            }; // class WKTAppendFactoryImpl
 
         } // namespace detail
 
         template <typename TProjection = IdentityProjection>
         using WKTFactory = GeometryFactory<osmium::geom::detail::WKTFactoryImpl, TProjection>;
 
+        /**
+         * WKT factory appending all geometries to a string given in the
+         * constructor. The create_*() functions return the number of bytes
+         * appended.
+         */
+        template <typename TProjection = IdentityProjection>
+        using WKTAppendFactory = GeometryFactory<osmium::geom::detail::WKTAppendFactoryImpl, TProjection>;
+
     } // namespace geom
 
 } // namespace osmium
@@ -0,0 +1,139 @@
+#ifndef OSMIUM_HANDLER_NODE_LOCATIONS_UPDATER_HPP
+#define OSMIUM_HANDLER_NODE_LOCATIONS_UPDATER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/handler.hpp>
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstddef>
+#include <type_traits>
+
+namespace osmium {
+
+    namespace handler {
+
+        /**
+         * Handler to apply node changes from a change file (or any other
+         * source of node versions in order) to an existing node location
+         * index. Visible nodes (created or modified) set the location in
+         * the index, deleted nodes remove it.
+         *
+         * Use it like this:
+         * @code
+         * index_type index{fd}; // existing file based index
+         * osmium::handler::NodeLocationsUpdater<index_type> updater{index};
+         * osmium::io::Reader reader{"changes.osc.gz", osmium::osm_entity_bits::node};
+         * osmium::apply(reader, updater);
+         * reader.close();
+         * @endcode
+         *
+         * Dense indexes are updated in place. Sparse indexes based on a
+         * sorted vector (SparseFileArray, SparseMemArray, ...) get the
+         * changes appended which are then merged into the sorted data
+         * when flush() is called. This is done automatically at the end
+         * of osmium::apply().
+         *
+         * Only nodes with positive IDs are used, all others are ignored.
+         *
+         * @tparam TStorage Class that handles the actual storage of the node
+         *                  locations. Must be derived from
+         *                  osmium::index::map::Map.
+         */
+        template <typename TStorage>
+        class NodeLocationsUpdater : public osmium::handler::Handler {
+
+            static_assert(std::is_base_of<osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>, TStorage>::value,
+                          "Index class must be derived from osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>");
+
+            TStorage& m_storage;
+
+            // The size of the storage when it was last sorted/merged.
+            std::size_t m_sorted_size;
+
+            std::size_t m_count_set = 0;
+            std::size_t m_count_removed = 0;
+
+        public:
+
+            explicit NodeLocationsUpdater(TStorage& storage) :
+                m_storage(storage),
+                m_sorted_size(storage.size()) {
+            }
+
+            /**
+             * Set or remove the location of this node in the storage.
+             */
+            void node(const osmium::Node& node) {
+                if (node.id() <= 0) {
+                    return;
+                }
+                if (node.visible()) {
+                    m_storage.set(node.positive_id(), node.location());
+                    ++m_count_set;
+                } else {
+                    m_storage.set(node.positive_id(), osmium::index::empty_value<osmium::Location>());
+                    ++m_count_removed;
+                }
+            }
+
+            /**
+             * Merge all changes into the storage. After this the storage
+             * can be used for lookups again. Can be called several times.
+             */
+            void flush() {
+                m_storage.merge_updates(m_sorted_size);
+                m_sorted_size = m_storage.size();
+            }
+
+            /// The number of node locations set (created or modified).
+            std::size_t count_set() const noexcept {
+                return m_count_set;
+            }
+
+            /// The number of node locations removed (deleted).
+            std::size_t count_removed() const noexcept {
+                return m_count_removed;
+            }
+
+        }; // class NodeLocationsUpdater
+
+    } // namespace handler
+
+} // namespace osmium
+
+#endif // OSMIUM_HANDLER_NODE_LOCATIONS_UPDATER_HPP
@@ -38,7 +38,9 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/detail/read_write.hpp>
 
 #include <algorithm>
+#include <cassert>
 #include <cstddef>
+#include <iterator>
 #include <memory>
 #include <utility>
 
@@ -223,6 +225,44 @@ namespace osmium {
                     std::sort(m_vector.begin(), m_vector.end());
                 }
 
+                /**
+                 * Merge the entries appended with set() after the first
+                 * sorted_size entries into the sorted part of the index.
+                 * Only the unsorted tail is sorted, so this is much cheaper
+                 * than a full sort() if only few entries were added. If
+                 * there are several entries for the same id, the one added
+                 * last wins. Entries with the empty value remove the id.
+                 */
+                void merge_updates(const std::size_t sorted_size) final {
+                    assert(sorted_size <= m_vector.size());
+                    const auto compare_id = [](const element_type& a, const element_type& b) {
+                        return a.first < b.first;
+                    };
+
+                    const auto middle = m_vector.begin() + sorted_size;
+                    std::stable_sort(middle, m_vector.end(), compare_id);
+                    std::inplace_merge(m_vector.begin(), middle, m_vector.end(), compare_id);
+
+                    auto out = m_vector.begin();
+                    for (auto it = m_vector.begin(); it != m_vector.end();) {
+                        auto next = std::next(it);
+                        while (next != m_vector.end() && next->first == it->first) {
+                            ++next;
+                        }
+                        const element_type last = *std::prev(next);
+                        if (last.second != osmium::index::empty_value<TValue>()) {
+                            *out++ = last;
+                        }
+                        it = next;
+                    }
+
+                    // Overwrite the now unused entries, otherwise they would
+                    // show up again when a file based index is re-opened.
+                    const auto new_size = static_cast<std::size_t>(std::distance(m_vector.begin(), out));
+                    std::fill(out, m_vector.end(), osmium::index::empty_value<element_type>());
+                    m_vector.resize(new_size);
+                }
+
                 void dump_as_array(const int fd) final {
                     constexpr const size_t value_size = sizeof(TValue);
                     constexpr const size_t buffer_size = (10L * 1024L * 1024L) / value_size;
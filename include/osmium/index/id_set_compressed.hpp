@@ -0,0 +1,1256 @@
+#ifndef OSMIUM_INDEX_ID_SET_COMPRESSED_HPP
+#define OSMIUM_INDEX_ID_SET_COMPRESSED_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/id_set.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            inline unsigned int popcount_64(uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<unsigned int>(__builtin_popcountll(value));
+#else
+                return static_cast<unsigned int>(std::bitset<64>{value}.count());
+#endif
+            }
+
+            inline unsigned int count_trailing_zeros_64(uint64_t value) noexcept {
+                assert(value != 0);
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<unsigned int>(__builtin_ctzll(value));
+#else
+                unsigned int n = 0;
+                while ((value & 1U) == 0) {
+                    value >>= 1U;
+                    ++n;
+                }
+                return n;
+#endif
+            }
+
+            enum class id_set_container_type : uint32_t {
+                array  = 1,
+                bitmap = 2,
+                run    = 3
+            };
+
+            enum : uint32_t {
+                // Array containers with more entries than this are
+                // converted into bitmap containers. At this size both
+                // need the same amount of memory.
+                id_set_max_array_size = 4096,
+
+                // Number of 64bit words in a bitmap container.
+                id_set_bitmap_words = 1024,
+
+                // Number of Ids in a container.
+                id_set_container_size = 1U << 16U
+            };
+
+            /**
+             * Raw access to the data of a container. Used for containers
+             * in memory and containers in a memory mapped file.
+             *
+             * Array containers store the sorted values, run containers
+             * store pairs of (start, length - 1), bitmap containers store
+             * 1024 64bit words.
+             */
+            struct id_set_container_data {
+
+                id_set_container_type type;
+                const uint16_t* values;
+                const uint64_t* words;
+                std::size_t count;
+
+                bool get(uint16_t value) const noexcept {
+                    switch (type) {
+                        case id_set_container_type::array:
+                            return std::binary_search(values, values + count, value);
+                        case id_set_container_type::bitmap:
+                            return ((words[value >> 6U] >> (value & 63U)) & 1U) != 0;
+                        case id_set_container_type::run:
+                            break;
+                    }
+
+                    // find the last run starting at or before value
+                    std::size_t lo = 0;
+                    std::size_t hi = count / 2;
+                    while (lo < hi) {
+                        const std::size_t mid = (lo + hi) / 2;
+                        if (values[mid * 2] <= value) {
+                            lo = mid + 1;
+                        } else {
+                            hi = mid;
+                        }
+                    }
+                    if (lo == 0) {
+                        return false;
+                    }
+                    return static_cast<uint32_t>(value - values[(lo - 1) * 2]) <= values[(lo - 1) * 2 + 1];
+                }
+
+            }; // struct id_set_container_data
+
+            inline void id_set_set_range(uint64_t* words, uint32_t first, uint32_t last) noexcept {
+                assert(first <= last && last < id_set_container_size);
+                const uint32_t first_word = first >> 6U;
+                const uint32_t last_word = last >> 6U;
+                const uint64_t first_mask = ~0ULL << (first & 63U);
+                const uint64_t last_mask = ~0ULL >> (63U - (last & 63U));
+                if (first_word == last_word) {
+                    words[first_word] |= first_mask & last_mask;
+                    return;
+                }
+                words[first_word] |= first_mask;
+                for (uint32_t i = first_word + 1; i < last_word; ++i) {
+                    words[i] = ~0ULL;
+                }
+                words[last_word] |= last_mask;
+            }
+
+            /**
+             * A container holding up to 2^16 Ids with the same upper
+             * bits. It can be an array, a bitmap, or a run container.
+             * This is the same design as used by "Roaring Bitmaps"
+             * (https://roaringbitmap.org/).
+             */
+            class id_set_container {
+
+                using word_array = std::array<uint64_t, id_set_bitmap_words>;
+
+                // array: sorted values, run: (start, length - 1) pairs
+                std::vector<uint16_t> m_values;
+
+                // bitmap: id_set_bitmap_words words
+                std::vector<uint64_t> m_words;
+
+                uint32_t m_cardinality = 0;
+
+                id_set_container_type m_type = id_set_container_type::array;
+
+                // The loops over the bitmap words in the following
+                // functions are written so that the compiler can
+                // vectorize them.
+
+                static uint32_t cardinality_of(const uint64_t* words) noexcept {
+                    uint32_t count = 0;
+                    for (uint32_t i = 0; i < id_set_bitmap_words; ++i) {
+                        count += popcount_64(words[i]);
+                    }
+                    return count;
+                }
+
+                static void or_words(uint64_t* dest, const uint64_t* src) noexcept {
+                    for (uint32_t i = 0; i < id_set_bitmap_words; ++i) {
+                        dest[i] |= src[i];
+                    }
+                }
+
+                static void and_words(uint64_t* dest, const uint64_t* src) noexcept {
+                    for (uint32_t i = 0; i < id_set_bitmap_words; ++i) {
+                        dest[i] &= src[i];
+                    }
+                }
+
+                static void and_not_words(uint64_t* dest, const uint64_t* src) noexcept {
+                    for (uint32_t i = 0; i < id_set_bitmap_words; ++i) {
+                        dest[i] &= ~src[i];
+                    }
+                }
+
+                static uint32_t and_cardinality(const uint64_t* a, const uint64_t* b) noexcept {
+                    uint32_t count = 0;
+                    for (uint32_t i = 0; i < id_set_bitmap_words; ++i) {
+                        count += popcount_64(a[i] & b[i]);
+                    }
+                    return count;
+                }
+
+                std::size_t num_runs() const noexcept {
+                    return m_values.size() / 2;
+                }
+
+                // Count the runs of consecutive values.
+                std::size_t count_runs() const noexcept {
+                    std::size_t runs = 0;
+                    int64_t last = -2;
+                    for_each([&](uint32_t value) {
+                        if (static_cast<int64_t>(value) != last + 1) {
+                            ++runs;
+                        }
+                        last = value;
+                    });
+                    return runs;
+                }
+
+                // Return pointer to the bitmap words of this container. If
+                // this is not a bitmap container, they are created in the
+                // temporary buffer.
+                const uint64_t* words_or_fill(word_array& tmp) const noexcept {
+                    if (m_type == id_set_container_type::bitmap) {
+                        return m_words.data();
+                    }
+                    fill_words(tmp.data());
+                    return tmp.data();
+                }
+
+                static id_set_container from_words(const uint64_t* words) {
+                    id_set_container result;
+                    result.m_type = id_set_container_type::bitmap;
+                    result.m_words.assign(words, words + id_set_bitmap_words);
+                    result.m_cardinality = cardinality_of(words);
+                    result.normalize();
+                    return result;
+                }
+
+                static id_set_container from_array(std::vector<uint16_t>&& values) {
+                    id_set_container result;
+                    result.m_cardinality = static_cast<uint32_t>(values.size());
+                    result.m_values = std::move(values);
+                    result.normalize();
+                    return result;
+                }
+
+                void to_bitmap() {
+                    if (m_type == id_set_container_type::bitmap) {
+                        return;
+                    }
+                    std::vector<uint64_t> words(id_set_bitmap_words);
+                    fill_words(words.data());
+                    m_words = std::move(words);
+                    m_values = std::vector<uint16_t>{};
+                    m_type = id_set_container_type::bitmap;
+                }
+
+                void to_array() {
+                    if (m_type == id_set_container_type::array) {
+                        return;
+                    }
+                    std::vector<uint16_t> values;
+                    values.reserve(m_cardinality);
+                    for_each([&](uint32_t value) {
+                        values.push_back(static_cast<uint16_t>(value));
+                    });
+                    m_values = std::move(values);
+                    m_words = std::vector<uint64_t>{};
+                    m_type = id_set_container_type::array;
+                }
+
+                // Convert run containers into array or bitmap containers
+                // so that they can be changed.
+                void make_mutable() {
+                    if (m_type == id_set_container_type::run) {
+                        if (m_cardinality <= id_set_max_array_size) {
+                            to_array();
+                        } else {
+                            to_bitmap();
+                        }
+                    }
+                }
+
+            public:
+
+                id_set_container() = default;
+
+                id_set_container(id_set_container_type type, uint32_t cardinality, const uint16_t* values, const uint64_t* words, std::size_t count) :
+                    m_cardinality(cardinality),
+                    m_type(type) {
+                    if (type == id_set_container_type::bitmap) {
+                        m_words.assign(words, words + count);
+                    } else {
+                        m_values.assign(values, values + count);
+                    }
+                }
+
+                id_set_container_type type() const noexcept {
+                    return m_type;
+                }
+
+                uint32_t cardinality() const noexcept {
+                    return m_cardinality;
+                }
+
+                bool empty() const noexcept {
+                    return m_cardinality == 0;
+                }
+
+                id_set_container_data data() const noexcept {
+                    if (m_type == id_set_container_type::bitmap) {
+                        return {m_type, nullptr, m_words.data(), m_words.size()};
+                    }
+                    return {m_type, m_values.data(), nullptr, m_values.size()};
+                }
+
+                std::size_t used_memory() const noexcept {
+                    return sizeof(id_set_container) +
+                           m_values.capacity() * sizeof(uint16_t) +
+                           m_words.capacity() * sizeof(uint64_t);
+                }
+
+                bool get(uint16_t value) const noexcept {
+                    return data().get(value);
+                }
+
+                /**
+                 * Add value to the container.
+                 *
+                 * @returns true if the value was added, false if it was
+                 *          already in the container.
+                 */
+                bool set(uint16_t value) {
+                    make_mutable();
+                    if (m_type == id_set_container_type::array) {
+                        const auto it = std::lower_bound(m_values.begin(), m_values.end(), value);
+                        if (it != m_values.end() && *it == value) {
+                            return false;
+                        }
+                        if (m_cardinality < id_set_max_array_size) {
+                            m_values.insert(it, value);
+                            ++m_cardinality;
+                            return true;
+                        }
+                        to_bitmap();
+                    }
+
+                    auto& word = m_words[value >> 6U];
+                    const uint64_t mask = 1ULL << (value & 63U);
+                    if (word & mask) {
+                        return false;
+                    }
+                    word |= mask;
+                    ++m_cardinality;
+                    return true;
+                }
+
+                /**
+                 * Remove value from the container.
+                 *
+                 * @returns true if the value was removed, false if it
+                 *          wasn't in the container.
+                 */
+                bool unset(uint16_t value) {
+                    make_mutable();
+                    if (m_type == id_set_container_type::array) {
+                        const auto it = std::lower_bound(m_values.begin(), m_values.end(), value);
+                        if (it == m_values.end() || *it != value) {
+                            return false;
+                        }
+                        m_values.erase(it);
+                        --m_cardinality;
+                        return true;
+                    }
+
+                    auto& word = m_words[value >> 6U];
+                    const uint64_t mask = 1ULL << (value & 63U);
+                    if (!(word & mask)) {
+                        return false;
+                    }
+                    word &= ~mask;
+                    --m_cardinality;
+
+                    // Convert back to array only well below the limit so
+                    // that set() and unset() near the limit don't convert
+                    // back and forth all the time.
+                    if (m_cardinality < id_set_max_array_size / 2) {
+                        to_array();
+                    }
+                    return true;
+                }
+
+                /**
+                 * Use array container for small and bitmap container for
+                 * large cardinalities.
+                 */
+                void normalize() {
+                    if (m_cardinality <= id_set_max_array_size) {
+                        to_array();
+                    } else {
+                        to_bitmap();
+                    }
+                }
+
+                /**
+                 * Convert into a run container if that uses less memory
+                 * than the current representation. Converts back into an
+                 * array or bitmap container if a run container is not
+                 * efficient any more.
+                 *
+                 * @returns true if this is a run container now.
+                 */
+                bool run_optimize() {
+                    const std::size_t runs = m_type == id_set_container_type::run ? num_runs() : count_runs();
+                    const std::size_t run_bytes = runs * 2 * sizeof(uint16_t);
+                    const std::size_t other_bytes = m_cardinality <= id_set_max_array_size ?
+                                                    m_cardinality * sizeof(uint16_t) :
+                                                    id_set_bitmap_words * sizeof(uint64_t);
+                    if (run_bytes >= other_bytes) {
+                        make_mutable();
+                        normalize();
+                        return false;
+                    }
+                    if (m_type == id_set_container_type::run) {
+                        return true;
+                    }
+
+                    std::vector<uint16_t> values;
+                    values.reserve(runs * 2);
+                    for_each([&](uint32_t value) {
+                        if (!values.empty() && values[values.size() - 2] + static_cast<uint32_t>(values.back()) + 1 == value) {
+                            ++values.back();
+                        } else {
+                            values.push_back(static_cast<uint16_t>(value));
+                            values.push_back(0);
+                        }
+                    });
+                    m_values = std::move(values);
+                    m_words = std::vector<uint64_t>{};
+                    m_type = id_set_container_type::run;
+                    return true;
+                }
+
+                void shrink_to_fit() {
+                    m_values.shrink_to_fit();
+                    m_words.shrink_to_fit();
+                }
+
+                /**
+                 * Write bitmap representation of this container into
+                 * words (which must have space for id_set_bitmap_words).
+                 */
+                void fill_words(uint64_t* words) const noexcept {
+                    switch (m_type) {
+                        case id_set_container_type::array:
+                            std::fill_n(words, id_set_bitmap_words, 0);
+                            for (const auto value : m_values) {
+                                words[value >> 6U] |= 1ULL << (value & 63U);
+                            }
+                            break;
+                        case id_set_container_type::bitmap:
+                            std::copy_n(m_words.data(), id_set_bitmap_words, words);
+                            break;
+                        case id_set_container_type::run:
+                            std::fill_n(words, id_set_bitmap_words, 0);
+                            for (std::size_t i = 0; i < m_values.size(); i += 2) {
+                                id_set_set_range(words, m_values[i], m_values[i] + static_cast<uint32_t>(m_values[i + 1]));
+                            }
+                            break;
+                    }
+                }
+
+                /**
+                 * Call func with every value in this container in order.
+                 */
+                template <typename TFunc>
+                void for_each(TFunc&& func) const {
+                    switch (m_type) {
+                        case id_set_container_type::array:
+                            for (const auto value : m_values) {
+                                func(static_cast<uint32_t>(value));
+                            }
+                            break;
+                        case id_set_container_type::bitmap:
+                            for (uint32_t i = 0; i < id_set_bitmap_words; ++i) {
+                                uint64_t word = m_words[i];
+                                while (word != 0) {
+                                    func((i << 6U) + count_trailing_zeros_64(word));
+                                    word &= word - 1;
+                                }
+                            }
+                            break;
+                        case id_set_container_type::run:
+                            for (std::size_t i = 0; i < m_values.size(); i += 2) {
+                                const uint32_t last = m_values[i] + static_cast<uint32_t>(m_values[i + 1]);
+                                for (uint32_t value = m_values[i]; value <= last; ++value) {
+                                    func(value);
+                                }
+                            }
+                            break;
+                    }
+                }
+
+                /**
+                 * Find the first value in the container that is not
+                 * smaller than the given value.
+                 *
+                 * @returns value or id_set_container_size if there is none
+                 */
+                uint32_t next(uint32_t value) const noexcept {
+                    if (value >= id_set_container_size) {
+                        return id_set_container_size;
+                    }
+                    switch (m_type) {
+                        case id_set_container_type::array: {
+                                const auto it = std::lower_bound(m_values.begin(), m_values.end(), value);
+                                return it == m_values.end() ? static_cast<uint32_t>(id_set_container_size) : *it;
+                            }
+                        case id_set_container_type::bitmap: {
+                                uint32_t i = value >> 6U;
+                                uint64_t word = m_words[i] & (~0ULL << (value & 63U));
+                                while (word == 0) {
+                                    if (++i == id_set_bitmap_words) {
+                                        return id_set_container_size;
+                                    }
+                                    word = m_words[i];
+                                }
+                                return (i << 6U) + count_trailing_zeros_64(word);
+                            }
+                        case id_set_container_type::run:
+                            break;
+                    }
+                    for (std::size_t i = 0; i < m_values.size(); i += 2) {
+                        const uint32_t last = m_values[i] + static_cast<uint32_t>(m_values[i + 1]);
+                        if (value <= last) {
+                            return std::max(value, static_cast<uint32_t>(m_values[i]));
+                        }
+                    }
+                    return id_set_container_size;
+                }
+
+                static id_set_container set_union(const id_set_container& a, const id_set_container& b) {
+                    if (a.m_type == id_set_container_type::array &&
+                        b.m_type == id_set_container_type::array &&
+                        a.m_cardinality + b.m_cardinality <= id_set_max_array_size) {
+                        std::vector<uint16_t> values;
+                        values.reserve(a.m_cardinality + b.m_cardinality);
+                        std::set_union(a.m_values.begin(), a.m_values.end(),
+                                       b.m_values.begin(), b.m_values.end(),
+                                       std::back_inserter(values));
+                        return from_array(std::move(values));
+                    }
+
+                    word_array words; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+                    a.fill_words(words.data());
+                    if (b.m_type == id_set_container_type::array) {
+                        for (const auto value : b.m_values) {
+                            words[value >> 6U] |= 1ULL << (value & 63U);
+                        }
+                    } else {
+                        word_array tmp; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+                        or_words(words.data(), b.words_or_fill(tmp));
+                    }
+                    return from_words(words.data());
+                }
+
+                static id_set_container set_intersection(const id_set_container& a, const id_set_container& b) {
+                    if (a.m_type == id_set_container_type::array && b.m_type == id_set_container_type::array) {
+                        std::vector<uint16_t> values;
+                        std::set_intersection(a.m_values.begin(), a.m_values.end(),
+                                              b.m_values.begin(), b.m_values.end(),
+                                              std::back_inserter(values));
+                        return from_array(std::move(values));
+                    }
+                    if (b.m_type == id_set_container_type::array) {
+                        return set_intersection(b, a);
+                    }
+                    if (a.m_type == id_set_container_type::array) {
+                        const auto bdata = b.data();
+                        std::vector<uint16_t> values;
+                        std::copy_if(a.m_values.begin(), a.m_values.end(), std::back_inserter(values), [&](uint16_t value) {
+                            return bdata.get(value);
+                        });
+                        return from_array(std::move(values));
+                    }
+
+                    word_array words; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+                    word_array tmp; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+                    a.fill_words(words.data());
+                    and_words(words.data(), b.words_or_fill(tmp));
+                    return from_words(words.data());
+                }
+
+                static id_set_container set_difference(const id_set_container& a, const id_set_container& b) {
+                    if (a.m_type == id_set_container_type::array) {
+                        std::vector<uint16_t> values;
+                        if (b.m_type == id_set_container_type::array) {
+                            std::set_difference(a.m_values.begin(), a.m_values.end(),
+                                                b.m_values.begin(), b.m_values.end(),
+                                                std::back_inserter(values));
+                        } else {
+                            const auto bdata = b.data();
+                            std::copy_if(a.m_values.begin(), a.m_values.end(), std::back_inserter(values), [&](uint16_t value) {
+                                return !bdata.get(value);
+                            });
+                        }
+                        return from_array(std::move(values));
+                    }
+
+                    word_array words; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+                    a.fill_words(words.data());
+                    if (b.m_type == id_set_container_type::array) {
+                        for (const auto value : b.m_values) {
+                            words[value >> 6U] &= ~(1ULL << (value & 63U));
+                        }
+                    } else {
+                        word_array tmp; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+                        and_not_words(words.data(), b.words_or_fill(tmp));
+                    }
+                    return from_words(words.data());
+                }
+
+                static uint32_t intersection_cardinality(const id_set_container& a, const id_set_container& b) noexcept {
+                    if (b.m_type == id_set_container_type::array && a.m_type != id_set_container_type::array) {
+                        return intersection_cardinality(b, a);
+                    }
+                    if (a.m_type == id_set_container_type::array) {
+                        const auto bdata = b.data();
+                        uint32_t count = 0;
+                        for (const auto value : a.m_values) {
+                            if (bdata.get(value)) {
+                                ++count;
+                            }
+                        }
+                        return count;
+                    }
+
+                    word_array tmp_a; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+                    word_array tmp_b; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+                    return and_cardinality(a.words_or_fill(tmp_a), b.words_or_fill(tmp_b));
+                }
+
+            }; // class id_set_container
+
+            // Layout of a file written by IdSetCompressed::dump(). All
+            // numbers are in native byte order. The file starts with the
+            // header, followed by one directory entry for each container,
+            // followed by the container data. Offsets of the data are
+            // from the start of the file and are always a multiple of 8.
+
+            struct id_set_file_header {
+                char magic[8];
+                uint64_t num_containers;
+                uint64_t size;
+            };
+
+            struct id_set_file_directory_entry {
+                uint64_t key;
+                uint32_t type;
+                uint32_t cardinality;
+                uint64_t offset;
+                uint64_t count;
+            };
+
+            constexpr const char id_set_file_magic[8] = {'O', 'S', 'M', 'I', 'D', 'S', '0', '1'};
+
+        } // namespace detail
+
+        template <typename T>
+        class IdSetCompressed;
+
+        template <typename T>
+        class IdSetCompressedView;
+
+        /**
+         * Const_iterator for iterating over a IdSetCompressed.
+         */
+        template <typename T>
+        class IdSetCompressedIterator {
+
+            using id_set = IdSetCompressed<T>;
+
+            const id_set* m_set;
+            std::size_t m_container;
+            uint32_t m_low;
+
+            void next() noexcept {
+                while (m_container < m_set->m_containers.size()) {
+                    m_low = m_set->m_containers[m_container].next(m_low);
+                    if (m_low < detail::id_set_container_size) {
+                        return;
+                    }
+                    ++m_container;
+                    m_low = 0;
+                }
+                m_low = 0;
+            }
+
+        public:
+
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type   = std::ptrdiff_t;
+            using value_type        = T;
+            using pointer           = value_type*;
+            using reference         = value_type&;
+
+            IdSetCompressedIterator(const id_set* set, std::size_t container) noexcept :
+                m_set(set),
+                m_container(container),
+                m_low(0) {
+                next();
+            }
+
+            IdSetCompressedIterator& operator++() noexcept {
+                ++m_low;
+                next();
+                return *this;
+            }
+
+            IdSetCompressedIterator operator++(int) noexcept {
+                IdSetCompressedIterator tmp{*this};
+                operator++();
+                return tmp;
+            }
+
+            bool operator==(const IdSetCompressedIterator& rhs) const noexcept {
+                return m_set == rhs.m_set && m_container == rhs.m_container && m_low == rhs.m_low;
+            }
+
+            bool operator!=(const IdSetCompressedIterator& rhs) const noexcept {
+                return !(*this == rhs);
+            }
+
+            T operator*() const noexcept {
+                assert(m_container < m_set->m_containers.size());
+                return static_cast<T>((m_set->m_keys[m_container] << 16U) | m_low);
+            }
+
+        }; // class IdSetCompressedIterator
+
+        /**
+         * A compressed set of Ids of the given type. Ids are grouped into
+         * containers of 2^16 Ids with the same upper bits. Depending on
+         * the number of Ids in it, a container stores them in a sorted
+         * array or in a bitmap. After calling run_optimize() containers
+         * with long runs of consecutive Ids are stored as runs. This is
+         * the design known as "Roaring Bitmaps".
+         *
+         * Compared to IdSetDense this uses much less memory for sparse
+         * sets and it supports fast bulk operations (union, intersection,
+         * and difference) with other sets. Sets can be written to a file
+         * with dump() and used from there without reading them into
+         * memory with IdSetCompressedView.
+         */
+        template <typename T>
+        class IdSetCompressed : public IdSet<T> {
+
+            static_assert(std::is_unsigned<T>::value, "Needs unsigned type");
+            static_assert(sizeof(T) >= 4, "Needs at least 32bit type");
+
+            friend class IdSetCompressedIterator<T>;
+
+            using container = detail::id_set_container;
+
+            // Upper bits of the Ids in the containers, sorted.
+            std::vector<uint64_t> m_keys;
+
+            std::vector<container> m_containers;
+
+            std::size_t m_size = 0;
+
+            static uint64_t key(T id) noexcept {
+                return static_cast<uint64_t>(id) >> 16U;
+            }
+
+            static uint16_t low(T id) noexcept {
+                return static_cast<uint16_t>(id & 0xffffU);
+            }
+
+            // Find index of container with the given key. Returns
+            // m_keys.size() if not found.
+            std::size_t find_container(uint64_t k) const noexcept {
+                // Fast path for Ids added or looked up in order.
+                if (!m_keys.empty() && m_keys.back() == k) {
+                    return m_keys.size() - 1;
+                }
+                const auto it = std::lower_bound(m_keys.begin(), m_keys.end(), k);
+                if (it == m_keys.end() || *it != k) {
+                    return m_keys.size();
+                }
+                return static_cast<std::size_t>(std::distance(m_keys.begin(), it));
+            }
+
+            container& get_or_create_container(uint64_t k) {
+                if (m_keys.empty() || m_keys.back() < k) {
+                    m_keys.push_back(k);
+                    m_containers.emplace_back();
+                    return m_containers.back();
+                }
+                const auto it = std::lower_bound(m_keys.begin(), m_keys.end(), k);
+                const auto pos = std::distance(m_keys.begin(), it);
+                if (*it != k) {
+                    m_keys.insert(it, k);
+                    m_containers.emplace(m_containers.begin() + pos);
+                }
+                return m_containers[static_cast<std::size_t>(pos)];
+            }
+
+            void recalculate_size() noexcept {
+                m_size = 0;
+                for (const auto& c : m_containers) {
+                    m_size += c.cardinality();
+                }
+            }
+
+            void add_container(uint64_t k, container&& c) {
+                if (!c.empty()) {
+                    m_keys.push_back(k);
+                    m_containers.push_back(std::move(c));
+                }
+            }
+
+        public:
+
+            using const_iterator = IdSetCompressedIterator<T>;
+
+            IdSetCompressed() = default;
+
+            /**
+             * Create set from the data in a view, for instance to
+             * modify a set read from a file.
+             */
+            explicit IdSetCompressed(const IdSetCompressedView<T>& view) {
+                view.copy_to(*this);
+            }
+
+            /**
+             * Add the Id to the set if it is not already in there.
+             *
+             * @param id The Id to set.
+             * @returns true if the Id was added, false if it was already set.
+             */
+            bool check_and_set(T id) {
+                if (get_or_create_container(key(id)).set(low(id))) {
+                    ++m_size;
+                    return true;
+                }
+                return false;
+            }
+
+            /**
+             * Add the given Id to the set.
+             *
+             * @param id The Id to set.
+             */
+            void set(T id) final {
+                (void)check_and_set(id);
+            }
+
+            /**
+             * Remove the given Id from the set.
+             *
+             * @param id The Id to remove.
+             */
+            void unset(T id) {
+                const auto n = find_container(key(id));
+                if (n == m_keys.size()) {
+                    return;
+                }
+                if (m_containers[n].unset(low(id))) {
+                    --m_size;
+                    if (m_containers[n].empty()) {
+                        m_keys.erase(m_keys.begin() + static_cast<std::ptrdiff_t>(n));
+                        m_containers.erase(m_containers.begin() + static_cast<std::ptrdiff_t>(n));
+                    }
+                }
+            }
+
+            /**
+             * Is the Id in the set?
+             *
+             * @param id The Id to check.
+             */
+            bool get(T id) const noexcept final {
+                const auto n = find_container(key(id));
+                if (n == m_keys.size()) {
+                    return false;
+                }
+                return m_containers[n].get(low(id));
+            }
+
+            /**
+             * Is the set empty?
+             */
+            bool empty() const noexcept final {
+                return m_size == 0;
+            }
+
+            /**
+             * The number of Ids stored in the set.
+             */
+            std::size_t size() const noexcept {
+                return m_size;
+            }
+
+            /**
+             * Clear the set.
+             */
+            void clear() final {
+                m_keys.clear();
+                m_containers.clear();
+                m_size = 0;
+            }
+
+            std::size_t used_memory() const noexcept final {
+                std::size_t memory = m_keys.capacity() * sizeof(uint64_t) +
+                                     (m_containers.capacity() - m_containers.size()) * sizeof(container);
+                for (const auto& c : m_containers) {
+                    memory += c.used_memory();
+                }
+                return memory;
+            }
+
+            /**
+             * Convert containers with long runs of consecutive Ids into
+             * run containers if that saves memory. Call this after the
+             * set has been filled. Changing the set afterwards will
+             * convert containers back as needed.
+             */
+            void run_optimize() {
+                for (auto& c : m_containers) {
+                    c.run_optimize();
+                }
+            }
+
+            /**
+             * Release memory not needed any more.
+             */
+            void shrink_to_fit() {
+                m_keys.shrink_to_fit();
+                m_containers.shrink_to_fit();
+                for (auto& c : m_containers) {
+                    c.shrink_to_fit();
+                }
+            }
+
+            /**
+             * Add all Ids from the other set to this set.
+             */
+            IdSetCompressed& operator|=(const IdSetCompressed& other) {
+                IdSetCompressed result;
+                std::size_t i = 0;
+                std::size_t j = 0;
+                while (i < m_keys.size() || j < other.m_keys.size()) {
+                    if (j == other.m_keys.size() || (i < m_keys.size() && m_keys[i] < other.m_keys[j])) {
+                        result.add_container(m_keys[i], std::move(m_containers[i]));
+                        ++i;
+                    } else if (i == m_keys.size() || other.m_keys[j] < m_keys[i]) {
+                        result.add_container(other.m_keys[j], container{other.m_containers[j]});
+                        ++j;
+                    } else {
+                        result.add_container(m_keys[i], container::set_union(m_containers[i], other.m_containers[j]));
+                        ++i;
+                        ++j;
+                    }
+                }
+                result.recalculate_size();
+                *this = std::move(result);
+                return *this;
+            }
+
+            /**
+             * Remove all Ids from this set that are not in the other set.
+             */
+            IdSetCompressed& operator&=(const IdSetCompressed& other) {
+                IdSetCompressed result;
+                std::size_t i = 0;
+                std::size_t j = 0;
+                while (i < m_keys.size() && j < other.m_keys.size()) {
+                    if (m_keys[i] < other.m_keys[j]) {
+                        ++i;
+                    } else if (other.m_keys[j] < m_keys[i]) {
+                        ++j;
+                    } else {
+                        result.add_container(m_keys[i], container::set_intersection(m_containers[i], other.m_containers[j]));
+                        ++i;
+                        ++j;
+                    }
+                }
+                result.recalculate_size();
+                *this = std::move(result);
+                return *this;
+            }
+
+            /**
+             * Remove all Ids from this set that are in the other set.
+             */
+            IdSetCompressed& operator-=(const IdSetCompressed& other) {
+                IdSetCompressed result;
+                std::size_t i = 0;
+                std::size_t j = 0;
+                while (i < m_keys.size()) {
+                    if (j == other.m_keys.size() || m_keys[i] < other.m_keys[j]) {
+                        result.add_container(m_keys[i], std::move(m_containers[i]));
+                        ++i;
+                    } else if (other.m_keys[j] < m_keys[i]) {
+                        ++j;
+                    } else {
+                        result.add_container(m_keys[i], container::set_difference(m_containers[i], other.m_containers[j]));
+                        ++i;
+                        ++j;
+                    }
+                }
+                result.recalculate_size();
+                *this = std::move(result);
+                return *this;
+            }
+
+            /**
+             * The number of Ids in both this and the other set. This is
+             * faster than calculating the intersection.
+             */
+            std::size_t intersection_size(const IdSetCompressed& other) const noexcept {
+                std::size_t count = 0;
+                std::size_t i = 0;
+                std::size_t j = 0;
+                while (i < m_keys.size() && j < other.m_keys.size()) {
+                    if (m_keys[i] < other.m_keys[j]) {
+                        ++i;
+                    } else if (other.m_keys[j] < m_keys[i]) {
+                        ++j;
+                    } else {
+                        count += container::intersection_cardinality(m_containers[i], other.m_containers[j]);
+                        ++i;
+                        ++j;
+                    }
+                }
+                return count;
+            }
+
+            /**
+             * The number of Ids in this or the other set.
+             */
+            std::size_t union_size(const IdSetCompressed& other) const noexcept {
+                return size() + other.size() - intersection_size(other);
+            }
+
+            /**
+             * Call func with every Id in this set in order. This is
+             * faster than using the iterator.
+             */
+            template <typename TFunc>
+            void for_each(TFunc&& func) const {
+                for (std::size_t i = 0; i < m_keys.size(); ++i) {
+                    const uint64_t base = m_keys[i] << 16U;
+                    m_containers[i].for_each([&](uint32_t value) {
+                        func(static_cast<T>(base | value));
+                    });
+                }
+            }
+
+            const_iterator begin() const {
+                return {this, 0};
+            }
+
+            const_iterator end() const {
+                return {this, m_containers.size()};
+            }
+
+            /**
+             * Write this set to a file. The file can be used with the
+             * IdSetCompressedView class. The format uses the native
+             * byte order, so it is not portable between machines with
+             * different endianness.
+             *
+             * @param fd File descriptor of file to write to.
+             * @throws std::system_error If the file could not be written.
+             */
+            void dump(const int fd) const {
+                detail::id_set_file_header header; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+                std::copy_n(detail::id_set_file_magic, sizeof(header.magic), header.magic);
+                header.num_containers = m_keys.size();
+                header.size = m_size;
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&header), sizeof(header));
+
+                std::vector<detail::id_set_file_directory_entry> directory;
+                directory.reserve(m_keys.size());
+                uint64_t offset = sizeof(header) + m_keys.size() * sizeof(detail::id_set_file_directory_entry);
+                for (std::size_t i = 0; i < m_keys.size(); ++i) {
+                    const auto data = m_containers[i].data();
+                    directory.push_back({m_keys[i],
+                                         static_cast<uint32_t>(data.type),
+                                         m_containers[i].cardinality(),
+                                         offset,
+                                         data.count});
+                    const std::size_t bytes = data.words ? data.count * sizeof(uint64_t) : data.count * sizeof(uint16_t);
+                    offset += (bytes + 7U) & ~std::size_t{7U};
+                }
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(directory.data()), directory.size() * sizeof(detail::id_set_file_directory_entry));
+
+                const std::array<char, 8> padding{};
+                for (const auto& c : m_containers) {
+                    const auto data = c.data();
+                    std::size_t bytes = 0;
+                    if (data.words) {
+                        bytes = data.count * sizeof(uint64_t);
+                        osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(data.words), bytes);
+                    } else {
+                        bytes = data.count * sizeof(uint16_t);
+                        osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(data.values), bytes);
+                    }
+                    if (bytes % 8 != 0) {
+                        osmium::io::detail::reliable_write(fd, padding.data(), 8 - bytes % 8);
+                    }
+                }
+            }
+
+            /// @cond INTERNAL
+            void add_raw_container(uint64_t k, container&& c) {
+                assert(m_keys.empty() || m_keys.back() < k);
+                m_size += c.cardinality();
+                add_container(k, std::move(c));
+            }
+            /// @endcond
+
+        }; // class IdSetCompressed
+
+        /**
+         * Read-only access to a IdSetCompressed written to a file with
+         * IdSetCompressed::dump(). The file is memory mapped, lookups
+         * work directly on the mapped data.
+         */
+        template <typename T>
+        class IdSetCompressedView {
+
+            static_assert(std::is_unsigned<T>::value, "Needs unsigned type");
+
+            osmium::util::MemoryMapping m_mapping;
+            const detail::id_set_file_header* m_header;
+            const detail::id_set_file_directory_entry* m_directory;
+
+            detail::id_set_container_data container_data(const detail::id_set_file_directory_entry& entry) const noexcept {
+                const char* data = m_mapping.get_addr<const char>() + entry.offset;
+                const auto type = static_cast<detail::id_set_container_type>(entry.type);
+                if (type == detail::id_set_container_type::bitmap) {
+                    return {type, nullptr, reinterpret_cast<const uint64_t*>(data), entry.count};
+                }
+                return {type, reinterpret_cast<const uint16_t*>(data), nullptr, entry.count};
+            }
+
+            static std::size_t check_size(std::size_t size) {
+                if (size < sizeof(detail::id_set_file_header)) {
+                    throw std::runtime_error{"IdSet file too small"};
+                }
+                return size;
+            }
+
+        public:
+
+            /**
+             * Map IdSet file.
+             *
+             * @param fd File descriptor of file written by
+             *           IdSetCompressed::dump().
+             * @throws std::runtime_error If the file format is wrong.
+             * @throws std::system_error If the mapping fails.
+             */
+            explicit IdSetCompressedView(const int fd) :
+                m_mapping(check_size(osmium::file_size(fd)), osmium::util::MemoryMapping::mapping_mode::readonly, fd),
+                m_header(m_mapping.get_addr<const detail::id_set_file_header>()),
+                m_directory(reinterpret_cast<const detail::id_set_file_directory_entry*>(m_mapping.get_addr<const char>() + sizeof(detail::id_set_file_header))) {
+                if (!std::equal(m_header->magic, m_header->magic + sizeof(m_header->magic), detail::id_set_file_magic)) {
+                    throw std::runtime_error{"Not an IdSet file"};
+                }
+                const std::size_t size = m_mapping.size();
+                if ((size - sizeof(detail::id_set_file_header)) / sizeof(detail::id_set_file_directory_entry) < m_header->num_containers) {
+                    throw std::runtime_error{"IdSet file truncated"};
+                }
+                for (std::size_t i = 0; i < m_header->num_containers; ++i) {
+                    const auto& entry = m_directory[i];
+                    const std::size_t bytes = entry.count * (entry.type == static_cast<uint32_t>(detail::id_set_container_type::bitmap) ? sizeof(uint64_t) : sizeof(uint16_t));
+                    if (entry.offset > size || bytes > size - entry.offset) {
+                        throw std::runtime_error{"IdSet file truncated"};
+                    }
+                }
+            }
+
+            /**
+             * Is the Id in the set?
+             *
+             * @param id The Id to check.
+             */
+            bool get(T id) const noexcept {
+                const uint64_t k = static_cast<uint64_t>(id) >> 16U;
+                const auto* end = m_directory + m_header->num_containers;
+                const auto* it = std::lower_bound(m_directory, end, k, [](const detail::id_set_file_directory_entry& entry, uint64_t key) {
+                    return entry.key < key;
+                });
+                if (it == end || it->key != k) {
+                    return false;
+                }
+                return container_data(*it).get(static_cast<uint16_t>(id & 0xffffU));
+            }
+
+            /**
+             * Is the set empty?
+             */
+            bool empty() const noexcept {
+                return m_header->size == 0;
+            }
+
+            /**
+             * The number of Ids stored in the set.
+             */
+            std::size_t size() const noexcept {
+                return m_header->size;
+            }
+
+            /**
+             * Copy all data into the IdSetCompressed (which must be
+             * empty).
+             */
+            void copy_to(IdSetCompressed<T>& set) const {
+                assert(set.empty());
+                for (std::size_t i = 0; i < m_header->num_containers; ++i) {
+                    const auto& entry = m_directory[i];
+                    const auto data = container_data(entry);
+                    set.add_raw_container(entry.key, detail::id_set_container{data.type, entry.cardinality, data.values, data.words, data.count});
+                }
+            }
+
+        }; // class IdSetCompressedView
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_ID_SET_COMPRESSED_HPP
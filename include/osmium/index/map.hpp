@@ -176,6 +176,25 @@ namespace osmium {
                     // default implementation is empty
                 }
 
+                /**
+                 * Merge updates into a map that was sorted before. Call
+                 * this after setting values in a map that already
+                 * contained sorted data (for instance from a file). Some
+                 * implementations only append in set(). They have to
+                 * bring the data in order again and decide which of
+                 * several values for the same id is the current one.
+                 * For those the value set last wins and setting the
+                 * empty value removes the id from the map.
+                 *
+                 * The default implementation calls sort().
+                 *
+                 * @param sorted_size The size() of the map before the
+                 *                    updates were applied.
+                 */
+                virtual void merge_updates(const std::size_t /*sorted_size*/) {
+                    sort();
+                }
+
                 // This function can usually be const in derived classes,
                 // but not always. It could, for instance, sort internal data.
                 // This is why it is not declared const here.
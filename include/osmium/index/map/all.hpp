@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/index/map/concurrent_flex_mem.hpp> // IWYU pragma: keep
 #include <osmium/index/map/dense_file_array.hpp>  // IWYU pragma: keep
 #include <osmium/index/map/dense_mem_array.hpp>   // IWYU pragma: keep
 #include <osmium/index/map/dense_mmap_array.hpp>  // IWYU pragma: keep
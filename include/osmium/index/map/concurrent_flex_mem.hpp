@@ -0,0 +1,500 @@
+#ifndef OSMIUM_INDEX_MAP_CONCURRENT_FLEX_MEM_HPP
+#define OSMIUM_INDEX_MAP_CONCURRENT_FLEX_MEM_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#define OSMIUM_HAS_INDEX_MAP_CONCURRENT_FLEX_MEM
+
+namespace osmium {
+
+    namespace index {
+
+        namespace map {
+
+            /**
+             * This is a variant of the FlexMem index that can be filled
+             * from several threads at the same time. It is an autoscaling
+             * index that works well with small and large input data. All
+             * data will be held in memory.
+             *
+             * In sparse mode every thread appends to its own buffer, the
+             * buffers are merged when sort() is called. In dense mode the
+             * values are written directly into blocks of 64K entries. The
+             * blocks are allocated on demand using atomic operations, so
+             * no locks are needed to write into the index.
+             *
+             * The set() function is thread-safe, but the same id should
+             * not be set from several threads at the same time. If an id
+             * is set several times from the same thread, the last value
+             * wins. All other functions must only be called when no other
+             * thread is calling set(). Call sort() after all threads are
+             * done and before reading from the index.
+             *
+             * The dense index can only hold ids up to a maximum that is
+             * set in the constructor. The memory needed for the block
+             * table (8 bytes for every 64K ids) is allocated up front.
+             */
+            template <typename TId, typename TValue>
+            class ConcurrentFlexMem : public osmium::index::map::Map<TId, TValue> {
+
+                // This value is based on benchmarks with a planet file and
+                // some smaller files (see FlexMem).
+                enum {
+                    bits = 16
+                };
+
+                enum : uint64_t {
+                    block_size = 1ULL << bits
+                };
+
+                // Minimum number of entries in the sparse index before we
+                // are considering switching to a dense index.
+                enum : uint64_t {
+                    min_dense_entries = 0xffffff
+                };
+
+                // When more than a third of all Ids are in the index, we
+                // switch to the dense index (see FlexMem).
+                enum : uint64_t {
+                    density_factor = 3
+                };
+
+                // Threads report the size of their sparse buffers to the
+                // index after this many entries. This keeps the number of
+                // accesses to shared counters low.
+                enum : std::size_t {
+                    report_interval = 4096
+                };
+
+                // An entry in the sparse index
+                struct entry {
+                    uint64_t id;
+                    TValue value;
+
+                    entry(uint64_t i, TValue v) :
+                        id(i),
+                        value(std::move(v)) {
+                    }
+
+                    bool operator<(const entry other) const noexcept {
+                        return id < other.id;
+                    }
+                };
+
+                // Buffer for sparse entries from one thread.
+                struct thread_buffer {
+                    std::vector<entry> entries;
+                    uint64_t max_id = 0;
+                    std::size_t unreported = 0;
+                };
+
+                // Sorted sparse entries, filled from the thread buffers in
+                // sort().
+                std::vector<entry> m_sparse_entries;
+
+                // Sparse entries not merged yet, one buffer per thread in
+                // the order the buffers were created.
+                std::vector<std::unique_ptr<thread_buffer>> m_thread_buffers;
+
+                // Protects m_thread_buffers.
+                std::mutex m_thread_buffers_mutex;
+
+                std::unique_ptr<std::atomic<TValue*>[]> m_dense_blocks;
+
+                uint64_t m_max_blocks;
+
+                // Number of entries and the maximum Id reported by all
+                // threads. Only used in sparse mode.
+                std::atomic<uint64_t> m_sparse_count{0};
+                std::atomic<uint64_t> m_max_id{0};
+
+                // Set to false in sparse mode and to true in dense mode.
+                std::atomic<bool> m_dense;
+
+                // Used to find the thread buffer for this index.
+                uint64_t m_instance_id;
+
+                static uint64_t block(const uint64_t id) noexcept {
+                    return id >> bits;
+                }
+
+                static uint64_t offset(const uint64_t id) noexcept {
+                    return id & (block_size - 1);
+                }
+
+                static uint64_t next_instance_id() noexcept {
+                    static std::atomic<uint64_t> counter{0};
+                    return ++counter;
+                }
+
+                // Return the buffer of the calling thread for this index.
+                // Every thread keeps a small cache of the buffers it uses,
+                // the mutex is only needed when a new buffer is created.
+                thread_buffer& local_buffer() {
+                    struct cache_entry {
+                        uint64_t instance_id;
+                        thread_buffer* buffer;
+                    };
+                    static thread_local std::vector<cache_entry> cache;
+
+                    for (const auto& ce : cache) {
+                        if (ce.instance_id == m_instance_id) {
+                            return *ce.buffer;
+                        }
+                    }
+
+                    // Entries for indexes that don't exist any more are
+                    // never used again. Limit the cache size in case many
+                    // indexes are created over time. If an entry for a live
+                    // index is thrown out, a new buffer is created for this
+                    // thread. That's okay, because buffers are merged in
+                    // the order they were created.
+                    if (cache.size() >= 16) {
+                        cache.clear();
+                    }
+
+                    thread_buffer* buffer = nullptr;
+                    {
+                        const std::lock_guard<std::mutex> lock{m_thread_buffers_mutex};
+                        m_thread_buffers.emplace_back(new thread_buffer{});
+                        buffer = m_thread_buffers.back().get();
+                    }
+                    cache.push_back(cache_entry{m_instance_id, buffer});
+                    return *buffer;
+                }
+
+                TValue* assure_block(const uint64_t num) {
+                    if (num >= m_max_blocks) {
+                        throw std::out_of_range{"id too large for ConcurrentFlexMem index"};
+                    }
+                    TValue* block_ptr = m_dense_blocks[num].load(std::memory_order_acquire);
+                    if (block_ptr) {
+                        return block_ptr;
+                    }
+
+                    std::unique_ptr<TValue[]> new_block{new TValue[block_size]};
+                    std::fill_n(new_block.get(), block_size, osmium::index::empty_value<TValue>());
+                    if (m_dense_blocks[num].compare_exchange_strong(block_ptr, new_block.get(), std::memory_order_acq_rel)) {
+                        return new_block.release();
+                    }
+
+                    // Another thread was faster, use its block.
+                    return block_ptr;
+                }
+
+                void set_dense(const uint64_t id, const TValue value) {
+                    assure_block(block(id))[offset(id)] = value;
+                }
+
+                TValue get_dense(const uint64_t id) const noexcept {
+                    if (block(id) >= m_max_blocks) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    const TValue* block_ptr = m_dense_blocks[block(id)].load(std::memory_order_acquire);
+                    if (!block_ptr) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    return block_ptr[offset(id)];
+                }
+
+                void flush_to_dense(thread_buffer& buffer) {
+                    for (const auto& e : buffer.entries) {
+                        set_dense(e.id, e.value);
+                    }
+                    buffer.entries.clear();
+                    buffer.entries.shrink_to_fit();
+                    buffer.max_id = 0;
+                    buffer.unreported = 0;
+                }
+
+                void report(thread_buffer& buffer) {
+                    const uint64_t count = m_sparse_count.fetch_add(buffer.unreported, std::memory_order_relaxed) + buffer.unreported;
+                    buffer.unreported = 0;
+
+                    uint64_t max_id = m_max_id.load(std::memory_order_relaxed);
+                    while (buffer.max_id > max_id &&
+                           !m_max_id.compare_exchange_weak(max_id, buffer.max_id, std::memory_order_relaxed)) {
+                    }
+                    max_id = std::max(max_id, buffer.max_id);
+
+                    // Entries merged in an earlier call to sort() can't be
+                    // moved safely while other threads are writing, in that
+                    // case switching is left to the next sort().
+                    if (m_sparse_entries.empty() && count >= min_dense_entries && max_id < count * density_factor) {
+                        m_dense.store(true, std::memory_order_release);
+                    }
+                }
+
+                void set_sparse(thread_buffer& buffer, const uint64_t id, const TValue value) {
+                    buffer.entries.emplace_back(id, value);
+                    if (id > buffer.max_id) {
+                        buffer.max_id = id;
+                    }
+                    if (++buffer.unreported >= report_interval) {
+                        report(buffer);
+                    }
+                }
+
+                TValue get_sparse(const uint64_t id) const noexcept {
+                    const auto it = std::lower_bound(m_sparse_entries.begin(),
+                                                     m_sparse_entries.end(),
+                                                     entry{id, osmium::index::empty_value<TValue>()});
+                    if (it == m_sparse_entries.end() || it->id != id) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    return it->value;
+                }
+
+                void free_dense_blocks() noexcept {
+                    for (uint64_t i = 0; i < m_max_blocks; ++i) {
+                        delete[] m_dense_blocks[i].exchange(nullptr);
+                    }
+                }
+
+            public:
+
+                /**
+                 * Create ConcurrentFlexMem index.
+                 *
+                 * @param use_dense Usually indexes start out as sparse
+                 *                  indexes and will switch to dense when they
+                 *                  think it is better. Set this to force dense
+                 *                  indexing from the start.
+                 * @param max_id_bits Number of bits for the largest Id
+                 *                    that can be stored in dense mode. The
+                 *                    default allows for Ids up to 2^36.
+                 */
+                explicit ConcurrentFlexMem(bool use_dense = false, unsigned int max_id_bits = 36) :
+                    m_dense_blocks(new std::atomic<TValue*>[max_id_bits > bits ? 1ULL << (max_id_bits - bits) : 1]),
+                    m_max_blocks(max_id_bits > bits ? 1ULL << (max_id_bits - bits) : 1),
+                    m_dense(use_dense),
+                    m_instance_id(next_instance_id()) {
+                    for (uint64_t i = 0; i < m_max_blocks; ++i) {
+                        m_dense_blocks[i].store(nullptr, std::memory_order_relaxed);
+                    }
+                }
+
+                ConcurrentFlexMem(const ConcurrentFlexMem&) = delete;
+                ConcurrentFlexMem& operator=(const ConcurrentFlexMem&) = delete;
+
+                ConcurrentFlexMem(ConcurrentFlexMem&&) = delete;
+                ConcurrentFlexMem& operator=(ConcurrentFlexMem&&) = delete;
+
+                ~ConcurrentFlexMem() noexcept override {
+                    free_dense_blocks();
+                }
+
+                bool is_dense() const noexcept {
+                    return m_dense.load(std::memory_order_acquire);
+                }
+
+                std::size_t size() const noexcept final {
+                    if (is_dense()) {
+                        for (uint64_t num = m_max_blocks; num > 0; --num) {
+                            if (m_dense_blocks[num - 1].load(std::memory_order_acquire)) {
+                                return num * block_size;
+                            }
+                        }
+                        return 0;
+                    }
+                    std::size_t count = m_sparse_entries.size();
+                    for (const auto& buffer : m_thread_buffers) {
+                        count += buffer->entries.size();
+                    }
+                    return count;
+                }
+
+                std::size_t used_memory() const noexcept final {
+                    std::size_t used_blocks = 0;
+                    for (uint64_t i = 0; i < m_max_blocks; ++i) {
+                        if (m_dense_blocks[i].load(std::memory_order_acquire)) {
+                            ++used_blocks;
+                        }
+                    }
+                    std::size_t buffered = 0;
+                    for (const auto& buffer : m_thread_buffers) {
+                        buffered += buffer->entries.capacity();
+                    }
+                    return sizeof(ConcurrentFlexMem) +
+                           (m_sparse_entries.capacity() + buffered) * sizeof(entry) +
+                           m_max_blocks * sizeof(std::atomic<TValue*>) +
+                           used_blocks * block_size * sizeof(TValue);
+                }
+
+                /**
+                 * Set the field with id to value. Can be called from
+                 * several threads at the same time.
+                 */
+                void set(const TId id, const TValue value) final {
+                    thread_buffer& buffer = local_buffer();
+                    if (is_dense()) {
+                        if (!buffer.entries.empty()) {
+                            // Switched to dense mode after this thread wrote
+                            // sparse entries. Move them over first so that
+                            // their order is kept.
+                            flush_to_dense(buffer);
+                        }
+                        set_dense(id, value);
+                        return;
+                    }
+                    set_sparse(buffer, id, value);
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    if (is_dense()) {
+                        return get_dense(id);
+                    }
+                    return get_sparse(id);
+                }
+
+                TValue get(const TId id) const final {
+                    const auto value = get_noexcept(id);
+                    if (value == osmium::index::empty_value<TValue>()) {
+                        throw osmium::not_found{id};
+                    }
+                    return value;
+                }
+
+                void clear() final {
+                    m_sparse_entries.clear();
+                    m_sparse_entries.shrink_to_fit();
+                    for (auto& buffer : m_thread_buffers) {
+                        buffer->entries.clear();
+                        buffer->entries.shrink_to_fit();
+                        buffer->max_id = 0;
+                        buffer->unreported = 0;
+                    }
+                    free_dense_blocks();
+                    m_sparse_count = 0;
+                    m_max_id = 0;
+                    m_dense = false;
+                }
+
+                /**
+                 * Merge the entries from all threads. Call this after
+                 * all threads are done writing and before reading. Might
+                 * switch the index to dense mode.
+                 */
+                void sort() final {
+                    if (is_dense()) {
+                        for (auto& buffer : m_thread_buffers) {
+                            flush_to_dense(*buffer);
+                        }
+                        return;
+                    }
+
+                    const auto sorted_size = m_sparse_entries.size();
+                    for (auto& buffer : m_thread_buffers) {
+                        std::copy(buffer->entries.begin(), buffer->entries.end(), std::back_inserter(m_sparse_entries));
+                        buffer->entries.clear();
+                        buffer->entries.shrink_to_fit();
+                        buffer->max_id = 0;
+                        buffer->unreported = 0;
+                    }
+
+                    // Stable sort and merge keep the order of entries with
+                    // the same id, so we can keep the last one.
+                    const auto middle = m_sparse_entries.begin() + static_cast<std::ptrdiff_t>(sorted_size);
+                    std::stable_sort(middle, m_sparse_entries.end());
+                    std::inplace_merge(m_sparse_entries.begin(), middle, m_sparse_entries.end());
+
+                    auto out = m_sparse_entries.begin();
+                    for (auto it = m_sparse_entries.begin(); it != m_sparse_entries.end(); ++it) {
+                        if (out != m_sparse_entries.begin() && std::prev(out)->id == it->id) {
+                            *std::prev(out) = *it;
+                        } else {
+                            *out++ = *it;
+                        }
+                    }
+                    m_sparse_entries.erase(out, m_sparse_entries.end());
+
+                    m_sparse_count = m_sparse_entries.size();
+                    m_max_id = m_sparse_entries.empty() ? 0 : m_sparse_entries.back().id;
+                    if (m_sparse_entries.size() >= min_dense_entries &&
+                        m_max_id < m_sparse_entries.size() * density_factor) {
+                        switch_to_dense();
+                    }
+                }
+
+                /**
+                 * Switch from using a sparse to a dense index. Usually you
+                 * do not need to call this, because the index will do this
+                 * automatically if it thinks the dense index is more
+                 * efficient.
+                 *
+                 * Must not be called while other threads call set().
+                 */
+                void switch_to_dense() {
+                    if (is_dense()) {
+                        return;
+                    }
+                    for (const auto& e : m_sparse_entries) {
+                        set_dense(e.id, e.value);
+                    }
+                    m_sparse_entries.clear();
+                    m_sparse_entries.shrink_to_fit();
+                    for (auto& buffer : m_thread_buffers) {
+                        flush_to_dense(*buffer);
+                    }
+                    m_sparse_count = 0;
+                    m_max_id = 0;
+                    m_dense = true;
+                }
+
+            }; // class ConcurrentFlexMem
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#ifdef OSMIUM_WANT_NODE_LOCATION_MAPS
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::ConcurrentFlexMem, concurrent_flex_mem)
+#endif
+
+#endif // OSMIUM_INDEX_MAP_CONCURRENT_FLEX_MEM_HPP
@@ -71,6 +71,10 @@ DEALINGS IN THE SOFTWARE.
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseMmapArray, sparse_mmap_array)
 #endif
 
+#ifdef OSMIUM_HAS_INDEX_MAP_CONCURRENT_FLEX_MEM
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::ConcurrentFlexMem, concurrent_flex_mem)
+#endif
+
 #ifdef OSMIUM_HAS_INDEX_MAP_FLEX_MEM
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::FlexMem, flex_mem)
 #endif
@@ -0,0 +1,513 @@
+#ifndef OSMIUM_INDEX_NODE_WAYS_INDEX_HPP
+#define OSMIUM_INDEX_NODE_WAYS_INDEX_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            enum : uint64_t {
+                // Number of bits of the node Id used for the position
+                // in a block. All node lists in a block are stored one
+                // after the other, only the start of each block is
+                // stored in the offset table.
+                node_ways_block_bits = 6,
+                node_ways_block_size = 1ULL << node_ways_block_bits
+            };
+
+            inline void node_ways_add_varint(std::vector<unsigned char>& out, uint64_t value) {
+                while (value >= 0x80U) {
+                    out.push_back(static_cast<unsigned char>((value & 0x7fU) | 0x80U));
+                    value >>= 7U;
+                }
+                out.push_back(static_cast<unsigned char>(value));
+            }
+
+            inline uint64_t node_ways_decode_varint(const unsigned char** data) noexcept {
+                uint64_t value = 0;
+                unsigned int shift = 0;
+                while (**data & 0x80U) {
+                    value |= static_cast<uint64_t>(**data & 0x7fU) << shift;
+                    shift += 7;
+                    ++*data;
+                }
+                value |= static_cast<uint64_t>(**data) << shift;
+                ++*data;
+                return value;
+            }
+
+            inline void node_ways_skip_varints(const unsigned char** data, uint64_t count) noexcept {
+                while (count > 0) {
+                    if (!(**data & 0x80U)) {
+                        --count;
+                    }
+                    ++*data;
+                }
+            }
+
+            // Layout of a file written by NodeWaysIndex::dump(). All
+            // numbers are in native byte order. The header is followed
+            // by num_blocks + 1 offsets (uint64_t) into the data which
+            // follows them.
+            struct node_ways_file_header {
+                char magic[8];
+                uint64_t num_blocks;
+                uint64_t data_size;
+                uint64_t num_edges;
+            };
+
+            constexpr const char node_ways_file_magic[8] = {'O', 'S', 'M', 'N', 'W', 'I', '0', '1'};
+
+        } // namespace detail
+
+        /**
+         * Index from node Ids to the Ids of all ways using those nodes.
+         *
+         * The data is stored in a compressed sparse row layout: For each
+         * node the sorted list of way Ids is stored delta and varint
+         * encoded. The lists of 64 consecutive node Ids form a block,
+         * an offset table has the start position of each block. This
+         * needs about 2 to 3 bytes per node-way-relationship for typical
+         * OSM data plus 8 bytes per 64 node Ids compared to 16 bytes per
+         * relationship for a multimap.
+         *
+         * Use the NodeWaysIndexBuilder class to create an index. The index
+         * can be written to disk with dump() and memory mapped from there.
+         *
+         * Note: This index only works if either all object IDs are
+         *       positive or all object IDs are negative (like the
+         *       ObjectRelations handler).
+         */
+        class NodeWaysIndex {
+
+            std::vector<uint64_t> m_offsets_data;
+            std::vector<unsigned char> m_data_data;
+            std::unique_ptr<osmium::util::MemoryMapping> m_mapping;
+
+            const uint64_t* m_offsets = nullptr;
+            const unsigned char* m_data = nullptr;
+            uint64_t m_num_blocks = 0;
+            uint64_t m_data_size = 0;
+            uint64_t m_num_edges = 0;
+
+            // Get pointer to start of the list for node with given id.
+            const unsigned char* find_list(unsigned_object_id_type id) const noexcept {
+                const uint64_t block = id >> detail::node_ways_block_bits;
+                if (block >= m_num_blocks) {
+                    return nullptr;
+                }
+                const unsigned char* data = m_data + m_offsets[block];
+                for (uint64_t n = id & (detail::node_ways_block_size - 1); n > 0; --n) {
+                    const auto count = detail::node_ways_decode_varint(&data);
+                    detail::node_ways_skip_varints(&data, count);
+                }
+                return data;
+            }
+
+        public:
+
+            /// Create an empty index.
+            NodeWaysIndex() = default;
+
+            /**
+             * Create index from data. Usually you'll use the
+             * NodeWaysIndexBuilder instead of calling this directly.
+             */
+            NodeWaysIndex(std::vector<uint64_t>&& offsets, std::vector<unsigned char>&& data, uint64_t num_edges) :
+                m_offsets_data(std::move(offsets)),
+                m_data_data(std::move(data)),
+                m_offsets(m_offsets_data.data()),
+                m_data(m_data_data.data()),
+                m_num_blocks(m_offsets_data.empty() ? 0 : m_offsets_data.size() - 1),
+                m_data_size(m_data_data.size()),
+                m_num_edges(num_edges) {
+            }
+
+            /**
+             * Memory map an index written to a file with dump(). The file
+             * must not be changed while the index is used.
+             *
+             * @param fd File descriptor of the file.
+             * @throws std::runtime_error If the file format is wrong.
+             * @throws std::system_error If the mapping fails.
+             */
+            explicit NodeWaysIndex(const int fd) {
+                const auto file_size = osmium::file_size(fd);
+                if (file_size < sizeof(detail::node_ways_file_header)) {
+                    throw std::runtime_error{"Node ways index file too small"};
+                }
+                m_mapping.reset(new osmium::util::MemoryMapping{file_size, osmium::util::MemoryMapping::mapping_mode::readonly, fd});
+                const auto* header = m_mapping->get_addr<const detail::node_ways_file_header>();
+                if (!std::equal(header->magic, header->magic + sizeof(header->magic), detail::node_ways_file_magic)) {
+                    throw std::runtime_error{"Not a node ways index file"};
+                }
+                const uint64_t offsets_size = (header->num_blocks + 1) * sizeof(uint64_t);
+                if (file_size - sizeof(detail::node_ways_file_header) < offsets_size ||
+                    file_size - sizeof(detail::node_ways_file_header) - offsets_size < header->data_size) {
+                    throw std::runtime_error{"Node ways index file truncated"};
+                }
+                m_num_blocks = header->num_blocks;
+                m_data_size = header->data_size;
+                m_num_edges = header->num_edges;
+                m_offsets = reinterpret_cast<const uint64_t*>(m_mapping->get_addr<const char>() + sizeof(detail::node_ways_file_header));
+                m_data = reinterpret_cast<const unsigned char*>(m_offsets + m_num_blocks + 1);
+            }
+
+            NodeWaysIndex(const NodeWaysIndex&) = delete;
+            NodeWaysIndex& operator=(const NodeWaysIndex&) = delete;
+
+            NodeWaysIndex(NodeWaysIndex&&) noexcept = default;
+            NodeWaysIndex& operator=(NodeWaysIndex&&) noexcept = default;
+
+            ~NodeWaysIndex() noexcept = default;
+
+            /**
+             * The number of node-way-relationships in the index.
+             */
+            uint64_t size() const noexcept {
+                return m_num_edges;
+            }
+
+            bool empty() const noexcept {
+                return m_num_edges == 0;
+            }
+
+            /**
+             * Get an estimate of the memory (or disk space) used for
+             * the index.
+             */
+            std::size_t used_memory() const noexcept {
+                return (m_num_blocks + 1) * sizeof(uint64_t) + m_data_size;
+            }
+
+            /**
+             * The number of ways using the node with the given id.
+             */
+            std::size_t count(unsigned_object_id_type node_id) const noexcept {
+                const unsigned char* data = find_list(node_id);
+                if (!data) {
+                    return 0;
+                }
+                return detail::node_ways_decode_varint(&data);
+            }
+
+            /**
+             * Call func with the Id of each way using the node with the
+             * given id. The way Ids are in order.
+             */
+            template <typename TFunc>
+            void for_each(unsigned_object_id_type node_id, TFunc&& func) const {
+                const unsigned char* data = find_list(node_id);
+                if (!data) {
+                    return;
+                }
+                uint64_t way_id = 0;
+                for (auto count = detail::node_ways_decode_varint(&data); count > 0; --count) {
+                    way_id += detail::node_ways_decode_varint(&data);
+                    func(static_cast<unsigned_object_id_type>(way_id));
+                }
+            }
+
+            /**
+             * Get the Ids of all ways using the node with the given id
+             * in order.
+             */
+            std::vector<unsigned_object_id_type> get(unsigned_object_id_type node_id) const {
+                std::vector<unsigned_object_id_type> result;
+                result.reserve(count(node_id));
+                for_each(node_id, [&](unsigned_object_id_type way_id) {
+                    result.push_back(way_id);
+                });
+                return result;
+            }
+
+            /**
+             * Write this index to a file. The file can be memory mapped
+             * with the NodeWaysIndex(int fd) constructor. The format uses
+             * the native byte order, so it is not portable between
+             * machines with different endianness.
+             *
+             * @throws std::system_error If the file could not be written.
+             */
+            void dump(const int fd) const {
+                detail::node_ways_file_header header; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+                std::copy_n(detail::node_ways_file_magic, sizeof(header.magic), header.magic);
+                header.num_blocks = m_num_blocks;
+                header.data_size = m_data_size;
+                header.num_edges = m_num_edges;
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&header), sizeof(header));
+
+                const uint64_t zero = 0;
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(m_offsets ? m_offsets : &zero), (m_num_blocks + 1) * sizeof(uint64_t));
+                if (m_data_size > 0) {
+                    osmium::io::detail::reliable_write(fd, m_data, m_data_size);
+                }
+            }
+
+        }; // class NodeWaysIndex
+
+        /**
+         * Builds a NodeWaysIndex. The ways have to be read twice:
+         *
+         * @code
+         * NodeWaysIndexBuilder builder;
+         * // first pass over all ways
+         * builder.count(way); // for each way
+         * builder.prepare();
+         * // second pass over the same ways
+         * builder.add(way); // for each way
+         * NodeWaysIndex index = builder.build();
+         * @endcode
+         *
+         * The first pass only counts the ways for each node, so that all
+         * way Ids can be written directly to their final position in the
+         * second pass. This needs 4 bytes per node Id and 8 bytes per
+         * node-way-relationship while building. Sorting and encoding the
+         * lists is done in parallel in the thread pool in build().
+         */
+        class NodeWaysIndexBuilder {
+
+            // Number of node Ids encoded in one task in build().
+            enum : uint64_t {
+                nodes_per_task = 1ULL << 22U
+            };
+
+            // Pass 1: Number of ways for each node. Pass 2: The position
+            // in the block of the way Ids for the next node.
+            std::vector<uint32_t> m_counts;
+
+            // Start of each block in m_edges.
+            std::vector<uint64_t> m_block_starts;
+
+            std::vector<unsigned_object_id_type> m_edges;
+
+            std::vector<unsigned_object_id_type> m_way_nodes;
+
+            uint64_t m_num_edges = 0;
+
+            uint64_t m_num_added = 0;
+
+            bool m_prepared = false;
+
+            // Get the unique node Ids of this way into m_way_nodes.
+            void way_nodes(const osmium::Way& way) {
+                m_way_nodes.clear();
+                for (const auto& node_ref : way.nodes()) {
+                    m_way_nodes.push_back(node_ref.positive_ref());
+                }
+                std::sort(m_way_nodes.begin(), m_way_nodes.end());
+                m_way_nodes.erase(std::unique(m_way_nodes.begin(), m_way_nodes.end()), m_way_nodes.end());
+            }
+
+            struct encoded_blocks {
+                std::vector<uint64_t> offsets;
+                std::vector<unsigned char> data;
+            };
+
+            encoded_blocks encode(uint64_t first_block, uint64_t last_block) {
+                encoded_blocks result;
+                result.offsets.reserve(last_block - first_block);
+                for (uint64_t block = first_block; block < last_block; ++block) {
+                    result.offsets.push_back(result.data.size());
+                    const auto* base = &m_counts[block * detail::node_ways_block_size];
+                    uint32_t start = 0;
+                    for (uint64_t n = 0; n < detail::node_ways_block_size; ++n) {
+                        const auto first = m_edges.begin() + static_cast<std::ptrdiff_t>(m_block_starts[block] + start);
+                        const auto last = m_edges.begin() + static_cast<std::ptrdiff_t>(m_block_starts[block] + base[n]);
+                        std::sort(first, last);
+                        detail::node_ways_add_varint(result.data, base[n] - start);
+                        unsigned_object_id_type prev = 0;
+                        for (auto it = first; it != last; ++it) {
+                            detail::node_ways_add_varint(result.data, *it - prev);
+                            prev = *it;
+                        }
+                        start = base[n];
+                    }
+                }
+                return result;
+            }
+
+        public:
+
+            /**
+             * Pass 1: Count the nodes of this way.
+             */
+            void count(const osmium::Way& way) {
+                assert(!m_prepared);
+                way_nodes(way);
+                if (!m_way_nodes.empty() && m_way_nodes.back() >= m_counts.size()) {
+                    const auto blocks = (m_way_nodes.back() >> detail::node_ways_block_bits) + 1;
+                    m_counts.resize(blocks * detail::node_ways_block_size);
+                }
+                for (const auto id : m_way_nodes) {
+                    ++m_counts[id];
+                }
+                m_num_edges += m_way_nodes.size();
+            }
+
+            /**
+             * Call this after pass 1 and before pass 2.
+             */
+            void prepare() {
+                assert(!m_prepared);
+                const uint64_t num_blocks = m_counts.size() / detail::node_ways_block_size;
+                m_block_starts.reserve(num_blocks + 1);
+                uint64_t sum = 0;
+                for (uint64_t block = 0; block < num_blocks; ++block) {
+                    m_block_starts.push_back(sum);
+                    uint32_t in_block = 0;
+                    for (uint64_t n = block * detail::node_ways_block_size; n < (block + 1) * detail::node_ways_block_size; ++n) {
+                        const auto count = m_counts[n];
+                        m_counts[n] = in_block;
+                        in_block += count;
+                    }
+                    sum += in_block;
+                }
+                m_block_starts.push_back(sum);
+                assert(sum == m_num_edges);
+                m_edges.resize(m_num_edges);
+                m_prepared = true;
+            }
+
+            /**
+             * Pass 2: Add the way to the index. The same ways as in pass
+             * 1 have to be added.
+             *
+             * @throws std::runtime_error If a way wasn't seen in pass 1.
+             */
+            void add(const osmium::Way& way) {
+                assert(m_prepared);
+                way_nodes(way);
+                for (const auto id : m_way_nodes) {
+                    const uint64_t block = id >> detail::node_ways_block_bits;
+                    if (block + 1 >= m_block_starts.size()) {
+                        throw std::runtime_error{"Way not seen in first pass of NodeWaysIndexBuilder"};
+                    }
+                    const uint64_t pos = m_block_starts[block] + m_counts[id];
+                    if (pos >= m_block_starts[block + 1]) {
+                        throw std::runtime_error{"Way not seen in first pass of NodeWaysIndexBuilder"};
+                    }
+                    m_edges[pos] = way.positive_id();
+                    ++m_counts[id];
+                    ++m_num_added;
+                }
+            }
+
+            /**
+             * Build the index. Call this after pass 2. The builder can't
+             * be used any more after this.
+             *
+             * @param pool Thread pool used for sorting and encoding.
+             * @throws std::runtime_error If not all ways from pass 1 were
+             *         added in pass 2.
+             */
+            NodeWaysIndex build(osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+                if (!m_prepared) {
+                    prepare();
+                }
+                if (m_num_added != m_num_edges) {
+                    throw std::runtime_error{"Not all ways from first pass of NodeWaysIndexBuilder were added"};
+                }
+
+                const uint64_t num_blocks = m_block_starts.size() - 1;
+                const uint64_t blocks_per_task = nodes_per_task / detail::node_ways_block_size;
+
+                std::vector<std::future<encoded_blocks>> futures;
+                std::vector<uint64_t> offsets;
+                std::vector<unsigned char> data;
+                try {
+                    for (uint64_t block = 0; block < num_blocks; block += blocks_per_task) {
+                        const uint64_t last_block = std::min(block + blocks_per_task, num_blocks);
+                        futures.push_back(pool.submit([this, block, last_block]() {
+                            return encode(block, last_block);
+                        }));
+                    }
+
+                    offsets.reserve(num_blocks + 1);
+                    for (auto& future : futures) {
+                        const auto encoded = future.get();
+                        const uint64_t base = data.size();
+                        for (const auto offset : encoded.offsets) {
+                            offsets.push_back(base + offset);
+                        }
+                        data.insert(data.end(), encoded.data.begin(), encoded.data.end());
+                    }
+                } catch (...) {
+                    // The tasks still running use this object, wait for
+                    // them before the exception leaves this function.
+                    for (auto& future : futures) {
+                        if (future.valid()) {
+                            future.wait();
+                        }
+                    }
+                    throw;
+                }
+                offsets.push_back(data.size());
+
+                const auto num_edges = m_num_edges;
+                m_counts = std::vector<uint32_t>{};
+                m_block_starts = std::vector<uint64_t>{};
+                m_edges = std::vector<unsigned_object_id_type>{};
+                m_num_edges = 0;
+                m_num_added = 0;
+
+                return NodeWaysIndex{std::move(offsets), std::move(data), num_edges};
+            }
+
+        }; // class NodeWaysIndexBuilder
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_NODE_WAYS_INDEX_HPP
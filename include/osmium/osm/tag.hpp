@@ -39,6 +39,8 @@ DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <iosfwd>
 #include <iterator>
@@ -118,10 +120,51 @@ namespace osmium {
 
     class TagList : public osmium::memory::Collection<Tag, osmium::item_type::tag_list> {
 
-        const_iterator find_key(const char* key) const noexcept {
-            return std::find_if(cbegin(), cend(), [key](const Tag& tag) {
-                return !std::strcmp(tag.key(), key);
-            });
+        // Skip over a key or value returning a pointer to the next string.
+        static const char* skip_string(const char* ptr) noexcept {
+            return std::strchr(ptr, 0) + 1;
+        }
+
+        // Returns a pointer to the key of the tag with the given key or
+        // nullptr if there is no such tag.
+        //
+        // All keys and values are stored one after the other in the tag
+        // list, so this works on the raw data: The first (up to) 8 bytes of
+        // the key including the terminating 0 are compared with the tag
+        // keys in one go using a 64 bit word. Only if that matches the rest
+        // of the key is compared with strcmp(), the matched bytes contain no
+        // 0 byte, so this never reads beyond the end of the tag key. Reading
+        // 8 bytes is always allowed here as long as they are inside the
+        // padded item.
+        const char* find_key_data(const char* key) const noexcept {
+            const auto key_size = std::strlen(key) + 1;
+            const auto prefix_size = std::min(key_size, sizeof(uint64_t));
+
+            uint64_t prefix = 0;
+            uint64_t mask = 0;
+            std::memcpy(&prefix, key, prefix_size);
+            std::memset(&mask, 0xff, prefix_size);
+
+            const auto* ptr = reinterpret_cast<const char*>(data() + sizeof(TagList));
+            const auto* const end = reinterpret_cast<const char*>(data() + byte_size());
+            const auto* const padded_end = reinterpret_cast<const char*>(data() + padded_size());
+
+            while (ptr != end) {
+                if (ptr + sizeof(uint64_t) <= padded_end) {
+                    uint64_t word; // NOLINT(cppcoreguidelines-init-variables)
+                    std::memcpy(&word, ptr, sizeof(uint64_t));
+                    if ((word & mask) == prefix &&
+                        (key_size <= sizeof(uint64_t) ||
+                         !std::strcmp(ptr + sizeof(uint64_t), key + sizeof(uint64_t)))) {
+                        return ptr;
+                    }
+                } else if (!std::strcmp(ptr, key)) {
+                    return ptr;
+                }
+                ptr = skip_string(skip_string(ptr));
+            }
+
+            return nullptr;
         }
 
     public:
@@ -136,8 +179,62 @@ namespace osmium {
          */
         const char* get_value_by_key(const char* key, const char* default_value = nullptr) const noexcept {
             assert(key);
-            const auto result = find_key(key);
-            return result == cend() ? default_value : result->value();
+            const auto* result = find_key_data(key);
+            return result ? skip_string(result) : default_value;
+        }
+
+        /**
+         * Get tag values for several tag keys in a single pass over the
+         * tag list. This is faster than calling get_value_by_key() several
+         * times. For each key in keys the value is written to the same
+         * position in values, or nullptr if the key is not set.
+         *
+         * @param keys Pointer to array of keys.
+         * @param values Pointer to array of values. Must be at least as
+         *               large as the keys array.
+         * @param count Number of keys.
+         * @returns The number of keys found.
+         *
+         * @pre @code keys != nullptr && values != nullptr @endcode and all
+         *      keys are not nullptr.
+         */
+        std::size_t get_values_by_keys(const char* const* keys, const char** values, std::size_t count) const noexcept {
+            assert(keys);
+            assert(values);
+            std::fill_n(values, count, nullptr);
+
+            std::size_t found = 0;
+            const auto* ptr = reinterpret_cast<const char*>(data() + sizeof(TagList));
+            const auto* const end = reinterpret_cast<const char*>(data() + byte_size());
+            while (ptr != end && found != count) {
+                const auto* value = skip_string(ptr);
+                for (std::size_t n = 0; n < count; ++n) {
+                    assert(keys[n]);
+                    if (!values[n] && *ptr == *keys[n] && !std::strcmp(ptr, keys[n])) {
+                        values[n] = value;
+                        ++found;
+                    }
+                }
+                ptr = skip_string(value);
+            }
+
+            return found;
+        }
+
+        /**
+         * Get tag values for several tag keys in a single pass over the
+         * tag list. See the other overload for details.
+         *
+         * Usage:
+         * @code
+         * const char* keys[] = {"highway", "name", "ref"};
+         * const char* values[3];
+         * tags.get_values_by_keys(keys, values);
+         * @endcode
+         */
+        template <std::size_t N>
+        std::size_t get_values_by_keys(const char* const (&keys)[N], const char* (&values)[N]) const noexcept {
+            return get_values_by_keys(keys, values, N);
         }
 
         /**
@@ -157,7 +254,7 @@ namespace osmium {
          */
         bool has_key(const char* key) const noexcept {
             assert(key);
-            return find_key(key) != cend();
+            return find_key_data(key) != nullptr;
         }
 
         /**
@@ -169,8 +266,8 @@ namespace osmium {
         bool has_tag(const char* key, const char* value) const noexcept {
             assert(key);
             assert(value);
-            const auto result = find_key(key);
-            return result != cend() && !std::strcmp(result->value(), value);
+            const auto* result = find_key_data(key);
+            return result && !std::strcmp(skip_string(result), value);
         }
 
     }; // class TagList
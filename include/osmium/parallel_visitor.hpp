@@ -0,0 +1,241 @@
+#ifndef OSMIUM_PARALLEL_VISITOR_HPP
+#define OSMIUM_PARALLEL_VISITOR_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/visitor.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace detail {
+
+        // Type of the handler created by a handler factory. If the factory
+        // returns a functor, it will be wrapped.
+        template <typename THandlerFactory>
+        using factory_handler_type = decltype(make_handler(std::declval<THandlerFactory&>()()));
+
+        template <typename THandler>
+        inline void apply_buffer(osmium::memory::Buffer& buffer, THandler& handler) {
+            for (auto it = buffer.begin(); it != buffer.end(); ++it) {
+                apply_item(*it, handler);
+            }
+        }
+
+        /**
+         * Read all buffers from the source and apply them to handlers
+         * created with the factory, one handler per pool thread. Each
+         * handler is only ever used by one task at a time. If ordered is
+         * true, the buffers are handed to the output function after the
+         * handler has seen them in the order they were read.
+         */
+        template <typename TSource, typename THandlerFactory, typename TOutput>
+        std::vector<factory_handler_type<THandlerFactory>> parallel_apply_impl(TSource& source, THandlerFactory&& factory, TOutput&& output, bool ordered, osmium::thread::Pool& pool) {
+            using handler_type = factory_handler_type<THandlerFactory>;
+
+            struct task {
+                std::future<osmium::memory::Buffer> result;
+                std::size_t slot;
+            };
+
+            const auto num_workers = static_cast<std::size_t>(pool.num_threads());
+
+            std::vector<handler_type> handlers;
+            handlers.reserve(num_workers);
+            std::vector<std::size_t> free_slots;
+            free_slots.reserve(num_workers);
+            for (std::size_t i = 0; i < num_workers; ++i) {
+                handlers.push_back(make_handler(factory()));
+                free_slots.push_back(num_workers - i - 1);
+            }
+
+            std::deque<task> pending;
+
+            const auto finish_task = [&](typename std::deque<task>::iterator it) {
+                auto result = std::move(it->result);
+                free_slots.push_back(it->slot);
+                pending.erase(it);
+                auto buffer = result.get();
+                if (ordered) {
+                    output(std::move(buffer));
+                }
+            };
+
+            try {
+                while (osmium::memory::Buffer buffer = source.read()) {
+                    if (free_slots.empty()) {
+                        auto it = pending.begin();
+                        if (!ordered) {
+                            // Use any task that is done, if there is none
+                            // wait for the oldest.
+                            for (auto p = pending.begin(); p != pending.end(); ++p) {
+                                if (p->result.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                                    it = p;
+                                    break;
+                                }
+                            }
+                        }
+                        finish_task(it);
+                    }
+
+                    const std::size_t slot = free_slots.back();
+                    free_slots.pop_back();
+                    handler_type* handler = &handlers[slot];
+                    pending.push_back(task{pool.submit([handler, b = std::move(buffer)]() mutable {
+                        apply_buffer(b, *handler);
+                        return std::move(b);
+                    }), slot});
+                }
+
+                while (!pending.empty()) {
+                    finish_task(pending.begin());
+                }
+            } catch (...) {
+                // The tasks still running use the handlers, wait for them
+                // before the handlers go away.
+                for (auto& t : pending) {
+                    t.result.wait();
+                }
+                throw;
+            }
+
+            for (auto& handler : handlers) {
+                handler.flush();
+            }
+
+            return handlers;
+        }
+
+    } // namespace detail
+
+    /**
+     * Apply handlers to all objects from the source in parallel using
+     * the thread pool.
+     *
+     * The handler factory is called once for each thread in the pool and
+     * must return a handler (derived from osmium::handler::Handler) or a
+     * functor like the ones used with osmium::apply(). The buffers read
+     * from the source are distributed over the pool, each buffer is given
+     * to one handler, and each handler only works on one buffer at a time.
+     * So handlers need no locking for their own state, but they see the
+     * objects in an unspecified subset and order of the buffers. The
+     * flush() function is called on all handlers at the end.
+     *
+     * This is useful for stateless or per-object work and for statistics
+     * that can be merged later. See parallel_apply_reduce() for the merge
+     * step and parallel_apply_ordered() if the buffers must be processed
+     * further in their original order.
+     *
+     * @param source Anything with a read() function returning buffers, an
+     *               invalid buffer marks the end of data. Usually an
+     *               osmium::io::Reader.
+     * @param factory Callable creating the handlers.
+     * @param pool Thread pool to run the handlers in.
+     * @returns The handlers in the order they were created.
+     * @throws Any exception thrown by the source or any of the handlers.
+     *         The source is not read any further in that case.
+     */
+    template <typename TSource, typename THandlerFactory>
+    std::vector<detail::factory_handler_type<THandlerFactory>> parallel_apply(TSource& source, THandlerFactory&& factory, osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+        return detail::parallel_apply_impl(source, std::forward<THandlerFactory>(factory), [](osmium::memory::Buffer&& /*buffer*/) {}, false, pool);
+    }
+
+    /**
+     * Apply handlers to all objects from the source in parallel like
+     * parallel_apply() and merge the handlers into one.
+     *
+     * The reduce function is called as reduce(result, std::move(other))
+     * on the calling thread and must merge the state of handler "other"
+     * into the handler "result". The first handler is the result, all
+     * others are merged into it in order.
+     *
+     * Usage:
+     * @code
+     * osmium::io::Reader reader{"planet.osm.pbf"};
+     * const auto counter = osmium::parallel_apply_reduce(reader,
+     *     []() { return TagCounter{}; },
+     *     [](TagCounter& result, TagCounter&& other) { result.merge(other); });
+     * @endcode
+     *
+     * @param source Anything with a read() function returning buffers.
+     * @param factory Callable creating the handlers.
+     * @param reduce Callable merging a handler into another one.
+     * @param pool Thread pool to run the handlers in.
+     * @returns The merged handler.
+     * @throws Any exception thrown by the source or any of the handlers.
+     */
+    template <typename TSource, typename THandlerFactory, typename TReduce>
+    detail::factory_handler_type<THandlerFactory> parallel_apply_reduce(TSource& source, THandlerFactory&& factory, TReduce&& reduce, osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+        auto handlers = parallel_apply(source, std::forward<THandlerFactory>(factory), pool);
+        for (std::size_t i = 1; i < handlers.size(); ++i) {
+            reduce(handlers.front(), std::move(handlers[i]));
+        }
+        return std::move(handlers.front());
+    }
+
+    /**
+     * Apply handlers to all objects from the source in parallel like
+     * parallel_apply() and then give the buffers to the output function
+     * in the order they were read from the source.
+     *
+     * The output function is called as output(std::move(buffer)) on the
+     * calling thread after a handler has seen all objects in the buffer.
+     * Handlers get non-const objects, so they can change them. Use this
+     * to, for instance, write the objects with an osmium::io::Writer.
+     * Because of the ordering, a slow buffer can hold up other workers.
+     *
+     * @param source Anything with a read() function returning buffers.
+     * @param factory Callable creating the handlers.
+     * @param output Callable taking the buffers.
+     * @param pool Thread pool to run the handlers in.
+     * @returns The handlers in the order they were created.
+     * @throws Any exception thrown by the source, the output function, or
+     *         any of the handlers.
+     */
+    template <typename TSource, typename THandlerFactory, typename TOutput>
+    std::vector<detail::factory_handler_type<THandlerFactory>> parallel_apply_ordered(TSource& source, THandlerFactory&& factory, TOutput&& output, osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) {
+        return detail::parallel_apply_impl(source, std::forward<THandlerFactory>(factory), std::forward<TOutput>(output), true, pool);
+    }
+
+} // namespace osmium
+
+#endif // OSMIUM_PARALLEL_VISITOR_HPP
@@ -38,14 +38,19 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/types.hpp>
 #include <osmium/relations/relations_database.hpp>
 #include <osmium/storage/item_stash.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/sort.hpp>
 #include <osmium/util/iterator.hpp>
 
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <limits>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace osmium {
@@ -137,6 +142,64 @@ namespace osmium {
 
             std::vector<element> m_elements{};
 
+            // Number of bytes used in the stash by the objects stored
+            // through this database.
+            std::size_t m_stashed_bytes = 0;
+
+            // Position up to which elements have been checked for missing
+            // objects by for_each_missing_before().
+            std::size_t m_missing_pos = 0;
+
+            // Bitmap with one bit set for the hash of each member id. Most
+            // objects looked up are not members of any relation, this
+            // filter finds most of those without a binary search.
+            std::vector<uint64_t> m_filter{};
+            unsigned int m_filter_shift = 64;
+
+            static uint64_t filter_hash(osmium::object_id_type id) noexcept {
+                return static_cast<uint64_t>(id) * 0x9e3779b97f4a7c15ULL;
+            }
+
+            bool maybe_member(osmium::object_id_type id) const noexcept {
+                if (m_filter.empty()) {
+                    return true;
+                }
+                const auto bit = filter_hash(id) >> m_filter_shift;
+                return (m_filter[bit >> 6U] & (1ULL << (bit & 0x3fU))) != 0;
+            }
+
+            // Create filter with at least 8 bits per element.
+            void build_filter() {
+                unsigned int bits = 6;
+                while (bits < 63 && (1ULL << bits) < m_elements.size() * 8) {
+                    ++bits;
+                }
+                m_filter.assign(1ULL << (bits - 6), 0);
+                m_filter_shift = 64 - bits;
+                for (const auto& elem : m_elements) {
+                    const auto bit = filter_hash(elem.member_id) >> m_filter_shift;
+                    m_filter[bit >> 6U] |= 1ULL << (bit & 0x3fU);
+                }
+            }
+
+            template <typename TFunc>
+            void for_each_missing_until(std::size_t end, TFunc&& func) {
+                for (; m_missing_pos < end; ++m_missing_pos) {
+                    const auto& elem = m_elements[m_missing_pos];
+                    if (!elem.is_removed() && !elem.object_handle.valid()) {
+                        auto rel_handle = m_relations_db[elem.relation_pos];
+                        std::forward<TFunc>(func)(rel_handle);
+                    }
+                }
+            }
+
+            void finish_prepare_for_lookup() {
+                build_filter();
+#ifndef NDEBUG
+                m_init_phase = false;
+#endif
+            }
+
         protected:
 
             osmium::ItemStash& m_stash;
@@ -152,10 +215,16 @@ namespace osmium {
             using const_iterator = std::vector<element>::const_iterator;
 
             iterator_range<iterator> find(osmium::object_id_type id) {
+                if (!maybe_member(id)) {
+                    return make_range(std::make_pair(m_elements.end(), m_elements.end()));
+                }
                 return make_range(std::equal_range(m_elements.begin(), m_elements.end(), element{id}, compare_member_id{}));
             }
 
             iterator_range<const_iterator> find(osmium::object_id_type id) const {
+                if (!maybe_member(id)) {
+                    return make_range(std::make_pair(m_elements.cend(), m_elements.cend()));
+                }
                 return make_range(std::equal_range(m_elements.cbegin(), m_elements.cend(), element{id}, compare_member_id{}));
             }
 
@@ -167,6 +236,7 @@ namespace osmium {
 
             void add_object(const osmium::OSMObject& object, iterator_range<iterator>& range) {
                 const auto handle = m_stash.add_item(object);
+                m_stashed_bytes += object.padded_size();
                 for (auto& elem : range) {
                     elem.object_handle = handle;
                 }
@@ -186,9 +256,20 @@ namespace osmium {
              */
             std::size_t used_memory() const noexcept {
                 return sizeof(element) * m_elements.capacity() +
+                       sizeof(uint64_t) * m_filter.capacity() +
                        sizeof(MembersDatabaseCommon);
             }
 
+            /**
+             * The number of bytes used in the stash by the member objects
+             * currently stored through this database.
+             *
+             * Complexity: Constant.
+             */
+            std::size_t stashed_bytes() const noexcept {
+                return m_stashed_bytes;
+            }
+
             /**
              * The number of members tracked in the database. Includes
              * members tracked, but not found yet, members found and members
@@ -259,9 +340,17 @@ namespace osmium {
             void prepare_for_lookup() {
                 assert(m_init_phase && "Can not call MembersDatabase::prepare_for_lookup() twice.");
                 std::sort(m_elements.begin(), m_elements.end());
-#ifndef NDEBUG
-                m_init_phase = false;
-#endif
+                finish_prepare_for_lookup();
+            }
+
+            /**
+             * Prepare the database for lookup like prepare_for_lookup()
+             * above, but sort the data using the threads in the pool.
+             */
+            void prepare_for_lookup(osmium::thread::Pool& pool) {
+                assert(m_init_phase && "Can not call MembersDatabase::prepare_for_lookup() twice.");
+                osmium::thread::parallel_sort(pool, m_elements.begin(), m_elements.end());
+                finish_prepare_for_lookup();
             }
 
             /**
@@ -276,9 +365,12 @@ namespace osmium {
                 }
 
                 // If this is the last time this object was needed, remove it
-                // from the stash.
-                if (count_not_removed(range) == 1) {
-                    m_stash.remove_item(range.begin()->object_handle);
+                // from the stash. The object might not have been found yet
+                // if the relation is removed before it is complete.
+                const auto handle = range.begin()->object_handle;
+                if (count_not_removed(range) == 1 && handle.valid()) {
+                    m_stashed_bytes -= m_stash.get_item(handle).padded_size();
+                    m_stash.remove_item(handle);
                 }
 
                 for (auto& elem : range) {
@@ -289,6 +381,45 @@ namespace osmium {
                 }
             }
 
+            /**
+             * Call a function for the relation of each tracked member with
+             * an id smaller than the specified id that has not been found
+             * yet. If the input is sorted by id, those members are missing
+             * from the input and the relations can never be completed. The
+             * function may remove the relation. Each member is only
+             * reported once, so the id must never decrease between calls.
+             *
+             * Negative ids are sorted by absolute value in OSM files and
+             * before all positive ids, so only positive ids will report
+             * anything. All negative ids are reported when the first
+             * positive id is seen.
+             *
+             * @tparam TFunc Function with type void(RelationHandle&).
+             */
+            template <typename TFunc>
+            void for_each_missing_before(osmium::object_id_type id, TFunc&& func) {
+                assert(!m_init_phase && "Call MembersDatabase::prepare_for_lookup() before calling for_each_missing_before().");
+                if (id <= 0) {
+                    return;
+                }
+                const auto end = std::lower_bound(m_elements.begin() + static_cast<std::ptrdiff_t>(m_missing_pos), m_elements.end(), element{id}, compare_member_id{});
+                for_each_missing_until(static_cast<std::size_t>(std::distance(m_elements.begin(), end)), std::forward<TFunc>(func));
+            }
+
+            /**
+             * Call a function for the relation of each tracked member that
+             * has not been found yet and has not been reported by
+             * for_each_missing_before() before. Use this after the last
+             * object of this type has been seen in the input.
+             *
+             * @tparam TFunc Function with type void(RelationHandle&).
+             */
+            template <typename TFunc>
+            void for_each_missing(TFunc&& func) {
+                assert(!m_init_phase && "Call MembersDatabase::prepare_for_lookup() before calling for_each_missing().");
+                for_each_missing_until(m_elements.size(), std::forward<TFunc>(func));
+            }
+
             /**
              * Find the object with the specified id in the database and
              * return a pointer to it. Returns nullptr if there is no object
@@ -360,8 +491,8 @@ namespace osmium {
                 assert(!m_init_phase && "Call MembersDatabase::prepare_for_lookup() before calling add().");
                 auto range = find(object.id());
 
-                if (range.empty()) {
-                    // No relation needs this object.
+                if (range.empty() || count_not_removed(range) == 0) {
+                    // No relation needs this object (anymore).
                     return false;
                 }
 
@@ -370,7 +501,11 @@ namespace osmium {
                 add_object(object, range);
 
                 for (auto& elem : range) {
-                    assert(!elem.is_removed());
+                    if (elem.is_removed()) {
+                        // The relation was removed before this member
+                        // was found.
+                        continue;
+                    }
                     assert(elem.member_id == object.id());
 
                     auto rel_handle = m_relations_db[elem.relation_pos];
@@ -275,6 +275,14 @@ namespace osmium {
                 m_relation_database->remove(pos());
             }
 
+            /**
+             * Has the relation referred to by this handle been removed from
+             * the database?
+             */
+            bool removed() const noexcept {
+                return !m_relation_database->m_elements[m_pos].handle.valid();
+            }
+
             /**
              * Set the number of relation members that we want to track.
              */
@@ -47,6 +47,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/storage/item_stash.hpp>
 #include <osmium/tags/taglist.hpp>
 #include <osmium/tags/tags_filter.hpp>
+#include <osmium/thread/pool.hpp>
 
 #include <algorithm>
 #include <cassert>
@@ -97,6 +98,14 @@ namespace osmium {
                 m_member_relations_db(m_stash, m_relations_db) {
             }
 
+            /**
+             * Access the internal ItemStash. Use this for instance to set
+             * a memory limit on it.
+             */
+            osmium::ItemStash& stash() noexcept {
+                return m_stash;
+            }
+
             /// Access the internal RelationsDatabase.
             osmium::relations::RelationsDatabase& relations_database() noexcept {
                 return m_relations_db;
@@ -242,6 +251,16 @@ namespace osmium {
                 m_member_relations_db.prepare_for_lookup();
             }
 
+            /**
+             * Sort the members databases to prepare them for reading using
+             * the threads in the pool for sorting.
+             */
+            void prepare_for_lookup(osmium::thread::Pool& pool) {
+                m_member_nodes_db.prepare_for_lookup(pool);
+                m_member_ways_db.prepare_for_lookup(pool);
+                m_member_relations_db.prepare_for_lookup(pool);
+            }
+
             /**
              * Return the memory used by different components of the manager.
              */
@@ -310,6 +329,18 @@ namespace osmium {
 
             SecondPassHandler<RelationsManager> m_handler_pass2;
 
+            // IDs of relations removed because the member memory budget
+            // was exceeded.
+            std::vector<osmium::object_id_type> m_deferred_relations{};
+
+            std::size_t m_member_memory_budget = 0;
+
+            // Position in the relations database where the search for
+            // relations to defer continues.
+            std::size_t m_defer_pos = 0;
+
+            bool m_streaming = false;
+
             static bool wanted_type(osmium::item_type type) noexcept {
                 return (TNodes     && type == osmium::item_type::node) ||
                        (TWays      && type == osmium::item_type::way) ||
@@ -352,6 +383,19 @@ namespace osmium {
             void complete_relation(const osmium::Relation& /*relation*/) const noexcept {
             }
 
+            /**
+             * This method is called in streaming mode for each relation
+             * that can not be completed, because some of its members are
+             * missing in the input. The members found so far can be
+             * accessed with get_member_object() and friends. After this
+             * call the relation and its members are removed.
+             *
+             * Overwrite this method in a derived class if you are interested
+             * in this.
+             */
+            void incomplete_relation(const osmium::Relation& /*relation*/) const noexcept {
+            }
+
             /**
              * This method is called for all nodes during the second pass
              * before the relation member handling.
@@ -442,14 +486,22 @@ namespace osmium {
             void after_relation(const osmium::Relation& /*relation*/) const noexcept {
             }
 
+            /**
+             * This method is called before the output buffer is flushed
+             * or read.
+             *
+             * Overwrite this method in a derived class if it does some work
+             * asynchronously and has to add the results to the output
+             * buffer first.
+             */
+            void flush_pending() const noexcept {
+            }
+
             TManager& derived() noexcept {
                 return *static_cast<TManager*>(this);
             }
 
-            void handle_complete_relation(RelationHandle& rel_handle) {
-                derived().complete_relation(*rel_handle);
-                possibly_flush();
-
+            void remove_relation(RelationHandle& rel_handle) {
                 for (const auto& member : rel_handle->members()) {
                     if (member.ref() != 0) {
                         member_database(member.type()).remove(member.ref(), rel_handle->id());
@@ -459,6 +511,71 @@ namespace osmium {
                 rel_handle.remove();
             }
 
+            void handle_complete_relation(RelationHandle& rel_handle) {
+                derived().complete_relation(*rel_handle);
+                possibly_flush();
+                remove_relation(rel_handle);
+            }
+
+            void handle_incomplete_relation(RelationHandle& rel_handle) {
+                derived().incomplete_relation(*rel_handle);
+                possibly_flush();
+                remove_relation(rel_handle);
+            }
+
+            template <typename TObject>
+            void release_missing_before(MembersDatabase<TObject>& db, osmium::object_id_type id) {
+                if (m_streaming) {
+                    db.for_each_missing_before(id, [this](RelationHandle& rel_handle) {
+                        handle_incomplete_relation(rel_handle);
+                    });
+                }
+            }
+
+            template <typename TObject>
+            void release_missing(MembersDatabase<TObject>& db) {
+                if (m_streaming) {
+                    db.for_each_missing([this](RelationHandle& rel_handle) {
+                        handle_incomplete_relation(rel_handle);
+                    });
+                }
+            }
+
+            std::size_t stashed_member_bytes() const noexcept {
+                return member_nodes_database().stashed_bytes() +
+                       member_ways_database().stashed_bytes() +
+                       member_relations_database().stashed_bytes();
+            }
+
+            bool has_stashed_members(const RelationHandle& rel_handle) const {
+                return std::any_of(rel_handle->members().cbegin(), rel_handle->members().cend(), [this](const osmium::RelationMember& member) {
+                    return get_member_object(member) != nullptr;
+                });
+            }
+
+            // Remove relations holding on to member objects until the
+            // memory used by member objects is well below the budget again.
+            // The relations are visited round-robin, so each one gets a
+            // chance to complete before it is removed.
+            void enforce_member_memory_budget() {
+                if (m_member_memory_budget == 0 || stashed_member_bytes() <= m_member_memory_budget) {
+                    return;
+                }
+
+                const auto target = m_member_memory_budget / 4 * 3;
+                auto& db = relations_database();
+                for (std::size_t n = 0; n < db.size() && stashed_member_bytes() > target; ++n) {
+                    if (m_defer_pos >= db.size()) {
+                        m_defer_pos = 0;
+                    }
+                    auto rel_handle = db[m_defer_pos++];
+                    if (!rel_handle.removed() && has_stashed_members(rel_handle)) {
+                        m_deferred_relations.push_back(rel_handle->id());
+                        remove_relation(rel_handle);
+                    }
+                }
+            }
+
         public:
 
             RelationsManager() :
@@ -475,6 +592,59 @@ namespace osmium {
                 return m_handler_pass2;
             }
 
+            /**
+             * Enable or disable streaming mode. In streaming mode the input
+             * for the second pass must be sorted by type and then by id (as
+             * OSM files usually are). Once the input has moved past the id
+             * of a member that wasn't found, that member is known to be
+             * missing and the relation is handed to incomplete_relation()
+             * and removed right away together with the members already
+             * found, instead of keeping them in memory until the end. The
+             * remaining incomplete relations (those missing members of the
+             * last object type in the input) are still available through
+             * for_each_incomplete_relation() after the second pass.
+             */
+            void set_streaming(bool streaming = true) noexcept {
+                m_streaming = streaming;
+            }
+
+            /// Is streaming mode enabled?
+            bool streaming() const noexcept {
+                return m_streaming;
+            }
+
+            /**
+             * Set a budget for the memory (in bytes) used by member objects
+             * while waiting for their relations to complete. If the budget
+             * is exceeded, relations that already have some of their members
+             * are removed until the member objects use less than three
+             * quarters of the budget. Neither complete_relation() nor
+             * incomplete_relation() is called for those relations, their
+             * ids are available from deferred_relations() instead. Handle
+             * them in a third pass through the input with a new manager that
+             * only accepts those relations in its new_relation() function.
+             *
+             * Set to 0 (the default) for no limit.
+             */
+            void set_member_memory_budget(std::size_t bytes) noexcept {
+                m_member_memory_budget = bytes;
+            }
+
+            /// The budget set with set_member_memory_budget().
+            std::size_t member_memory_budget() const noexcept {
+                return m_member_memory_budget;
+            }
+
+            /**
+             * The ids of all relations removed because the member memory
+             * budget was exceeded. They are in the order the relations were
+             * removed, call std::sort() on them before using them for
+             * lookups.
+             */
+            const std::vector<osmium::object_id_type>& deferred_relations() const noexcept {
+                return m_deferred_relations;
+            }
+
             /**
              * Add the specified relation to the list of relations we want to
              * build. This calls the new_relation() and new_member()
@@ -505,6 +675,7 @@ namespace osmium {
             void handle_node(const osmium::Node& node) {
                 if (TNodes) {
                     m_check_order_handler.node(node);
+                    release_missing_before(member_nodes_database(), node.id());
                     derived().before_node(node);
                     const bool added = member_nodes_database().add(node, [this](RelationHandle& rel_handle) {
                         handle_complete_relation(rel_handle);
@@ -513,13 +684,16 @@ namespace osmium {
                         derived().node_not_in_any_relation(node);
                     }
                     derived().after_node(node);
+                    enforce_member_memory_budget();
                     possibly_flush();
                 }
             }
 
             void handle_way(const osmium::Way& way) {
+                release_missing(member_nodes_database());
                 if (TWays) {
                     m_check_order_handler.way(way);
+                    release_missing_before(member_ways_database(), way.id());
                     derived().before_way(way);
                     const bool added = member_ways_database().add(way, [this](RelationHandle& rel_handle) {
                         handle_complete_relation(rel_handle);
@@ -528,13 +702,17 @@ namespace osmium {
                         derived().way_not_in_any_relation(way);
                     }
                     derived().after_way(way);
+                    enforce_member_memory_budget();
                     possibly_flush();
                 }
             }
 
             void handle_relation(const osmium::Relation& relation) {
+                release_missing(member_nodes_database());
+                release_missing(member_ways_database());
                 if (TRelations) {
                     m_check_order_handler.relation(relation);
+                    release_missing_before(member_relations_database(), relation.id());
                     derived().before_relation(relation);
                     const bool added = member_relations_database().add(relation, [this](RelationHandle& rel_handle) {
                         handle_complete_relation(rel_handle);
@@ -543,10 +721,31 @@ namespace osmium {
                         derived().relation_not_in_any_relation(relation);
                     }
                     derived().after_relation(relation);
+                    enforce_member_memory_budget();
                     possibly_flush();
                 }
             }
 
+            /**
+             * Flush the output buffer. This calls the flush_pending()
+             * function of the derived class first, so that it can add any
+             * output it still has in the works.
+             */
+            void flush_output() {
+                derived().flush_pending();
+                RelationsManagerBase::flush_output();
+            }
+
+            /**
+             * Return the contents of the output buffer. This calls the
+             * flush_pending() function of the derived class first, so that
+             * it can add any output it still has in the works.
+             */
+            osmium::memory::Buffer read() {
+                derived().flush_pending();
+                return RelationsManagerBase::read();
+            }
+
             /**
              * Call this function it will call your function back for every
              * incomplete relation, that is all relations that have missing
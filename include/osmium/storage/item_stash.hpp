@@ -35,11 +35,20 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/memory/buffer.hpp>
 #include <osmium/memory/item.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <limits>
 #include <ostream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
 #include <vector>
 
 #ifdef OSMIUM_ITEM_STORAGE_GC_DEBUG
@@ -49,10 +58,141 @@ DEALINGS IN THE SOFTWARE.
 
 namespace osmium {
 
+    namespace detail {
+
+        /**
+         * Temporary file used by the ItemStash for segments that don't fit
+         * into its memory limit. The file is divided into regions of the
+         * same size. The regions are memory mapped in chunks to keep the
+         * number of mappings small.
+         */
+        class item_stash_spill_file {
+
+            enum : std::size_t {
+                regions_per_chunk = 64
+            };
+
+            std::vector<osmium::util::MemoryMapping> m_chunks;
+            std::vector<std::size_t> m_free_regions;
+            std::size_t m_region_size = 0;
+            std::size_t m_count_regions = 0;
+            std::FILE* m_file = nullptr;
+
+        public:
+
+            item_stash_spill_file() noexcept = default;
+
+            item_stash_spill_file(const item_stash_spill_file&) = delete;
+            item_stash_spill_file& operator=(const item_stash_spill_file&) = delete;
+
+            item_stash_spill_file(item_stash_spill_file&& other) noexcept :
+                m_chunks(std::move(other.m_chunks)),
+                m_free_regions(std::move(other.m_free_regions)),
+                m_region_size(other.m_region_size),
+                m_count_regions(other.m_count_regions),
+                m_file(other.m_file) {
+                other.m_file = nullptr;
+            }
+
+            item_stash_spill_file& operator=(item_stash_spill_file&& other) noexcept {
+                using std::swap;
+                swap(m_chunks, other.m_chunks);
+                swap(m_free_regions, other.m_free_regions);
+                swap(m_region_size, other.m_region_size);
+                swap(m_count_regions, other.m_count_regions);
+                swap(m_file, other.m_file);
+                return *this;
+            }
+
+            ~item_stash_spill_file() noexcept {
+                m_chunks.clear();
+                if (m_file) {
+                    std::fclose(m_file);
+                }
+            }
+
+            /// The number of regions currently in use.
+            std::size_t count_regions() const noexcept {
+                return m_count_regions - m_free_regions.size();
+            }
+
+            /**
+             * Allocate a region with at least the specified size. All
+             * regions have the same size, it is set on the first call.
+             *
+             * @returns The number of the new region.
+             * @throws std::system_error If the file can not be created or
+             *         resized.
+             */
+            std::size_t allocate(std::size_t size) {
+                if (m_region_size == 0) {
+                    const auto pagesize = osmium::get_pagesize();
+                    m_region_size = (size + pagesize - 1) / pagesize * pagesize;
+                }
+                assert(size <= m_region_size);
+
+                if (!m_free_regions.empty()) {
+                    const auto region = m_free_regions.back();
+                    m_free_regions.pop_back();
+                    return region;
+                }
+
+                if (m_count_regions / regions_per_chunk >= m_chunks.size()) {
+                    if (!m_file) {
+                        m_file = std::tmpfile();
+                        if (!m_file) {
+                            throw std::system_error{errno, std::system_category(), "tempfile failed"};
+                        }
+                    }
+                    const std::size_t chunk_size = m_region_size * regions_per_chunk;
+                    m_chunks.emplace_back(chunk_size,
+                                          osmium::util::MemoryMapping::mapping_mode::write_shared,
+                                          fileno(m_file),
+                                          static_cast<off_t>(chunk_size * m_chunks.size()));
+                }
+
+                return m_count_regions++;
+            }
+
+            /// Get a pointer to the memory of a region.
+            unsigned char* data(std::size_t region) const noexcept {
+                assert(region < m_count_regions);
+                return m_chunks[region / regions_per_chunk].get_addr<unsigned char>() +
+                       (region % regions_per_chunk) * m_region_size;
+            }
+
+            /// Mark a region as unused so that it can be allocated again.
+            void free(std::size_t region) {
+                m_free_regions.push_back(region);
+            }
+
+            /// Mark all regions as unused. The file is kept.
+            void clear() noexcept {
+                m_free_regions.clear();
+                m_count_regions = 0;
+            }
+
+        }; // class item_stash_spill_file
+
+    } // namespace detail
+
     /**
      * Class for storing OSM data in memory. Any osmium::memory::Item can be
-     * added to the stash and it will be copied into its internal Buffer. To
+     * added to the stash and it will be copied into its internal storage. To
      * access the item again, an opaque handle is used.
+     *
+     * Internally the items are stored in a list of fixed-size segments. The
+     * stash keeps track of the live and removed items in each segment.
+     * Segments without any live items are reused immediately. Segments with
+     * many removed items are compacted one at a time when new space is
+     * needed, so there are no long garbage collection pauses even for very
+     * large stashes. Handles stay valid when items are moved, because they
+     * refer to items through an index.
+     *
+     * A memory limit can be set with set_memory_limit(). If the segments
+     * need more memory than that, the segments that were written to the
+     * longest time ago are moved to a temporary file and accessed through
+     * a memory mapping from then on.
      */
     class ItemStash {
 
@@ -113,18 +253,73 @@ namespace osmium {
 
         }; // class handle_type
 
+        enum : std::size_t {
+            default_segment_size = 1024UL * 1024UL
+        };
+
     private:
 
-        enum {
-            initial_buffer_size = 1024UL * 1024UL
+        // Number of buffers from empty segments kept around for reuse.
+        enum : std::size_t {
+            max_spare_buffers = 4
+        };
+
+        // If there are more removed items than this, add_item() will do
+        // a full garbage collection. This only happens if lots of items
+        // are removed without adding new ones in between, otherwise the
+        // incremental compaction of single segments keeps up.
+        enum : std::size_t {
+            max_count_removed = 5UL * 1000UL * 1000UL
         };
 
-        enum {
-            removed_item_offset = std::numeric_limits<std::size_t>::max()
+        enum : uint32_t {
+            removed_item_segment = std::numeric_limits<uint32_t>::max()
         };
 
-        osmium::memory::Buffer m_buffer;
-        std::vector<std::size_t> m_index;
+        enum : std::size_t {
+            not_spilled = std::numeric_limits<std::size_t>::max()
+        };
+
+        // Position of an item in the stash.
+        struct location {
+            uint32_t segment;
+            uint32_t offset;
+        };
+
+        struct segment {
+
+            // Buffer with the items. Invalid if the segment is unused.
+            osmium::memory::Buffer buffer{};
+
+            // Handle values of all items in this segment in the order they
+            // are in the buffer. This can contain handles of removed items.
+            std::vector<std::size_t> handles{};
+
+            std::size_t count_items = 0;
+            std::size_t count_removed = 0;
+            std::size_t removed_bytes = 0;
+
+            // Time (counted in items added to the stash) an item was last
+            // added to this segment.
+            std::size_t last_write = 0;
+
+            // The region in the spill file if the segment was spilled.
+            std::size_t region = not_spilled;
+
+            // Is this segment in the list of segments to be compacted?
+            bool gc_candidate = false;
+
+        }; // struct segment
+
+        std::vector<segment> m_segments;
+        std::vector<uint32_t> m_free_segments;
+        std::vector<uint32_t> m_gc_candidates;
+        std::vector<osmium::memory::Buffer> m_spare_buffers;
+        std::vector<location> m_index;
+        detail::item_stash_spill_file m_spill_file;
+        std::size_t m_segment_size;
+        std::size_t m_memory_limit = 0;
+        uint32_t m_current = 0;
         std::size_t m_count_items = 0;
         std::size_t m_count_removed = 0;
 #ifdef OSMIUM_ITEM_STORAGE_GC_DEBUG
@@ -133,82 +328,234 @@ namespace osmium {
 
         class cleanup_helper {
 
-            std::vector<std::size_t>& m_index;
+            std::vector<location>& m_index;
+            const std::vector<std::size_t>& m_handles;
             std::size_t m_pos = 0;
 
         public:
 
-            explicit cleanup_helper(std::vector<std::size_t>& index) :
-                m_index(index) {
+            cleanup_helper(std::vector<location>& index, const std::vector<std::size_t>& handles) :
+                m_index(index),
+                m_handles(handles) {
             }
 
             void moving_in_buffer(std::size_t old_offset, std::size_t new_offset) {
-                while (m_index[m_pos] != old_offset) {
+                while (m_index[m_handles[m_pos] - 1].offset != old_offset) {
                     ++m_pos;
-                    assert(m_pos < m_index.size());
+                    assert(m_pos < m_handles.size());
                 }
-                m_index[m_pos] = new_offset;
+                m_index[m_handles[m_pos] - 1].offset = static_cast<uint32_t>(new_offset);
                 ++m_pos;
             }
 
         }; // cleanup_helper
 
-        std::size_t& get_item_offset_ref(handle_type handle) noexcept {
+        location& get_location_ref(handle_type handle) noexcept {
             assert(handle.valid() && "handle must be valid");
             assert(handle.value <= m_index.size());
-            auto& offset = m_index[handle.value - 1];
-            assert(offset != removed_item_offset);
-            assert(offset < m_buffer.committed());
-            return offset;
+            auto& loc = m_index[handle.value - 1];
+            assert(loc.segment != removed_item_segment);
+            assert(loc.offset < m_segments[loc.segment].buffer.committed());
+            return loc;
         }
 
-        std::size_t get_item_offset(handle_type handle) const noexcept {
+        location get_location(handle_type handle) const noexcept {
             assert(handle.valid() && "handle must be valid");
             assert(handle.value <= m_index.size());
-            const auto& offset = m_index[handle.value - 1];
-            assert(offset != removed_item_offset);
-            assert(offset < m_buffer.committed());
-            return offset;
+            const auto& loc = m_index[handle.value - 1];
+            assert(loc.segment != removed_item_segment);
+            assert(loc.offset < m_segments[loc.segment].buffer.committed());
+            return loc;
+        }
+
+        osmium::memory::Buffer new_buffer() {
+            if (m_spare_buffers.empty()) {
+                return osmium::memory::Buffer{m_segment_size, osmium::memory::Buffer::auto_grow::no};
+            }
+            osmium::memory::Buffer buffer{std::move(m_spare_buffers.back())};
+            m_spare_buffers.pop_back();
+            return buffer;
+        }
+
+        uint32_t new_segment(osmium::memory::Buffer&& buffer) {
+            if (!m_free_segments.empty()) {
+                const auto n = m_free_segments.back();
+                m_free_segments.pop_back();
+                m_segments[n].buffer = std::move(buffer);
+                return n;
+            }
+            if (m_segments.size() >= removed_item_segment) {
+                throw std::length_error{"too many segments in ItemStash"};
+            }
+            m_segments.emplace_back();
+            m_segments.back().buffer = std::move(buffer);
+            return static_cast<uint32_t>(m_segments.size() - 1);
+        }
+
+        // Keep the memory of an unused segment for reuse or give the
+        // region in the spill file back.
+        void recycle_segment_memory(segment& seg) {
+            if (seg.region != not_spilled) {
+                m_spill_file.free(seg.region);
+                return;
+            }
+            if (seg.buffer && seg.buffer.capacity() == m_segment_size && m_spare_buffers.size() < max_spare_buffers) {
+                seg.buffer.clear();
+                m_spare_buffers.push_back(std::move(seg.buffer));
+            }
+        }
+
+        // Make a segment without live items available for new items. The
+        // current segment is reused in place, all others are freed.
+        void release_segment(uint32_t n) {
+            auto& seg = m_segments[n];
+            assert(seg.count_items == 0);
+            m_count_removed -= seg.count_removed;
+            if (n == m_current) {
+                seg.buffer.clear();
+                seg.handles.clear();
+                seg.count_removed = 0;
+                seg.removed_bytes = 0;
+                return;
+            }
+            recycle_segment_memory(seg);
+            seg = segment{};
+            m_free_segments.push_back(n);
+        }
+
+        // Remove the removed items from a segment by moving all live items
+        // to the front of its buffer.
+        void compact_segment(uint32_t n) {
+            auto& seg = m_segments[n];
+            seg.handles.erase(std::remove_if(seg.handles.begin(), seg.handles.end(), [&](std::size_t value) {
+                return m_index[value - 1].segment != n;
+            }), seg.handles.end());
+            cleanup_helper helper{m_index, seg.handles};
+            seg.buffer.purge_removed(&helper);
+            m_count_removed -= seg.count_removed;
+            seg.count_removed = 0;
+            seg.removed_bytes = 0;
         }
 
-        // This function decides whether it makes sense to garbage collect the
-        // database. The values here are the result of some experimentation
-        // with real data. We need to balance the memory use with the time
-        // spent on garbage collecting. We don't need to garbage collect if
-        // there is enough space in the buffer anyway (*4). On the other hand,
-        // if there aren't enough removed objects we would just call the
-        // garbage collection again and again, then it is better to let the
-        // buffer grow (*3). The checks (*1) and (*2) make sure there is
-        // minimum and maximum for the number of removed objects.
-        bool should_gc() const noexcept {
-            if (m_count_removed < 10 * 1000) { // *1
-                return false;
-            }
-            if (m_count_removed >  5 * 1000 * 1000) { // *2
-                return true;
-            }
-            if (m_count_removed * 5 < m_count_items) { // *3
-                return false;
-            }
-            return m_buffer.capacity() - m_buffer.committed() < 10 * 1024; // *4
+        // Find a segment to continue writing into after the current one is
+        // full. Empty segments are used first, then a segment with many
+        // removed items is compacted. Only if neither is available memory
+        // for a new segment is allocated. At most one segment is compacted
+        // here, so the work done is bounded by the segment size.
+        uint32_t next_segment() {
+            if (!m_spare_buffers.empty()) {
+                return new_segment(new_buffer());
+            }
+
+            while (!m_gc_candidates.empty()) {
+                const auto n = m_gc_candidates.back();
+                m_gc_candidates.pop_back();
+                auto& seg = m_segments[n];
+                if (!seg.gc_candidate) {
+                    continue;
+                }
+                seg.gc_candidate = false;
+                if (n != m_current && seg.region == not_spilled) {
+                    compact_segment(n);
+                    return n;
+                }
+            }
+
+            return new_segment(new_buffer());
+        }
+
+        std::size_t memory_in_buffers() const noexcept {
+            std::size_t size = m_spare_buffers.size() * m_segment_size;
+            for (const auto& seg : m_segments) {
+                if (seg.region == not_spilled) {
+                    size += seg.buffer.capacity();
+                }
+            }
+            return size;
+        }
+
+        // Find the segment which was written to the longest time ago and
+        // can be spilled to disk.
+        uint32_t coldest_segment() const noexcept {
+            uint32_t coldest = removed_item_segment;
+            for (uint32_t n = 0; n < m_segments.size(); ++n) {
+                const auto& seg = m_segments[n];
+                if (n != m_current && seg.region == not_spilled &&
+                    seg.buffer.capacity() == m_segment_size &&
+                    (coldest == removed_item_segment || seg.last_write < m_segments[coldest].last_write)) {
+                    coldest = n;
+                }
+            }
+            return coldest;
+        }
+
+        void spill_segment(uint32_t n) {
+            auto& seg = m_segments[n];
+            const auto region = m_spill_file.allocate(m_segment_size);
+            unsigned char* data = m_spill_file.data(region);
+            const auto committed = seg.buffer.committed();
+            std::copy_n(seg.buffer.data(), committed, data);
+            seg.buffer = osmium::memory::Buffer{data, m_segment_size, committed};
+            seg.region = region;
+        }
+
+        void enforce_memory_limit() {
+            if (m_memory_limit == 0) {
+                return;
+            }
+            std::size_t size = memory_in_buffers();
+            while (size > m_memory_limit && !m_spare_buffers.empty()) {
+                m_spare_buffers.pop_back();
+                size -= m_segment_size;
+            }
+            while (size > m_memory_limit) {
+                const auto n = coldest_segment();
+                if (n == removed_item_segment) {
+                    return;
+                }
+                spill_segment(n);
+                size -= m_segment_size;
+            }
         }
 
     public:
 
         ItemStash() :
-            m_buffer(initial_buffer_size, osmium::memory::Buffer::auto_grow::yes) {
+            ItemStash(default_segment_size) {
+        }
+
+        /**
+         * Create an ItemStash.
+         *
+         * @param segment_size The size of the memory segments used for
+         *        storing the items. Items that are larger get their own
+         *        segment.
+         * @throws std::invalid_argument If the segment size is too large.
+         */
+        explicit ItemStash(std::size_t segment_size) :
+            m_segment_size(segment_size) {
+            if (segment_size > std::numeric_limits<uint32_t>::max()) {
+                throw std::invalid_argument{"ItemStash segment size too large"};
+            }
+            m_current = new_segment(new_buffer());
+            m_segment_size = m_segments[m_current].buffer.capacity();
         }
 
         /**
          * Return an estimate of the number of bytes currently used by this
-         * ItemStash instance.
+         * ItemStash instance. Segments spilled to disk are not counted.
          *
-         * Complexity: Constant.
+         * Complexity: Linear in the number of segments.
          */
         std::size_t used_memory() const noexcept {
-            return sizeof(ItemStash) +
-                   m_buffer.capacity() +
-                   m_index.capacity() * sizeof(std::size_t);
+            std::size_t size = sizeof(ItemStash) +
+                               m_segments.capacity() * sizeof(segment) +
+                               m_index.capacity() * sizeof(location) +
+                               memory_in_buffers();
+            for (const auto& seg : m_segments) {
+                size += seg.handles.capacity() * sizeof(std::size_t);
+            }
+            return size;
         }
 
         /**
@@ -231,15 +578,70 @@ namespace osmium {
             return m_count_removed;
         }
 
+        /**
+         * The number of memory segments currently in use.
+         *
+         * Complexity: Constant.
+         */
+        std::size_t count_segments() const noexcept {
+            return m_segments.size() - m_free_segments.size();
+        }
+
+        /**
+         * The number of memory segments currently spilled to disk.
+         *
+         * Complexity: Constant.
+         */
+        std::size_t count_spilled_segments() const noexcept {
+            return m_spill_file.count_regions();
+        }
+
+        /**
+         * The memory limit set with set_memory_limit(). 0 means there is
+         * no limit.
+         */
+        std::size_t memory_limit() const noexcept {
+            return m_memory_limit;
+        }
+
+        /**
+         * Set the maximum number of bytes to be used for the segments in
+         * memory. If more memory is needed, the segments that were written
+         * to the longest time ago are spilled to a temporary file and
+         * memory mapped from there. Accessing those items can be much
+         * slower if the operating system has to read them from disk. The
+         * segment currently written to always stays in memory, so the
+         * limit can be exceeded by up to one segment. Set to 0 (the
+         * default) to disable the limit.
+         *
+         * This will spill segments to disk right away if needed.
+         *
+         * @throws std::system_error If the temporary file can not be
+         *         created or resized.
+         */
+        void set_memory_limit(std::size_t limit) {
+            m_memory_limit = limit;
+            enforce_memory_limit();
+        }
+
         /**
          * Clear all items from the stash. This will not necessarily release
          * any memory. All handles are invalidated.
          */
         void clear() {
-            m_buffer.clear();
+            for (auto& seg : m_segments) {
+                if (seg.region == not_spilled) {
+                    recycle_segment_memory(seg);
+                }
+            }
+            m_segments.clear();
+            m_spill_file.clear();
+            m_free_segments.clear();
+            m_gc_candidates.clear();
             m_index.clear();
             m_count_items = 0;
             m_count_removed = 0;
+            m_current = new_segment(new_buffer());
         }
 
         /**
@@ -249,14 +651,30 @@ namespace osmium {
          * Complexity: Amortized constant.
          */
         handle_type add_item(const osmium::memory::Item& item) {
-            if (should_gc()) {
+            if (m_count_removed > max_count_removed) {
                 garbage_collect();
             }
+
+            const std::size_t size = item.padded_size();
+            uint32_t n = m_current;
+            if (size > m_segment_size) {
+                n = new_segment(osmium::memory::Buffer{size, osmium::memory::Buffer::auto_grow::no});
+                enforce_memory_limit();
+            } else if (m_segments[n].buffer.capacity() - m_segments[n].buffer.committed() < size) {
+                n = next_segment();
+                m_current = n;
+                enforce_memory_limit();
+            }
+
+            auto& seg = m_segments[n];
+            seg.last_write = m_index.size();
+            const auto offset = seg.buffer.committed();
+            seg.buffer.add_item(item);
+            seg.buffer.commit();
+            m_index.push_back(location{n, static_cast<uint32_t>(offset)});
+            seg.handles.push_back(m_index.size());
+            ++seg.count_items;
             ++m_count_items;
-            const auto offset = m_buffer.committed();
-            m_buffer.add_item(item);
-            m_buffer.commit();
-            m_index.push_back(offset);
             return handle_type{m_index.size()};
         }
 
@@ -272,7 +690,8 @@ namespace osmium {
          *      item.
          */
         osmium::memory::Item& get_item(handle_type handle) const {
-            return m_buffer.get<osmium::memory::Item>(get_item_offset(handle));
+            const auto loc = get_location(handle);
+            return m_segments[loc.segment].buffer.get<osmium::memory::Item>(loc.offset);
         }
 
         /**
@@ -296,23 +715,29 @@ namespace osmium {
         }
 
         /**
-         * Garbage collect the memory used by the ItemStash. This will free up
-         * memory for adding new items. No memory is actually returned to the
-         * OS. Usually you do not need to call this, because add_item() will
-         * call it for you as necessary.
+         * Garbage collect the memory used by the ItemStash. This compacts
+         * all segments with removed items. No memory is actually returned
+         * to the OS. Usually you do not need to call this, because add_item()
+         * will compact segments one at a time as necessary.
          *
          * Complexity: Linear in size() + count_removed().
          */
         void garbage_collect() {
 #ifdef OSMIUM_ITEM_STORAGE_GC_DEBUG
-            std::cerr << "GC items=" << m_count_items << " removed=" << m_count_removed << " buffer.committed=" << m_buffer.committed() << " buffer.capacity=" << m_buffer.capacity() << "\n";
+            std::cerr << "GC items=" << m_count_items << " removed=" << m_count_removed << " segments=" << count_segments() << "\n";
             using clock = std::chrono::high_resolution_clock;
             std::chrono::time_point<clock> start = clock::now();
 #endif
 
-            m_count_removed = 0;
-            cleanup_helper helper{m_index};
-            m_buffer.purge_removed(&helper);
+            for (uint32_t n = 0; n < m_segments.size(); ++n) {
+                auto& seg = m_segments[n];
+                seg.gc_candidate = false;
+                if (seg.count_removed > 0) {
+                    compact_segment(n);
+                }
+            }
+            m_gc_candidates.clear();
+            assert(m_count_removed == 0);
 
 #ifdef OSMIUM_ITEM_STORAGE_GC_DEBUG
             std::chrono::time_point<clock> stop = clock::now();
@@ -325,8 +750,9 @@ namespace osmium {
 
         /**
          * Remove an item from the stash. The item will be marked as removed
-         * and the handle will be invalidated. No memory will actually be
-         * freed.
+         * and the handle will be invalidated. If this was the last item in
+         * its segment, the segment is freed for reuse, otherwise no memory
+         * will be freed right away.
          *
          * Complexity: Constant.
          *
@@ -336,13 +762,26 @@ namespace osmium {
          *      item.
          */
         void remove_item(handle_type handle) {
-            auto& offset = get_item_offset_ref(handle);
-            auto& item = m_buffer.get<osmium::memory::Item>(offset);
+            auto& loc = get_location_ref(handle);
+            const auto n = loc.segment;
+            auto& seg = m_segments[n];
+            auto& item = seg.buffer.get<osmium::memory::Item>(loc.offset);
             assert(!item.removed() && "can not call remove_item() on already removed item");
             item.set_removed(true);
-            offset = removed_item_offset;
+            loc.segment = removed_item_segment;
             --m_count_items;
             ++m_count_removed;
+
+            --seg.count_items;
+            ++seg.count_removed;
+            seg.removed_bytes += item.padded_size();
+
+            if (seg.count_items == 0) {
+                release_segment(n);
+            } else if (!seg.gc_candidate && seg.removed_bytes * 2 >= seg.buffer.capacity()) {
+                seg.gc_candidate = true;
+                m_gc_candidates.push_back(n);
+            }
         }
 
     }; // class ItemStash
@@ -0,0 +1,164 @@
+#ifndef OSMIUM_TAGS_BUFFER_FILTER_HPP
+#define OSMIUM_TAGS_BUFFER_FILTER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/tag.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <vector>
+
+namespace osmium {
+
+    namespace tags {
+
+        namespace detail {
+
+            inline bool is_object_of(const osmium::memory::Item& item, osmium::osm_entity_bits::type entities) noexcept {
+                const auto type = item.type();
+                if (item.removed() || type < osmium::item_type::node || type > osmium::item_type::area) {
+                    return false;
+                }
+                return (osmium::osm_entity_bits::from_item_type(type) & entities) != 0;
+            }
+
+            template <typename TFilter>
+            bool match_object(const osmium::memory::Item& item, const TFilter& filter) {
+                const auto& tags = static_cast<const osmium::OSMObject&>(item).tags();
+                return std::any_of(tags.cbegin(), tags.cend(), std::cref(filter));
+            }
+
+        } // namespace detail
+
+        /**
+         * Check all OSM objects in a buffer against a filter in one go. An
+         * object is selected if the filter returns true for any of its
+         * tags. The filter can be anything callable with an osmium::Tag,
+         * for instance a TagsFilter, a CompiledTagsFilter, or a TagMatcher.
+         *
+         * The filter and the buffer are only read, so this can run on
+         * different buffers in different threads at the same time, see
+         * select_objects_async().
+         *
+         * @param buffer The buffer with the objects.
+         * @param filter The filter.
+         * @param entities Only objects of these types can be selected.
+         * @returns The offsets of all selected objects in the buffer in
+         *          ascending order.
+         */
+        template <typename TFilter>
+        std::vector<std::size_t> select_objects(const osmium::memory::Buffer& buffer, const TFilter& filter, osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::object) {
+            std::vector<std::size_t> offsets;
+            const unsigned char* const data = buffer.data();
+            for (auto it = buffer.cbegin(); it != buffer.cend(); ++it) {
+                if (detail::is_object_of(*it, entities) && detail::match_object(*it, filter)) {
+                    offsets.push_back(static_cast<std::size_t>(it->data() - data));
+                }
+            }
+            return offsets;
+        }
+
+        /**
+         * Check all OSM objects in a buffer against a filter in one go like
+         * select_objects(), but return a bitmap.
+         *
+         * @param buffer The buffer with the objects.
+         * @param filter The filter.
+         * @param entities Only objects of these types can be selected.
+         * @returns A vector with one entry for each OSM object (of any
+         *          type) in the buffer in buffer order, the entry is true
+         *          if the object was selected.
+         */
+        template <typename TFilter>
+        std::vector<bool> select_objects_bitmap(const osmium::memory::Buffer& buffer, const TFilter& filter, osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::object) {
+            std::vector<bool> bitmap;
+            for (const auto& item : buffer) {
+                if (detail::is_object_of(item, osmium::osm_entity_bits::object)) {
+                    bitmap.push_back(detail::is_object_of(item, entities) && detail::match_object(item, filter));
+                }
+            }
+            return bitmap;
+        }
+
+        /**
+         * Run select_objects() on a buffer in the thread pool. The buffer
+         * and the filter must stay alive and unchanged until the result is
+         * available.
+         *
+         * @returns A future with the offsets of the selected objects.
+         */
+        template <typename TFilter>
+        std::future<std::vector<std::size_t>> select_objects_async(osmium::thread::Pool& pool, const osmium::memory::Buffer& buffer, const TFilter& filter, osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::object) {
+            return pool.submit([&buffer, &filter, entities]() {
+                return select_objects(buffer, filter, entities);
+            });
+        }
+
+        /**
+         * Copy the objects at the specified offsets from one buffer into
+         * another. Runs of objects lying next to each other in the input
+         * buffer are copied in one go.
+         *
+         * @param input The buffer with the objects.
+         * @param offsets Offsets of the objects in the input buffer in
+         *                ascending order, usually from select_objects().
+         * @param output The buffer the objects are copied to. It must not
+         *               have any uncommitted data.
+         */
+        inline void copy_selected(const osmium::memory::Buffer& input, const std::vector<std::size_t>& offsets, osmium::memory::Buffer& output) {
+            const unsigned char* const data = input.data();
+            for (std::size_t n = 0; n < offsets.size();) {
+                const std::size_t begin = offsets[n];
+                std::size_t end = begin;
+                for (; n < offsets.size() && offsets[n] == end; ++n) {
+                    end += input.get<osmium::memory::Item>(end).padded_size();
+                }
+                std::copy_n(data + begin, end - begin, output.reserve_space(end - begin));
+                output.commit();
+            }
+        }
+
+    } // namespace tags
+
+} // namespace osmium
+
+#endif // OSMIUM_TAGS_BUFFER_FILTER_HPP
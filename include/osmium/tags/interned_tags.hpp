@@ -0,0 +1,151 @@
+#ifndef OSMIUM_TAGS_INTERNED_TAGS_HPP
+#define OSMIUM_TAGS_INTERNED_TAGS_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/osm/tag.hpp>
+#include <osmium/util/string_pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace osmium {
+
+    namespace tags {
+
+        /**
+         * A tag where key and value are represented by their ids in a
+         * StringPool.
+         */
+        struct interned_tag {
+
+            uint32_t key;
+            uint32_t value;
+
+        }; // struct interned_tag
+
+        inline bool operator==(const interned_tag& lhs, const interned_tag& rhs) noexcept {
+            return lhs.key == rhs.key && lhs.value == rhs.value;
+        }
+
+        inline bool operator!=(const interned_tag& lhs, const interned_tag& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * A view of the tags of an object in which keys and values are
+         * represented by their ids in a StringPool. Key lookups and tag
+         * comparisons are integer comparisons.
+         *
+         * The tags are kept in the order of the original TagList.
+         */
+        class InternedTagList {
+
+            std::vector<interned_tag> m_tags;
+
+        public:
+
+            using const_iterator = std::vector<interned_tag>::const_iterator;
+
+            InternedTagList() = default;
+
+            /**
+             * Create from a TagList adding all keys and values to the pool.
+             */
+            InternedTagList(osmium::StringPool& pool, const osmium::TagList& tags) {
+                assign(pool, tags);
+            }
+
+            /**
+             * Replace contents with the tags from the TagList adding all
+             * keys and values to the pool. Reuses the allocated memory, so
+             * one InternedTagList can be used for many objects.
+             */
+            void assign(osmium::StringPool& pool, const osmium::TagList& tags) {
+                m_tags.clear();
+                m_tags.reserve(tags.size());
+                for (const auto& tag : tags) {
+                    m_tags.push_back(interned_tag{pool.add(tag.key()), pool.add(tag.value())});
+                }
+            }
+
+            std::size_t size() const noexcept {
+                return m_tags.size();
+            }
+
+            bool empty() const noexcept {
+                return m_tags.empty();
+            }
+
+            const_iterator begin() const noexcept {
+                return m_tags.cbegin();
+            }
+
+            const_iterator end() const noexcept {
+                return m_tags.cend();
+            }
+
+            const interned_tag& operator[](std::size_t n) const noexcept {
+                return m_tags[n];
+            }
+
+            /**
+             * Get the id of the value of the tag with the specified key id.
+             *
+             * @returns Id of the value or StringPool::invalid_id if there
+             *          is no tag with this key.
+             */
+            uint32_t get_value_by_key(uint32_t key) const noexcept {
+                const auto it = std::find_if(m_tags.cbegin(), m_tags.cend(), [key](const interned_tag& tag) {
+                    return tag.key == key;
+                });
+                return it == m_tags.cend() ? static_cast<uint32_t>(osmium::StringPool::invalid_id) : it->value;
+            }
+
+            bool has_key(uint32_t key) const noexcept {
+                return get_value_by_key(key) != osmium::StringPool::invalid_id;
+            }
+
+            bool has_tag(uint32_t key, uint32_t value) const noexcept {
+                return std::find(m_tags.cbegin(), m_tags.cend(), interned_tag{key, value}) != m_tags.cend();
+            }
+
+        }; // class InternedTagList
+
+    } // namespace tags
+
+} // namespace osmium
+
+#endif // OSMIUM_TAGS_INTERNED_TAGS_HPP
@@ -97,14 +97,28 @@ namespace osmium {
             m_result(!invert) {
         }
 
+        /// The StringMatcher used for the key.
+        const osmium::StringMatcher& key_matcher() const noexcept {
+            return m_key_matcher;
+        }
+
+        /**
+         * Match only against the specified value. Use this if the key is
+         * already known to match.
+         *
+         * @returns true if the value matches.
+         */
+        bool match_value(const char* value) const noexcept {
+            return m_value_matcher(value) == m_result;
+        }
+
         /**
          * Match against the specified key and value.
          *
          * @returns true if the tag matches.
          */
         bool operator()(const char* key, const char* value) const noexcept {
-            return m_key_matcher(key) &&
-                   (m_value_matcher(value) == m_result);
+            return m_key_matcher(key) && match_value(value);
         }
 
         /**
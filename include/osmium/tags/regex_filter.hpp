@@ -34,6 +34,7 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/tags/filter.hpp>
+#include <osmium/util/dfa_regex.hpp>
 
 #include <regex>
 #include <string>
@@ -56,9 +57,41 @@ namespace osmium {
             }
         }; // struct match_value<std::regex>
 
+        template <>
+        struct match_key<osmium::DFARegex> {
+            bool operator()(const osmium::DFARegex& rule_key, const char* tag_key) const noexcept {
+                return rule_key(tag_key);
+            }
+        }; // struct match_key<osmium::DFARegex>
+
+        template <>
+        struct match_value<osmium::DFARegex> {
+            bool operator()(const osmium::DFARegex& rule_value, const char* tag_value) const noexcept {
+                return rule_value(tag_value);
+            }
+        }; // struct match_value<osmium::DFARegex>
+
         /// @deprecated Use osmium::TagsFilter instead.
         using RegexFilter = Filter<std::string, std::regex>;
 
+        /**
+         * Like RegexFilter, but uses osmium::DFARegex for the values.
+         * Create the DFARegex objects with full_match set to true to get
+         * the same behaviour as with std::regex.
+         *
+         * @deprecated Use osmium::TagsFilter instead.
+         */
+        using DFARegexFilter = Filter<std::string, osmium::DFARegex>;
+
+        /**
+         * Filter with regular expressions for keys using osmium::DFARegex.
+         * Create the DFARegex objects with full_match set to true to get
+         * the same behaviour as with std::regex.
+         *
+         * @deprecated Use osmium::TagsFilter instead.
+         */
+        using DFARegexKeyFilter = Filter<osmium::DFARegex>;
+
     } // namespace tags
 
 } // namespace osmium
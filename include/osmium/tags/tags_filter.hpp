@@ -35,14 +35,23 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/osm/tag.hpp>
 #include <osmium/tags/matcher.hpp>
+#include <osmium/util/string_matcher.hpp>
+#include <osmium/util/string_set.hpp>
 
 #include <boost/iterator/filter_iterator.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <utility>
 #include <vector>
 
 namespace osmium {
 
+    template <typename TResult>
+    class CompiledTagsFilterBase;
+
     /**
      * A TagsFilterBase is a list of rules (defined using TagMatchers) to
      * check tags against. The first rule that matches sets the result.
@@ -152,10 +161,238 @@ namespace osmium {
             return m_rules.empty();
         }
 
+        /**
+         * Create an immutable compiled version of this filter which gives
+         * the same results, but is much faster for filters with many
+         * rules. Later changes to this filter don't affect the compiled
+         * filter.
+         */
+        CompiledTagsFilterBase<TResult> compile() const {
+            return CompiledTagsFilterBase<TResult>{m_rules, m_default_result};
+        }
+
     }; // class TagsFilterBase
 
+    /**
+     * A compiled TagsFilterBase. Create it by calling compile() on a
+     * TagsFilterBase.
+     *
+     * Rules with keys matched by StringMatcher::equal, list, or string_set
+     * are found through a hash table keyed on the tag key, rules with keys
+     * matched by StringMatcher::prefix through a trie. Only the value
+     * matchers of those rules are checked. Rules with other key matchers
+     * are checked as usual. The rules are still checked in the order they
+     * were added, the first rule that matches sets the result.
+     */
+    template <typename TResult>
+    class CompiledTagsFilterBase {
+
+        // A range of rule indexes in m_indexes.
+        struct index_range {
+            uint32_t begin = 0;
+            uint32_t end = 0;
+        };
+
+        struct trie_node {
+            // Children sorted by character.
+            std::vector<std::pair<char, uint32_t>> children{};
+            index_range rules{};
+        };
+
+        std::vector<std::pair<TResult, TagMatcher>> m_rules;
+
+        // Indexes into m_rules, each range in ascending order.
+        std::vector<uint32_t> m_indexes{};
+
+        // The keys of all rules with exact key matches.
+        osmium::StringSet m_keys{};
+
+        // Rules for each key in m_keys.
+        std::vector<index_range> m_key_rules{};
+
+        std::vector<trie_node> m_trie{};
+
+        // Rules which have to be checked for every tag.
+        index_range m_other{};
+
+        TResult m_default_result;
+
+        index_range add_indexes(const std::vector<uint32_t>& indexes) {
+            index_range range;
+            range.begin = static_cast<uint32_t>(m_indexes.size());
+            m_indexes.insert(m_indexes.end(), indexes.begin(), indexes.end());
+            range.end = static_cast<uint32_t>(m_indexes.size());
+            return range;
+        }
+
+        void build_key_table(std::vector<std::pair<std::string, uint32_t>>& exact) {
+            // Sorting by key and rule index groups the rules for each key
+            // in ascending order.
+            std::sort(exact.begin(), exact.end());
+
+            std::vector<std::string> keys;
+            std::vector<uint32_t> rules;
+            for (auto it = exact.begin(); it != exact.end();) {
+                const auto& key = it->first;
+                rules.clear();
+                for (; it != exact.end() && it->first == key; ++it) {
+                    if (rules.empty() || rules.back() != it->second) {
+                        rules.push_back(it->second);
+                    }
+                }
+                keys.push_back(key);
+                m_key_rules.push_back(add_indexes(rules));
+            }
+            m_keys = osmium::StringSet{keys};
+        }
+
+        void build_trie(const std::vector<std::pair<std::string, uint32_t>>& prefixes) {
+            std::vector<std::vector<uint32_t>> node_rules(1);
+            m_trie.resize(1);
+            for (const auto& entry : prefixes) {
+                uint32_t node = 0;
+                for (const char c : entry.first) {
+                    auto& children = m_trie[node].children;
+                    const auto it = std::lower_bound(children.begin(), children.end(), c, [](const std::pair<char, uint32_t>& child, char value) {
+                        return child.first < value;
+                    });
+                    if (it != children.end() && it->first == c) {
+                        node = it->second;
+                    } else {
+                        const auto child = static_cast<uint32_t>(m_trie.size());
+                        children.insert(it, std::make_pair(c, child));
+                        m_trie.emplace_back();
+                        node_rules.emplace_back();
+                        node = child;
+                    }
+                }
+                node_rules[node].push_back(entry.second);
+            }
+            for (std::size_t n = 0; n < m_trie.size(); ++n) {
+                m_trie[n].rules = add_indexes(node_rules[n]);
+            }
+        }
+
+        // Check the rules in the range up to (not including) the rule
+        // with index best. Update best if a rule matches.
+        void check(const index_range range, const char* key, const char* value, bool key_matched, uint32_t* best) const noexcept {
+            for (auto n = range.begin; n != range.end && m_indexes[n] < *best; ++n) {
+                const auto& matcher = m_rules[m_indexes[n]].second;
+                if (key_matched ? matcher.match_value(value) : matcher(key, value)) {
+                    *best = m_indexes[n];
+                    return;
+                }
+            }
+        }
+
+    public:
+
+        using iterator = boost::filter_iterator<CompiledTagsFilterBase, osmium::TagList::const_iterator>;
+
+        /**
+         * Constructor. Usually you want to call TagsFilterBase::compile()
+         * instead.
+         *
+         * @param rules The rules in the order they should be checked.
+         * @param default_result The result the matching function will return
+         *                       if none of the rules matched.
+         */
+        CompiledTagsFilterBase(std::vector<std::pair<TResult, TagMatcher>> rules, const TResult default_result) :
+            m_rules(std::move(rules)),
+            m_default_result(default_result) {
+            std::vector<std::pair<std::string, uint32_t>> exact;
+            std::vector<std::pair<std::string, uint32_t>> prefixes;
+            std::vector<uint32_t> other;
+
+            for (uint32_t n = 0; n < m_rules.size(); ++n) {
+                const osmium::StringMatcher& key_matcher = m_rules[n].second.key_matcher();
+                if (const auto* equal = key_matcher.get_if<StringMatcher::equal>()) {
+                    exact.emplace_back(equal->str(), n);
+                } else if (const auto* list = key_matcher.get_if<StringMatcher::list>()) {
+                    for (const auto& str : list->strings()) {
+                        exact.emplace_back(str, n);
+                    }
+                } else if (const auto* set = key_matcher.get_if<StringMatcher::string_set>()) {
+                    for (const auto& str : set->strings()) {
+                        exact.emplace_back(str, n);
+                    }
+                } else if (const auto* prefix = key_matcher.get_if<StringMatcher::prefix>()) {
+                    prefixes.emplace_back(prefix->str(), n);
+                } else if (!key_matcher.get_if<StringMatcher::always_false>()) {
+                    other.push_back(n);
+                }
+            }
+
+            build_key_table(exact);
+            build_trie(prefixes);
+            m_other = add_indexes(other);
+        }
+
+        /**
+         * Matching function. Check the specified tag against the rules.
+         *
+         * @param tag A tag.
+         * @returns The result of the first matching rule, or, if none of
+         *          the rules matched, the default result.
+         */
+        TResult operator()(const osmium::Tag& tag) const noexcept {
+            const char* key = tag.key();
+            const char* value = tag.value();
+            auto best = static_cast<uint32_t>(m_rules.size());
+
+            const auto n = m_keys.find(key);
+            if (n != osmium::StringSet::npos) {
+                check(m_key_rules[n], key, value, true, &best);
+            }
+
+            uint32_t node = 0;
+            for (const char* p = key;; ++p) {
+                check(m_trie[node].rules, key, value, true, &best);
+                const auto& children = m_trie[node].children;
+                if (*p == '\0' || children.empty()) {
+                    break;
+                }
+                const auto it = std::lower_bound(children.begin(), children.end(), *p, [](const std::pair<char, uint32_t>& child, char c) {
+                    return child.first < c;
+                });
+                if (it == children.end() || it->first != *p) {
+                    break;
+                }
+                node = it->second;
+            }
+
+            check(m_other, key, value, false, &best);
+
+            if (best < m_rules.size()) {
+                return m_rules[best].first;
+            }
+            return m_default_result;
+        }
+
+        /**
+         * Return the number of rules in this filter.
+         *
+         * Complexity: Constant.
+         */
+        std::size_t count() const noexcept {
+            return m_rules.size();
+        }
+
+        /**
+         * Is this filter empty, ie are there no rules defined?
+         *
+         * Complexity: Constant.
+         */
+        bool empty() const noexcept {
+            return m_rules.empty();
+        }
+
+    }; // class CompiledTagsFilterBase
+
     using TagsFilter = TagsFilterBase<bool>;
 
+    using CompiledTagsFilter = CompiledTagsFilterBase<bool>;
+
 } // namespace osmium
 
 
@@ -0,0 +1,141 @@
+#ifndef OSMIUM_THREAD_SORT_HPP
+#define OSMIUM_THREAD_SORT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <vector>
+
+namespace osmium {
+
+    namespace thread {
+
+        namespace detail {
+
+            // Ranges smaller than this are sorted on the calling thread.
+            enum : std::size_t {
+                min_parallel_sort_size = 64UL * 1024UL
+            };
+
+        } // namespace detail
+
+        /**
+         * Sort the range [first, last) using the threads in the pool. The
+         * range is split into one part per thread, the parts are sorted
+         * in parallel and then merged, also in parallel where possible.
+         * Small ranges are sorted directly on the calling thread.
+         *
+         * Do not call this from a task running in the same pool, it will
+         * wait for tasks in the pool to finish.
+         *
+         * @param pool The thread pool to use.
+         * @param first, last The range to sort.
+         * @param compare Comparison function.
+         */
+        template <typename TIterator, typename TCompare>
+        void parallel_sort(Pool& pool, TIterator first, TIterator last, TCompare compare) {
+            const auto size = static_cast<std::size_t>(std::distance(first, last));
+            const auto num_parts = static_cast<std::size_t>(pool.num_threads());
+            if (size < detail::min_parallel_sort_size || num_parts < 2) {
+                std::sort(first, last, compare);
+                return;
+            }
+
+            std::vector<TIterator> bounds;
+            bounds.reserve(num_parts + 1);
+            for (std::size_t i = 0; i < num_parts; ++i) {
+                bounds.push_back(std::next(first, static_cast<typename std::iterator_traits<TIterator>::difference_type>(size * i / num_parts)));
+            }
+            bounds.push_back(last);
+
+            std::vector<std::future<void>> futures;
+            try {
+                for (std::size_t i = 0; i < num_parts; ++i) {
+                    futures.push_back(pool.submit([&bounds, &compare, i]() {
+                        std::sort(bounds[i], bounds[i + 1], compare);
+                    }));
+                }
+                for (auto& future : futures) {
+                    future.get();
+                }
+
+                while (bounds.size() > 2) {
+                    futures.clear();
+                    std::vector<TIterator> new_bounds;
+                    for (std::size_t i = 0; i + 2 < bounds.size(); i += 2) {
+                        futures.push_back(pool.submit([&bounds, &compare, i]() {
+                            std::inplace_merge(bounds[i], bounds[i + 1], bounds[i + 2], compare);
+                        }));
+                        new_bounds.push_back(bounds[i]);
+                    }
+                    if (bounds.size() % 2 == 0) {
+                        new_bounds.push_back(bounds[bounds.size() - 2]);
+                    }
+                    new_bounds.push_back(last);
+                    for (auto& future : futures) {
+                        future.get();
+                    }
+                    bounds = std::move(new_bounds);
+                }
+            } catch (...) {
+                // The tasks still running use the local variables, wait
+                // for them before the exception leaves this function.
+                for (auto& future : futures) {
+                    if (future.valid()) {
+                        future.wait();
+                    }
+                }
+                throw;
+            }
+        }
+
+        /**
+         * Sort the range [first, last) using operator< and the threads in
+         * the pool. See the other version of this function for details.
+         */
+        template <typename TIterator>
+        void parallel_sort(Pool& pool, TIterator first, TIterator last) {
+            parallel_sort(pool, first, last, std::less<>{});
+        }
+
+    } // namespace thread
+
+} // namespace osmium
+
+#endif // OSMIUM_THREAD_SORT_HPP
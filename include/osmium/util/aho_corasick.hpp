@@ -0,0 +1,208 @@
+#ifndef OSMIUM_UTIL_AHO_CORASICK_HPP
+#define OSMIUM_UTIL_AHO_CORASICK_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * Finds out whether any of a set of strings is contained in a test
+     * string using the Aho-Corasick algorithm. The automaton is built once
+     * in the constructor, matching takes time linear in the length of the
+     * test string independent of the number of patterns and doesn't
+     * allocate any memory.
+     */
+    class AhoCorasick {
+
+        struct node {
+            // Edges of this node in m_edges.
+            uint32_t first_edge = 0;
+            uint32_t num_edges = 0;
+
+            // Node for the longest proper suffix which is in the trie.
+            uint32_t fail = 0;
+
+            // Does a pattern end here or in any node on the fail chain?
+            bool output = false;
+        };
+
+        std::vector<node> m_nodes{};
+
+        // Edges sorted by node and character.
+        std::vector<std::pair<unsigned char, uint32_t>> m_edges{};
+
+        // Transitions from the root for all characters (0 if there is
+        // no edge).
+        std::array<uint32_t, 256> m_root{};
+
+        std::size_t m_size = 0;
+
+        uint32_t edge(uint32_t n, unsigned char c) const noexcept {
+            const auto begin = m_edges.begin() + m_nodes[n].first_edge;
+            const auto end = begin + m_nodes[n].num_edges;
+            const auto it = std::lower_bound(begin, end, c, [](const std::pair<unsigned char, uint32_t>& e, unsigned char value) {
+                return e.first < value;
+            });
+            if (it != end && it->first == c) {
+                return it->second;
+            }
+            return 0;
+        }
+
+    public:
+
+        /// Create an automaton that never matches.
+        AhoCorasick() :
+            m_nodes(1) {
+        }
+
+        /**
+         * Create the automaton for the specified patterns. An empty
+         * pattern matches everything.
+         */
+        explicit AhoCorasick(const std::vector<std::string>& patterns) {
+            // Build trie with unsorted edge lists first.
+            std::vector<std::vector<std::pair<unsigned char, uint32_t>>> children(1);
+            std::vector<bool> terminal(1);
+            for (const auto& pattern : patterns) {
+                uint32_t n = 0;
+                for (const char ch : pattern) {
+                    const auto c = static_cast<unsigned char>(ch);
+                    const auto it = std::find_if(children[n].begin(), children[n].end(), [c](const std::pair<unsigned char, uint32_t>& e) {
+                        return e.first == c;
+                    });
+                    if (it != children[n].end()) {
+                        n = it->second;
+                    } else {
+                        const auto child = static_cast<uint32_t>(children.size());
+                        children[n].emplace_back(c, child);
+                        children.emplace_back();
+                        terminal.push_back(false);
+                        n = child;
+                    }
+                }
+                terminal[n] = true;
+            }
+            m_size = patterns.size();
+
+            m_nodes.resize(children.size());
+            for (std::size_t n = 0; n < children.size(); ++n) {
+                std::sort(children[n].begin(), children[n].end());
+                m_nodes[n].first_edge = static_cast<uint32_t>(m_edges.size());
+                m_nodes[n].num_edges = static_cast<uint32_t>(children[n].size());
+                m_nodes[n].output = terminal[n];
+                m_edges.insert(m_edges.end(), children[n].begin(), children[n].end());
+            }
+            for (const auto& e : children[0]) {
+                m_root[e.first] = e.second;
+            }
+
+            // Compute fail links breadth first.
+            std::vector<uint32_t> queue;
+            for (const auto& e : children[0]) {
+                queue.push_back(e.second);
+            }
+            for (std::size_t i = 0; i < queue.size(); ++i) {
+                const auto u = queue[i];
+                for (const auto& e : children[u]) {
+                    auto f = m_nodes[u].fail;
+                    while (f != 0 && edge(f, e.first) == 0) {
+                        f = m_nodes[f].fail;
+                    }
+                    const auto target = f == 0 ? m_root[e.first] : edge(f, e.first);
+                    m_nodes[e.second].fail = target;
+                    m_nodes[e.second].output = m_nodes[e.second].output || m_nodes[target].output;
+                    queue.push_back(e.second);
+                }
+            }
+        }
+
+        /// The number of patterns.
+        std::size_t size() const noexcept {
+            return m_size;
+        }
+
+        /// The number of nodes in the automaton.
+        std::size_t count_nodes() const noexcept {
+            return m_nodes.size();
+        }
+
+        /**
+         * Does any of the patterns occur in the test string?
+         */
+        bool operator()(const char* str) const noexcept {
+            if (m_nodes[0].output) {
+                return true;
+            }
+            uint32_t state = 0;
+            for (; *str != '\0'; ++str) {
+                const auto c = static_cast<unsigned char>(*str);
+                while (true) {
+                    if (state == 0) {
+                        state = m_root[c];
+                        break;
+                    }
+                    const auto next = edge(state, c);
+                    if (next != 0) {
+                        state = next;
+                        break;
+                    }
+                    state = m_nodes[state].fail;
+                }
+                if (m_nodes[state].output) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Does any of the patterns occur in the test string?
+         */
+        bool operator()(const std::string& str) const noexcept {
+            return operator()(str.c_str());
+        }
+
+    }; // class AhoCorasick
+
+} // namespace osmium
+
+#endif // OSMIUM_UTIL_AHO_CORASICK_HPP
@@ -0,0 +1,726 @@
+#ifndef OSMIUM_UTIL_DFA_REGEX_HPP
+#define OSMIUM_UTIL_DFA_REGEX_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * Exception thrown when a regular expression given to DFARegex can not
+     * be parsed or needs too many states.
+     */
+    struct dfa_regex_error : public std::runtime_error {
+
+        explicit dfa_regex_error(const char* message) :
+            std::runtime_error(message) {
+        }
+
+        explicit dfa_regex_error(const std::string& message) :
+            std::runtime_error(message) {
+        }
+
+    }; // struct dfa_regex_error
+
+    namespace detail {
+
+        /**
+         * Parses a regular expression and creates a nondeterministic finite
+         * automaton (Thompson construction) from it. Used by DFARegex.
+         */
+        class regex_nfa_builder {
+
+        public:
+
+            using charset = std::bitset<256>;
+
+            struct state {
+                std::vector<std::size_t> epsilon{};
+                int set = -1; // index into m_sets or -1 if no transition
+                std::size_t next = 0;
+            };
+
+        private:
+
+            enum class node_type {
+                empty,
+                set,
+                concat,
+                alternative,
+                star,
+                plus,
+                optional
+            };
+
+            // Nodes of the parse tree. Repetitions reference the same
+            // child node several times.
+            struct node {
+                node_type type;
+                std::size_t a;
+                std::size_t b;
+            };
+
+            enum : int {
+                max_repeat = 1000
+            };
+
+            enum : std::size_t {
+                max_nfa_states = 100000
+            };
+
+            const std::string& m_pattern;
+            std::size_t m_pos = 0;
+
+            std::vector<node> m_nodes{};
+            std::vector<charset> m_sets{};
+            std::vector<state> m_states{};
+
+            // Nesting depth of groups while parsing.
+            int m_depth = 0;
+
+            bool m_anchored_begin = false;
+            bool m_anchored_end = false;
+            bool m_top_level_alternative = false;
+
+            [[noreturn]] void error(const char* message) const {
+                throw dfa_regex_error{std::string{"regex error: "} + message + " at position " + std::to_string(m_pos) + " in '" + m_pattern + "'"};
+            }
+
+            bool at_end() const noexcept {
+                return m_pos == m_pattern.size();
+            }
+
+            char peek() const noexcept {
+                return m_pattern[m_pos];
+            }
+
+            std::size_t add_node(node_type type, std::size_t a = 0, std::size_t b = 0) {
+                m_nodes.push_back(node{type, a, b});
+                return m_nodes.size() - 1;
+            }
+
+            std::size_t add_set(const charset& set) {
+                m_sets.push_back(set);
+                return add_node(node_type::set, m_sets.size() - 1);
+            }
+
+            static charset range(unsigned char from, unsigned char to) {
+                charset set;
+                for (unsigned int c = from; c <= to; ++c) {
+                    set.set(c);
+                }
+                return set;
+            }
+
+            static charset digits() {
+                return range('0', '9');
+            }
+
+            static charset word_chars() {
+                return range('a', 'z') | range('A', 'Z') | digits() | range('_', '_');
+            }
+
+            static charset space_chars() {
+                return range('\t', '\r') | range(' ', ' ');
+            }
+
+            static int hex_value(char c) noexcept {
+                if (c >= '0' && c <= '9') {
+                    return c - '0';
+                }
+                if (c >= 'a' && c <= 'f') {
+                    return c - 'a' + 10;
+                }
+                if (c >= 'A' && c <= 'F') {
+                    return c - 'A' + 10;
+                }
+                return -1;
+            }
+
+            // Parse escape sequence after the backslash.
+            charset parse_escape() {
+                if (at_end()) {
+                    error("trailing backslash");
+                }
+                const char c = m_pattern[m_pos++];
+                switch (c) {
+                    case 'd': return digits();
+                    case 'D': return ~digits();
+                    case 'w': return word_chars();
+                    case 'W': return ~word_chars();
+                    case 's': return space_chars();
+                    case 'S': return ~space_chars();
+                    case 't': return range('\t', '\t');
+                    case 'n': return range('\n', '\n');
+                    case 'r': return range('\r', '\r');
+                    case 'f': return range('\f', '\f');
+                    case 'v': return range('\v', '\v');
+                    case '0': return range('\0', '\0');
+                    case 'x': {
+                        if (m_pos + 2 > m_pattern.size() || hex_value(m_pattern[m_pos]) < 0 || hex_value(m_pattern[m_pos + 1]) < 0) {
+                            error("invalid \\x escape");
+                        }
+                        const auto value = static_cast<unsigned char>(hex_value(m_pattern[m_pos]) * 16 + hex_value(m_pattern[m_pos + 1]));
+                        m_pos += 2;
+                        return range(value, value);
+                    }
+                    default:
+                        break;
+                }
+                if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+                    error("unsupported escape sequence");
+                }
+                const auto uc = static_cast<unsigned char>(c);
+                return range(uc, uc);
+            }
+
+            // Parse character class after the opening bracket.
+            charset parse_class() {
+                charset set;
+                bool negate = false;
+                if (!at_end() && peek() == '^') {
+                    negate = true;
+                    ++m_pos;
+                }
+                while (true) {
+                    if (at_end()) {
+                        error("missing ]");
+                    }
+                    char c = m_pattern[m_pos++];
+                    if (c == ']') {
+                        break;
+                    }
+                    charset item;
+                    bool single = true;
+                    if (c == '\\') {
+                        item = parse_escape();
+                        single = item.count() == 1;
+                        if (single) {
+                            for (unsigned int n = 0; n < 256; ++n) {
+                                if (item.test(n)) {
+                                    c = static_cast<char>(n);
+                                }
+                            }
+                        }
+                    } else {
+                        item = range(static_cast<unsigned char>(c), static_cast<unsigned char>(c));
+                    }
+                    if (single && m_pos + 1 < m_pattern.size() && peek() == '-' && m_pattern[m_pos + 1] != ']') {
+                        ++m_pos;
+                        char to = m_pattern[m_pos++];
+                        if (to == '\\') {
+                            const auto esc = parse_escape();
+                            if (esc.count() != 1) {
+                                error("invalid range in character class");
+                            }
+                            for (unsigned int n = 0; n < 256; ++n) {
+                                if (esc.test(n)) {
+                                    to = static_cast<char>(n);
+                                }
+                            }
+                        }
+                        if (static_cast<unsigned char>(to) < static_cast<unsigned char>(c)) {
+                            error("invalid range in character class");
+                        }
+                        item = range(static_cast<unsigned char>(c), static_cast<unsigned char>(to));
+                    }
+                    set |= item;
+                }
+                return negate ? ~set : set;
+            }
+
+            std::size_t parse_atom() {
+                const char c = m_pattern[m_pos++];
+                switch (c) {
+                    case '(': {
+                        if (!at_end() && peek() == '?') {
+                            if (m_pos + 1 < m_pattern.size() && m_pattern[m_pos + 1] == ':') {
+                                m_pos += 2;
+                            } else {
+                                error("unsupported group type");
+                            }
+                        }
+                        ++m_depth;
+                        const auto n = parse_alternative();
+                        if (at_end() || peek() != ')') {
+                            error("missing )");
+                        }
+                        --m_depth;
+                        ++m_pos;
+                        return n;
+                    }
+                    case '[':
+                        return add_set(parse_class());
+                    case '.':
+                        return add_set(~(range('\n', '\n') | range('\r', '\r')));
+                    case '\\':
+                        return add_set(parse_escape());
+                    case '^':
+                    case '$':
+                        --m_pos;
+                        error("anchors are only supported at the start and end of the pattern");
+                    case '*':
+                    case '+':
+                    case '?':
+                    case '{':
+                        --m_pos;
+                        error("nothing to repeat");
+                    default:
+                        break;
+                }
+                const auto uc = static_cast<unsigned char>(c);
+                return add_set(range(uc, uc));
+            }
+
+            int parse_number() {
+                int value = -1;
+                while (!at_end() && peek() >= '0' && peek() <= '9') {
+                    value = (value < 0 ? 0 : value * 10) + (peek() - '0');
+                    if (value > max_repeat) {
+                        error("repeat count too large");
+                    }
+                    ++m_pos;
+                }
+                return value;
+            }
+
+            std::size_t repeat(std::size_t n, int min, int max) {
+                std::size_t result = add_node(node_type::empty);
+                for (int i = 0; i < min; ++i) {
+                    result = add_node(node_type::concat, result, n);
+                }
+                if (max < 0) {
+                    return add_node(node_type::concat, result, add_node(node_type::star, n));
+                }
+                for (int i = min; i < max; ++i) {
+                    result = add_node(node_type::concat, result, add_node(node_type::optional, n));
+                }
+                return result;
+            }
+
+            std::size_t parse_repeat() {
+                auto n = parse_atom();
+                while (!at_end()) {
+                    const char c = peek();
+                    if (c == '*') {
+                        n = add_node(node_type::star, n);
+                    } else if (c == '+') {
+                        n = add_node(node_type::plus, n);
+                    } else if (c == '?') {
+                        n = add_node(node_type::optional, n);
+                    } else if (c == '{') {
+                        ++m_pos;
+                        const int min = parse_number();
+                        int max = min;
+                        if (min < 0) {
+                            error("invalid repeat");
+                        }
+                        if (!at_end() && peek() == ',') {
+                            ++m_pos;
+                            max = parse_number();
+                            if (max >= 0 && max < min) {
+                                error("invalid repeat");
+                            }
+                        }
+                        if (at_end() || peek() != '}') {
+                            error("invalid repeat");
+                        }
+                        n = repeat(n, min, max);
+                    } else {
+                        break;
+                    }
+                    ++m_pos;
+                    // Lazy quantifiers match the same strings.
+                    if (!at_end() && peek() == '?') {
+                        ++m_pos;
+                    }
+                }
+                return n;
+            }
+
+            std::size_t parse_concat() {
+                auto n = add_node(node_type::empty);
+                while (!at_end() && peek() != '|' && peek() != ')') {
+                    if (peek() == '$' && m_pos + 1 == m_pattern.size() && m_depth == 0) {
+                        m_anchored_end = true;
+                        ++m_pos;
+                        break;
+                    }
+                    n = add_node(node_type::concat, n, parse_repeat());
+                }
+                return n;
+            }
+
+            std::size_t parse_alternative() {
+                auto n = parse_concat();
+                while (!at_end() && peek() == '|') {
+                    if (m_depth == 0) {
+                        m_top_level_alternative = true;
+                    }
+                    ++m_pos;
+                    n = add_node(node_type::alternative, n, parse_concat());
+                }
+                return n;
+            }
+
+            std::size_t add_state() {
+                if (m_states.size() == max_nfa_states) {
+                    error("pattern too large");
+                }
+                m_states.emplace_back();
+                return m_states.size() - 1;
+            }
+
+            // Create states for the node, returns start and end state.
+            std::pair<std::size_t, std::size_t> build(std::size_t n) {
+                const auto nd = m_nodes[n];
+                switch (nd.type) {
+                    case node_type::empty: {
+                        const auto s = add_state();
+                        return {s, s};
+                    }
+                    case node_type::set: {
+                        const auto s = add_state();
+                        const auto e = add_state();
+                        m_states[s].set = static_cast<int>(nd.a);
+                        m_states[s].next = e;
+                        return {s, e};
+                    }
+                    case node_type::concat: {
+                        const auto x = build(nd.a);
+                        const auto y = build(nd.b);
+                        m_states[x.second].epsilon.push_back(y.first);
+                        return {x.first, y.second};
+                    }
+                    case node_type::alternative: {
+                        const auto x = build(nd.a);
+                        const auto y = build(nd.b);
+                        const auto s = add_state();
+                        const auto e = add_state();
+                        m_states[s].epsilon = {x.first, y.first};
+                        m_states[x.second].epsilon.push_back(e);
+                        m_states[y.second].epsilon.push_back(e);
+                        return {s, e};
+                    }
+                    case node_type::star:
+                    case node_type::plus:
+                    case node_type::optional: {
+                        const auto x = build(nd.a);
+                        const auto s = add_state();
+                        const auto e = add_state();
+                        m_states[s].epsilon.push_back(x.first);
+                        if (nd.type != node_type::plus) {
+                            m_states[s].epsilon.push_back(e);
+                        }
+                        if (nd.type != node_type::optional) {
+                            m_states[x.second].epsilon.push_back(x.first);
+                        }
+                        m_states[x.second].epsilon.push_back(e);
+                        return {s, e};
+                    }
+                }
+                return {0, 0};
+            }
+
+        public:
+
+            explicit regex_nfa_builder(const std::string& pattern) :
+                m_pattern(pattern) {
+            }
+
+            /**
+             * Parse the pattern and build the automaton.
+             *
+             * @param full_match Must the whole string match the pattern?
+             * @returns Pair of start and accepting state.
+             * @throws dfa_regex_error If the pattern can not be parsed.
+             */
+            std::pair<std::size_t, std::size_t> build_nfa(bool full_match) {
+                if (!at_end() && peek() == '^') {
+                    m_anchored_begin = true;
+                    ++m_pos;
+                }
+                const auto root = parse_alternative();
+                if (!at_end()) {
+                    error("unmatched )");
+                }
+                if ((m_anchored_begin || m_anchored_end) && m_top_level_alternative) {
+                    error("anchors can not be used with alternatives outside a group");
+                }
+                if (full_match) {
+                    m_anchored_begin = true;
+                    m_anchored_end = true;
+                }
+
+                auto result = build(root);
+                if (!m_anchored_begin) {
+                    // Search anywhere in the string: Loop on any character
+                    // before the start.
+                    const auto s = add_state();
+                    m_sets.push_back(~charset{});
+                    m_states[s].set = static_cast<int>(m_sets.size() - 1);
+                    m_states[s].next = s;
+                    m_states[s].epsilon.push_back(result.first);
+                    result.first = s;
+                }
+                return result;
+            }
+
+            bool anchored_end() const noexcept {
+                return m_anchored_end;
+            }
+
+            const std::vector<charset>& sets() const noexcept {
+                return m_sets;
+            }
+
+            const std::vector<state>& states() const noexcept {
+                return m_states;
+            }
+
+        }; // class regex_nfa_builder
+
+    } // namespace detail
+
+    /**
+     * Regular expression matcher using a deterministic finite automaton
+     * (DFA). The pattern is compiled into the DFA once in the constructor,
+     * matching needs only one table lookup per byte of the string and
+     * doesn't allocate any memory. This is much faster than std::regex.
+     *
+     * The supported syntax is a subset of the ECMAScript syntax used by
+     * std::regex: Literal characters, ".", character classes like "[a-z]"
+     * or "[^0-9]", the escapes \\d, \\D, \\w, \\W, \\s, \\S, \\t, \\n,
+     * \\r, \\f, \\v, \\0, and \\xHH, groups "(...)" and "(?:...)",
+     * alternatives "|", and the quantifiers "*", "+", "?", "{n}", "{n,}",
+     * and "{n,m}" (lazy versions are allowed but match the same strings).
+     * The anchors "^" and "$" are only supported at the very start and end
+     * of the pattern. Back references, lookaheads, and word boundaries are
+     * not supported. Matching works on bytes, not on UTF-8 characters.
+     */
+    class DFARegex {
+
+        enum : std::size_t {
+            max_states = 10000
+        };
+
+        // Number of different character classes.
+        std::size_t m_num_classes = 0;
+
+        // Character class of each byte. (This is not a std::array to keep
+        // the object small, it is often stored in a StringMatcher.)
+        std::vector<uint16_t> m_classes = std::vector<uint16_t>(256);
+
+        // Transition table, one row with m_num_classes entries for each
+        // state. State 0 is the dead state which never accepts.
+        std::vector<uint32_t> m_table{};
+
+        std::vector<uint8_t> m_accept{};
+
+        std::string m_pattern;
+
+        uint32_t m_start = 0;
+
+        // If this is false, we can stop as soon as we reach an accepting
+        // state.
+        bool m_anchored_end = false;
+
+        using state_set = std::vector<std::size_t>;
+
+        static void closure(const std::vector<detail::regex_nfa_builder::state>& states, state_set& set) {
+            std::vector<bool> seen(states.size());
+            std::vector<std::size_t> stack = set;
+            set.clear();
+            while (!stack.empty()) {
+                const auto s = stack.back();
+                stack.pop_back();
+                if (seen[s]) {
+                    continue;
+                }
+                seen[s] = true;
+                set.push_back(s);
+                for (const auto e : states[s].epsilon) {
+                    stack.push_back(e);
+                }
+            }
+            std::sort(set.begin(), set.end());
+        }
+
+        void compile(bool full_match) {
+            detail::regex_nfa_builder builder{m_pattern};
+            const auto nfa = builder.build_nfa(full_match);
+            m_anchored_end = builder.anchored_end();
+            const auto& sets = builder.sets();
+            const auto& states = builder.states();
+
+            // Bytes behaving the same in all character sets get the same
+            // class.
+            std::map<std::vector<bool>, uint16_t> class_ids;
+            std::array<unsigned char, 256> representative{};
+            for (unsigned int c = 0; c < 256; ++c) {
+                std::vector<bool> signature(sets.size());
+                for (std::size_t n = 0; n < sets.size(); ++n) {
+                    signature[n] = sets[n].test(c);
+                }
+                const auto r = class_ids.emplace(std::move(signature), static_cast<uint16_t>(class_ids.size()));
+                m_classes[c] = r.first->second;
+                if (r.second) {
+                    representative[r.first->second] = static_cast<unsigned char>(c);
+                }
+            }
+            m_num_classes = class_ids.size();
+
+            // Subset construction.
+            std::map<state_set, uint32_t> ids;
+            std::vector<state_set> todo;
+
+            const auto get_id = [&](state_set&& set) -> uint32_t {
+                const auto it = ids.find(set);
+                if (it != ids.end()) {
+                    return it->second;
+                }
+                if (ids.size() == max_states) {
+                    throw dfa_regex_error{"regex error: too many states needed for '" + m_pattern + "'"};
+                }
+                const auto id = static_cast<uint32_t>(ids.size());
+                m_accept.push_back(std::binary_search(set.begin(), set.end(), nfa.second) ? 1 : 0);
+                m_table.resize(m_table.size() + m_num_classes);
+                todo.push_back(set);
+                ids.emplace(std::move(set), id);
+                return id;
+            };
+
+            get_id(state_set{}); // dead state
+            state_set start{nfa.first};
+            closure(states, start);
+            m_start = get_id(std::move(start));
+
+            for (std::size_t id = 1; id < todo.size(); ++id) {
+                const state_set current = todo[id];
+                if (m_accept[id] != 0 && !m_anchored_end) {
+                    // We are done once an accepting state is reached.
+                    continue;
+                }
+                for (std::size_t cls = 0; cls < m_num_classes; ++cls) {
+                    state_set next;
+                    for (const auto s : current) {
+                        const auto set = states[s].set;
+                        if (set >= 0 && sets[static_cast<std::size_t>(set)].test(representative[cls])) {
+                            next.push_back(states[s].next);
+                        }
+                    }
+                    closure(states, next);
+                    const auto target = get_id(std::move(next));
+                    m_table[id * m_num_classes + cls] = target;
+                }
+            }
+        }
+
+    public:
+
+        /**
+         * Compile a regular expression.
+         *
+         * @param pattern The regular expression.
+         * @param full_match If this is true, the whole string has to
+         *                   match the pattern (like std::regex_match()).
+         *                   Otherwise any substring of the string can
+         *                   match (like std::regex_search()).
+         * @throws dfa_regex_error If the pattern is invalid or uses
+         *         unsupported features or needs too many states.
+         */
+        explicit DFARegex(std::string pattern, bool full_match = false) :
+            m_pattern(std::move(pattern)) {
+            compile(full_match);
+        }
+
+        /// The pattern this regex was created from.
+        const std::string& pattern() const noexcept {
+            return m_pattern;
+        }
+
+        /// The number of states in the DFA (including the dead state).
+        std::size_t count_states() const noexcept {
+            return m_accept.size();
+        }
+
+        /**
+         * Match the specified string.
+         *
+         * @returns true if the string matches.
+         */
+        bool operator()(const char* str) const noexcept {
+            uint32_t state = m_start;
+            if (m_anchored_end) {
+                for (; *str != '\0' && state != 0; ++str) {
+                    state = m_table[state * m_num_classes + m_classes[static_cast<unsigned char>(*str)]];
+                }
+                return m_accept[state] != 0;
+            }
+
+            for (; *str != '\0'; ++str) {
+                if (m_accept[state] != 0) {
+                    return true;
+                }
+                state = m_table[state * m_num_classes + m_classes[static_cast<unsigned char>(*str)]];
+                if (state == 0) {
+                    return false;
+                }
+            }
+            return m_accept[state] != 0;
+        }
+
+        /**
+         * Match the specified string.
+         *
+         * @returns true if the string matches.
+         */
+        bool operator()(const std::string& str) const noexcept {
+            return operator()(str.c_str());
+        }
+
+    }; // class DFARegex
+
+} // namespace osmium
+
+#endif // OSMIUM_UTIL_DFA_REGEX_HPP
@@ -33,6 +33,10 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/util/aho_corasick.hpp>
+#include <osmium/util/dfa_regex.hpp>
+#include <osmium/util/string_set.hpp>
+
 #include <boost/variant.hpp>
 
 #include <algorithm>
@@ -132,6 +136,10 @@ namespace osmium {
                 m_str(str) {
             }
 
+            const std::string& str() const noexcept {
+                return m_str;
+            }
+
             bool match(const char* test_string) const noexcept {
                 return !std::strcmp(m_str.c_str(), test_string);
             }
@@ -160,6 +168,10 @@ namespace osmium {
                 m_str(str) {
             }
 
+            const std::string& str() const noexcept {
+                return m_str;
+            }
+
             bool match(const char* test_string) const noexcept {
                 return m_str.compare(0, std::string::npos, test_string, 0, m_str.size()) == 0;
             }
@@ -225,6 +237,40 @@ namespace osmium {
         }; // class regex
 #endif
 
+        /**
+         * Matches if the test string matches the regular expression. Uses
+         * osmium::DFARegex, which is much faster than std::regex, but only
+         * supports a subset of the regular expression syntax.
+         */
+        class dfa_regex : public matcher {
+
+            osmium::DFARegex m_regex;
+
+        public:
+
+            explicit dfa_regex(osmium::DFARegex regex) :
+                m_regex(std::move(regex)) {
+            }
+
+            explicit dfa_regex(const std::string& pattern) :
+                m_regex(pattern) {
+            }
+
+            explicit dfa_regex(const char* pattern) :
+                m_regex(pattern) {
+            }
+
+            bool match(const char* test_string) const noexcept {
+                return m_regex(test_string);
+            }
+
+            template <typename TChar, typename TTraits>
+            void print(std::basic_ostream<TChar, TTraits>& out) const {
+                out << "dfa_regex[" << m_regex.pattern() << ']';
+            }
+
+        }; // class dfa_regex
+
         /**
          * Matches if the test string is equal to any of the stored strings.
          */
@@ -250,6 +296,10 @@ namespace osmium {
                 return *this;
             }
 
+            const std::vector<std::string>& strings() const noexcept {
+                return m_strings;
+            }
+
             bool match(const char* test_string) const noexcept {
                 return std::any_of(m_strings.cbegin(), m_strings.cend(),
                                    [&test_string](const std::string& s){
@@ -268,6 +318,79 @@ namespace osmium {
 
         }; // class list
 
+        /**
+         * Matches if the test string is equal to any of the stored strings.
+         * Like list, but uses a hash set, so the time needed for matching
+         * does not depend on the number of strings. Use this for long
+         * lists of strings.
+         */
+        class string_set : public matcher {
+
+            std::vector<std::string> m_strings;
+            osmium::StringSet m_set;
+
+        public:
+
+            explicit string_set(std::vector<std::string> strings) :
+                m_strings(std::move(strings)),
+                m_set(m_strings) {
+            }
+
+            const std::vector<std::string>& strings() const noexcept {
+                return m_strings;
+            }
+
+            bool match(const char* test_string) const noexcept {
+                return m_set.contains(test_string);
+            }
+
+            template <typename TChar, typename TTraits>
+            void print(std::basic_ostream<TChar, TTraits>& out) const {
+                out << "string_set[";
+                for (const auto& s : m_strings) {
+                    out << '[' << s << ']';
+                }
+                out << ']';
+            }
+
+        }; // class string_set
+
+        /**
+         * Matches if any of the stored strings is a substring of the test
+         * string. Uses the Aho-Corasick algorithm, so the time needed for
+         * matching does not depend on the number of strings.
+         */
+        class substrings : public matcher {
+
+            std::vector<std::string> m_strings;
+            osmium::AhoCorasick m_automaton;
+
+        public:
+
+            explicit substrings(std::vector<std::string> strings) :
+                m_strings(std::move(strings)),
+                m_automaton(m_strings) {
+            }
+
+            const std::vector<std::string>& strings() const noexcept {
+                return m_strings;
+            }
+
+            bool match(const char* test_string) const noexcept {
+                return m_automaton(test_string);
+            }
+
+            template <typename TChar, typename TTraits>
+            void print(std::basic_ostream<TChar, TTraits>& out) const {
+                out << "substrings[";
+                for (const auto& s : m_strings) {
+                    out << '[' << s << ']';
+                }
+                out << ']';
+            }
+
+        }; // class substrings
+
     private:
 
         using matcher_type = boost::variant<always_false,
@@ -278,7 +401,10 @@ namespace osmium {
 #ifdef OSMIUM_WITH_REGEX
                                             regex,
 #endif
-                                            list>;
+                                            dfa_regex,
+                                            list,
+                                            string_set,
+                                            substrings>;
 
         matcher_type m_matcher;
 
@@ -390,7 +516,8 @@ namespace osmium {
          *
          * @tparam TMatcher Must be one of the matcher classes
          *                  osmium::StringMatcher::always_false, always_true,
-         *                  equal, prefix, substring, regex or list.
+         *                  equal, prefix, substring, regex, dfa_regex,
+         *                  list, string_set, or substrings.
          */
         // cppcheck-suppress noExplicitConstructor
         template <typename TMatcher, typename X = typename std::enable_if<
@@ -399,6 +526,22 @@ namespace osmium {
             m_matcher(std::forward<TMatcher>(matcher)) {
         }
 
+        /**
+         * Access the matcher of the specified type inside this
+         * StringMatcher.
+         *
+         * @tparam TMatcher One of the matcher classes
+         *                  osmium::StringMatcher::always_false, always_true,
+         *                  equal, prefix, substring, regex, dfa_regex,
+         *                  list, string_set, or substrings.
+         * @returns A pointer to the matcher or nullptr if this
+         *          StringMatcher uses a different type of matcher.
+         */
+        template <typename TMatcher>
+        const TMatcher* get_if() const noexcept {
+            return boost::get<TMatcher>(&m_matcher);
+        }
+
         /**
          * Match the specified string.
          */
@@ -0,0 +1,244 @@
+#ifndef OSMIUM_UTIL_STRING_POOL_HPP
+#define OSMIUM_UTIL_STRING_POOL_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * A pool of interned strings. Each different string added to the pool
+     * gets a unique 32 bit id. Comparing ids is much cheaper than comparing
+     * strings, so this can be used for instance to group or filter objects
+     * by tags.
+     *
+     * The pool is thread safe. It is split into shards by the hash of the
+     * strings, each shard has its own lock, so several threads can add
+     * strings at the same time without much contention. Ids are not dense,
+     * they encode the shard.
+     *
+     * Strings are never removed from the pool. Pointers returned by get()
+     * stay valid as long as the pool exists.
+     */
+    class StringPool {
+
+        enum : uint32_t {
+            shard_bits = 6,
+            num_shards = 1U << shard_bits,
+            max_per_shard = 1U << (32U - shard_bits)
+        };
+
+        struct shard {
+            mutable std::mutex mutex{};
+
+            // Strings in the order they were added. A deque doesn't move
+            // its elements, so pointers to them stay valid.
+            std::deque<std::string> strings{};
+
+            std::vector<uint64_t> hashes{};
+
+            // Open addressing hash table containing index + 1 into strings
+            // or 0 for empty slots. The size is a power of two.
+            std::vector<uint32_t> table = std::vector<uint32_t>(16);
+        };
+
+        std::array<shard, num_shards> m_shards{};
+
+        static uint64_t hash(const char* data, std::size_t length) noexcept {
+            uint64_t h = 0xcbf29ce484222325ULL;
+            for (std::size_t n = 0; n < length; ++n) {
+                h = (h ^ static_cast<unsigned char>(data[n])) * 0x100000001b3ULL;
+            }
+            return h;
+        }
+
+        static uint32_t shard_of(uint64_t h) noexcept {
+            return static_cast<uint32_t>(h >> (64U - shard_bits));
+        }
+
+        // Find slot in table of the shard with the specified string or an
+        // empty slot where it should go. Must be called with the lock held.
+        static std::size_t find_slot(const shard& s, const char* data, std::size_t length, uint64_t h) noexcept {
+            const auto mask = s.table.size() - 1;
+            for (auto pos = static_cast<std::size_t>(h) & mask;; pos = (pos + 1) & mask) {
+                const auto entry = s.table[pos];
+                if (entry == 0) {
+                    return pos;
+                }
+                const auto& str = s.strings[entry - 1];
+                if (s.hashes[entry - 1] == h && str.size() == length &&
+                    std::memcmp(str.data(), data, length) == 0) {
+                    return pos;
+                }
+            }
+        }
+
+        static void grow(shard& s) {
+            std::vector<uint32_t> table(s.table.size() * 2);
+            const auto mask = table.size() - 1;
+            for (std::size_t n = 0; n < s.hashes.size(); ++n) {
+                auto pos = static_cast<std::size_t>(s.hashes[n]) & mask;
+                while (table[pos] != 0) {
+                    pos = (pos + 1) & mask;
+                }
+                table[pos] = static_cast<uint32_t>(n + 1);
+            }
+            s.table = std::move(table);
+        }
+
+    public:
+
+        /// Returned from find() if the string is not in the pool.
+        enum : uint32_t {
+            invalid_id = std::numeric_limits<uint32_t>::max()
+        };
+
+        StringPool() = default;
+
+        StringPool(const StringPool&) = delete;
+        StringPool& operator=(const StringPool&) = delete;
+
+        StringPool(StringPool&&) = delete;
+        StringPool& operator=(StringPool&&) = delete;
+
+        ~StringPool() noexcept = default;
+
+        /**
+         * Add a string to the pool if it isn't in there already.
+         *
+         * @param data Pointer to the string data.
+         * @param length Length of the string.
+         * @returns The id of the string.
+         * @throws std::length_error If there are too many strings.
+         */
+        uint32_t add(const char* data, std::size_t length) {
+            const auto h = hash(data, length);
+            const auto n = shard_of(h);
+            auto& s = m_shards[n];
+
+            std::lock_guard<std::mutex> lock{s.mutex};
+            auto pos = find_slot(s, data, length, h);
+            if (s.table[pos] == 0) {
+                if (s.strings.size() + 1 == max_per_shard) {
+                    throw std::length_error{"too many strings in StringPool"};
+                }
+                s.strings.emplace_back(data, length);
+                s.hashes.push_back(h);
+                if (s.strings.size() * 2 > s.table.size()) {
+                    grow(s);
+                    pos = find_slot(s, data, length, h);
+                }
+                s.table[pos] = static_cast<uint32_t>(s.strings.size());
+            }
+            return ((s.table[pos] - 1) << shard_bits) | n;
+        }
+
+        /**
+         * Add a string to the pool if it isn't in there already.
+         *
+         * @returns The id of the string.
+         */
+        uint32_t add(const char* str) {
+            return add(str, std::strlen(str));
+        }
+
+        /**
+         * Add a string to the pool if it isn't in there already.
+         *
+         * @returns The id of the string.
+         */
+        uint32_t add(const std::string& str) {
+            return add(str.data(), str.size());
+        }
+
+        /**
+         * Find the id of a string without adding it.
+         *
+         * @returns The id of the string or invalid_id if it is not in the
+         *          pool.
+         */
+        uint32_t find(const char* str) const {
+            const auto length = std::strlen(str);
+            const auto h = hash(str, length);
+            const auto n = shard_of(h);
+            const auto& s = m_shards[n];
+
+            std::lock_guard<std::mutex> lock{s.mutex};
+            const auto entry = s.table[find_slot(s, str, length, h)];
+            if (entry == 0) {
+                return invalid_id;
+            }
+            return ((entry - 1) << shard_bits) | n;
+        }
+
+        /**
+         * Get the string with the specified id.
+         *
+         * @pre id must have been returned by add() on this pool.
+         */
+        const char* get(uint32_t id) const {
+            const auto& s = m_shards[id & (num_shards - 1)];
+            std::lock_guard<std::mutex> lock{s.mutex};
+            return s.strings[id >> shard_bits].c_str();
+        }
+
+        /**
+         * The number of strings in the pool.
+         *
+         * Complexity: Linear in the number of shards.
+         */
+        std::size_t size() const {
+            std::size_t count = 0;
+            for (const auto& s : m_shards) {
+                std::lock_guard<std::mutex> lock{s.mutex};
+                count += s.strings.size();
+            }
+            return count;
+        }
+
+    }; // class StringPool
+
+} // namespace osmium
+
+#endif // OSMIUM_UTIL_STRING_POOL_HPP
@@ -0,0 +1,172 @@
+#ifndef OSMIUM_UTIL_STRING_SET_HPP
+#define OSMIUM_UTIL_STRING_SET_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * An immutable set of strings for fast lookups. The strings are stored
+     * in a hash table with open addressing which is built once in the
+     * constructor. Lookups don't allocate any memory, the test string is
+     * hashed and measured in a single pass.
+     */
+    class StringSet {
+
+        struct entry {
+            uint64_t hash;
+            uint32_t offset;
+            uint32_t length;
+            uint32_t index;
+        };
+
+        enum : uint32_t {
+            empty_slot = std::numeric_limits<uint32_t>::max()
+        };
+
+        // All strings one after the other.
+        std::string m_data{};
+
+        // Hash table, the size is a power of two.
+        std::vector<entry> m_table{};
+
+        std::size_t m_size = 0;
+
+        static uint64_t hash(const char* str, std::size_t* length) noexcept {
+            uint64_t h = 0xcbf29ce484222325ULL;
+            const char* p = str;
+            for (; *p != '\0'; ++p) {
+                h = (h ^ static_cast<unsigned char>(*p)) * 0x100000001b3ULL;
+            }
+            *length = static_cast<std::size_t>(p - str);
+            return h;
+        }
+
+    public:
+
+        /// Returned from find() if the string is not in the set.
+        enum : std::size_t {
+            npos = std::numeric_limits<std::size_t>::max()
+        };
+
+        /// Create an empty set.
+        StringSet() = default;
+
+        /**
+         * Create a set from the specified strings. Duplicates are allowed.
+         * The strings must not contain a 0 byte.
+         */
+        explicit StringSet(const std::vector<std::string>& strings) {
+            std::size_t size = 4;
+            while (size < strings.size() * 2) {
+                size *= 2;
+            }
+            m_table.assign(size, entry{0, 0, 0, empty_slot});
+
+            for (std::size_t n = 0; n < strings.size(); ++n) {
+                if (find(strings[n].c_str()) != npos) {
+                    continue;
+                }
+                std::size_t length = 0;
+                const auto h = hash(strings[n].c_str(), &length);
+                auto pos = static_cast<std::size_t>(h) & (size - 1);
+                while (m_table[pos].index != empty_slot) {
+                    pos = (pos + 1) & (size - 1);
+                }
+                m_table[pos] = entry{h,
+                                     static_cast<uint32_t>(m_data.size()),
+                                     static_cast<uint32_t>(length),
+                                     static_cast<uint32_t>(n)};
+                m_data.append(strings[n].c_str(), length);
+                ++m_size;
+            }
+        }
+
+        /// The number of different strings in the set.
+        std::size_t size() const noexcept {
+            return m_size;
+        }
+
+        /// Is the set empty?
+        bool empty() const noexcept {
+            return m_size == 0;
+        }
+
+        /**
+         * Look up a string.
+         *
+         * @returns The index of the (first) string equal to the test string
+         *          in the vector the set was created from, or npos if the
+         *          string is not in the set.
+         */
+        std::size_t find(const char* str) const noexcept {
+            if (m_table.empty()) {
+                return npos;
+            }
+            std::size_t length = 0;
+            const auto h = hash(str, &length);
+            const auto mask = m_table.size() - 1;
+            for (auto pos = static_cast<std::size_t>(h) & mask;; pos = (pos + 1) & mask) {
+                const auto& e = m_table[pos];
+                if (e.index == empty_slot) {
+                    return npos;
+                }
+                if (e.hash == h && e.length == length &&
+                    std::memcmp(m_data.data() + e.offset, str, length) == 0) {
+                    return e.index;
+                }
+            }
+        }
+
+        /// Is the string in the set?
+        bool contains(const char* str) const noexcept {
+            return find(str) != npos;
+        }
+
+        /// Is the string in the set?
+        bool contains(const std::string& str) const noexcept {
+            return find(str.c_str()) != npos;
+        }
+
+    }; // class StringSet
+
+} // namespace osmium
+
+#endif // OSMIUM_UTIL_STRING_SET_HPP
@@ -0,0 +1,116 @@
+#include "catch.hpp"
+
+#include <osmium/area/area_cache.hpp>
+#include <osmium/area/assembler.hpp>
+#include <osmium/builder/attr.hpp>
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/util/file.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+static osmium::memory::Buffer create_ways() {
+    osmium::memory::Buffer buffer{10240, osmium::memory::Buffer::auto_grow::yes};
+    for (int i = 0; i < 10; ++i) {
+        const double x = i * 0.1;
+        const osmium::object_id_type n = i * 4 + 1;
+        const std::vector<osmium::NodeRef> nodes = {
+            {n,     {x,        1.0}},
+            {n + 1, {x + 0.05, 1.0}},
+            {n + 2, {x + 0.05, 1.05}},
+            {n + 3, {x,        1.05}},
+            {n,     {x,        1.0}}
+        };
+        osmium::builder::add_way(buffer, _id(i + 1), _version(1), _nodes(nodes), _tag("building", "yes"));
+    }
+    return buffer;
+}
+
+TEST_CASE("Area fingerprint depends on input") {
+    auto buffer = create_ways();
+    auto& way = *buffer.select<osmium::Way>().begin();
+
+    const auto fingerprint = osmium::area::area_fingerprint(way);
+    REQUIRE(fingerprint == osmium::area::area_fingerprint(way));
+
+    const auto ways = create_ways();
+    const auto& other_way = *std::next(ways.select<osmium::Way>().begin());
+    REQUIRE(fingerprint != osmium::area::area_fingerprint(other_way));
+
+    way.nodes()[1].set_location(osmium::Location{0.06, 1.0});
+    REQUIRE(fingerprint != osmium::area::area_fingerprint(way));
+}
+
+TEST_CASE("Write areas to cache file and read them back") {
+    const auto ways = create_ways();
+
+    const osmium::area::AssemblerConfig config;
+    osmium::area::Assembler assembler{config};
+    osmium::memory::Buffer areas{10240, osmium::memory::Buffer::auto_grow::yes};
+    for (const auto& way : ways.select<osmium::Way>()) {
+        REQUIRE(assembler(way, areas));
+    }
+
+    const int fd = osmium::detail::create_tmp_file();
+    {
+        osmium::area::AreaCacheWriter writer{fd};
+        for (const auto& area : areas.select<osmium::Area>()) {
+            writer.add(area, static_cast<uint64_t>(area.id()) * 1000);
+        }
+        REQUIRE(writer.size() == 10);
+        writer.close();
+    }
+
+    const osmium::area::AreaCache cache{fd};
+    REQUIRE(cache.size() == 10);
+    REQUIRE_FALSE(cache.empty());
+
+    for (const auto& area : areas.select<osmium::Area>()) {
+        const auto fingerprint = static_cast<uint64_t>(area.id()) * 1000;
+        const osmium::Area* cached = cache.get(area.id(), fingerprint);
+        REQUIRE(cached);
+        REQUIRE(cached->byte_size() == area.byte_size());
+        REQUIRE(std::equal(cached->data(), cached->data() + cached->byte_size(), area.data()));
+
+        REQUIRE(cache.get(area.id(), fingerprint + 1) == nullptr);
+    }
+
+    REQUIRE(cache.get(1, 1000) == nullptr);
+    REQUIRE(cache.get(1000, 1000000) == nullptr);
+}
+
+TEST_CASE("Reading something that is not an area cache file") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    SECTION("empty file") {
+        REQUIRE_THROWS_AS(osmium::area::AreaCache{fd}, const std::runtime_error&);
+    }
+
+    SECTION("wrong magic") {
+        const char data[] = "NOTACACHEFILE";
+        osmium::io::detail::reliable_write(fd, data, sizeof(data));
+        REQUIRE_THROWS_AS(osmium::area::AreaCache{fd}, const std::runtime_error&);
+    }
+
+    SECTION("truncated file") {
+        {
+            osmium::area::AreaCacheWriter writer{fd};
+            const auto ways = create_ways();
+            const osmium::area::AssemblerConfig config;
+            osmium::area::Assembler assembler{config};
+            osmium::memory::Buffer areas{10240, osmium::memory::Buffer::auto_grow::yes};
+            REQUIRE(assembler(*ways.select<osmium::Way>().begin(), areas));
+            writer.add(*areas.select<osmium::Area>().begin(), 1);
+        }
+        REQUIRE(osmium::file_size(fd) > 32);
+        osmium::resize_file(fd, osmium::file_size(fd) - 8);
+        REQUIRE_THROWS_AS(osmium::area::AreaCache{fd}, const std::runtime_error&);
+    }
+}
@@ -1,9 +1,18 @@
 #include "catch.hpp"
 
 #include <osmium/area/assembler.hpp>
+#include <osmium/area/problem_reporter.hpp>
 #include <osmium/builder/attr.hpp>
+#include <osmium/builder/osm_object_builder.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/area.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
 
 using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
 
@@ -141,3 +150,251 @@ TEST_CASE("Build area from way with ignored invalid location") {
     REQUIRE(s.invalid_locations == 1);
 }
 
+
+static void add_square(osmium::memory::Buffer& buffer, osmium::object_id_type id, double x, double y, double size) {
+    const osmium::object_id_type n = id * 10;
+    const std::vector<osmium::NodeRef> nodes = {
+        {n,     {x,        y}},
+        {n + 1, {x + size, y}},
+        {n + 2, {x + size, y + size}},
+        {n + 3, {x,        y + size}},
+        {n,     {x,        y}}
+    };
+    osmium::builder::add_way(buffer, _id(id), _nodes(nodes));
+}
+
+static const osmium::Relation& add_multipolygon(osmium::memory::Buffer& buffer, osmium::object_id_type id, const std::vector<osmium::object_id_type>& way_ids) {
+    {
+        osmium::builder::RelationBuilder builder{buffer};
+        builder.set_id(id);
+        {
+            osmium::builder::RelationMemberListBuilder members_builder{builder};
+            for (const auto way_id : way_ids) {
+                members_builder.add_member(osmium::item_type::way, way_id, "");
+            }
+        }
+        {
+            osmium::builder::TagListBuilder tags_builder{builder};
+            tags_builder.add_tag("type", "multipolygon");
+        }
+    }
+    return buffer.get<osmium::Relation>(buffer.commit());
+}
+
+static std::vector<const osmium::Way*> member_ways(const osmium::memory::Buffer& buffer, const osmium::Relation& relation) {
+    std::vector<const osmium::Way*> ways;
+    for (const auto& member : relation.members()) {
+        for (const auto& way : buffer.select<osmium::Way>()) {
+            if (way.id() == member.ref()) {
+                ways.push_back(&way);
+            }
+        }
+    }
+    return ways;
+}
+
+TEST_CASE("Build area from relation with many inner rings and islands") {
+    // One large outer ring containing a grid of inner rings. Every third
+    // inner ring contains an island (another outer ring).
+    const int grid = 20;
+
+    osmium::memory::Buffer buffer{1024 * 1024};
+    std::vector<osmium::object_id_type> way_ids;
+    osmium::object_id_type id = 1;
+
+    add_square(buffer, id, 0.0, 0.0, grid + 1.0);
+    way_ids.push_back(id++);
+
+    int islands = 0;
+    for (int i = 0; i < grid; ++i) {
+        for (int j = 0; j < grid; ++j) {
+            add_square(buffer, id, i + 1.0, j + 1.0, 0.5);
+            way_ids.push_back(id++);
+            if ((i * grid + j) % 3 == 0) {
+                add_square(buffer, id, i + 1.1, j + 1.1, 0.3);
+                way_ids.push_back(id++);
+                ++islands;
+            }
+        }
+    }
+
+    const auto& relation = add_multipolygon(buffer, 1, way_ids);
+    const auto ways = member_ways(buffer, relation);
+
+    osmium::area::AssemblerConfig config;
+    osmium::area::Assembler assembler{config};
+
+    osmium::memory::Buffer area_buffer{1024 * 1024};
+    REQUIRE(assembler(relation, ways, area_buffer));
+
+    const auto& area = area_buffer.get<osmium::Area>(0);
+    REQUIRE_FALSE(area.from_way());
+
+    const auto num_rings = area.num_rings();
+    REQUIRE(num_rings.first == static_cast<std::size_t>(1 + islands));
+    REQUIRE(num_rings.second == static_cast<std::size_t>(grid * grid));
+
+    for (const auto& outer : area.outer_rings()) {
+        const auto inners = area.inner_rings(outer);
+        const auto num_inner = std::distance(inners.begin(), inners.end());
+        if (outer.front().ref() / 10 == 1) {
+            REQUIRE(num_inner == grid * grid);
+        } else {
+            REQUIRE(num_inner == 0);
+        }
+    }
+}
+
+TEST_CASE("Reuse assembler for several objects") {
+    osmium::memory::Buffer buffer{1024 * 1024};
+
+    // A simple relation with an inner ring.
+    add_square(buffer, 1, 1.0, 1.0, 4.0);
+    add_square(buffer, 2, 2.0, 2.0, 1.0);
+    const auto& simple = add_multipolygon(buffer, 1, {1, 2});
+
+    // Two outer rings touching in one point, this needs the complex case.
+    const std::vector<osmium::NodeRef> nodes = {
+        {30, {1.0, 1.0}},
+        {31, {2.0, 1.0}},
+        {32, {2.0, 2.0}},
+        {33, {3.0, 2.0}},
+        {34, {3.0, 3.0}},
+        {35, {2.0, 3.0}},
+        {32, {2.0, 2.0}},
+        {36, {1.0, 2.0}},
+        {30, {1.0, 1.0}}
+    };
+    osmium::builder::add_way(buffer, _id(3), _nodes(nodes));
+    const auto& touching = add_multipolygon(buffer, 2, {3});
+
+    const auto simple_ways = member_ways(buffer, simple);
+    const auto touching_ways = member_ways(buffer, touching);
+
+    osmium::area::AssemblerConfig config;
+
+    // Build all areas with new assemblers...
+    osmium::memory::Buffer expected{10240, osmium::memory::Buffer::auto_grow::yes};
+    std::vector<osmium::area::area_stats> expected_stats;
+    for (int n = 0; n < 2; ++n) {
+        {
+            osmium::area::Assembler assembler{config};
+            REQUIRE(assembler(touching, touching_ways, expected));
+            expected_stats.push_back(assembler.stats());
+        }
+        {
+            osmium::area::Assembler assembler{config};
+            REQUIRE(assembler(simple, simple_ways, expected));
+            expected_stats.push_back(assembler.stats());
+        }
+        {
+            osmium::area::Assembler assembler{config};
+            REQUIRE(assembler(*simple_ways[1], expected));
+        }
+    }
+
+    // ...and with the same assembler. The result must be the same.
+    osmium::memory::Buffer reused{10240, osmium::memory::Buffer::auto_grow::yes};
+    osmium::area::Assembler assembler{config};
+    for (int n = 0; n < 2; ++n) {
+        REQUIRE(assembler(touching, touching_ways, reused));
+        REQUIRE(assembler.stats().area_touching_rings_case == 1);
+        REQUIRE(assembler.stats().outer_rings == expected_stats[n * 2].outer_rings);
+        REQUIRE(assembler(simple, simple_ways, reused));
+        REQUIRE(assembler.stats().area_simple_case == 1);
+        REQUIRE(assembler.stats().nodes == expected_stats[n * 2 + 1].nodes);
+        REQUIRE(assembler.stats().inner_rings == 1);
+        REQUIRE(assembler(*simple_ways[1], reused));
+        REQUIRE(assembler.stats().from_ways == 1);
+        REQUIRE(assembler.stats().from_relations == 0);
+    }
+
+    REQUIRE(reused.committed() == expected.committed());
+    REQUIRE(std::equal(reused.data(), reused.data() + reused.committed(), expected.data()));
+}
+
+namespace {
+
+    class AbortRecorder : public osmium::area::ProblemReporter {
+
+    public:
+
+        int count = 0;
+        uint64_t work = 0;
+
+        void report_assembly_aborted(uint64_t w, uint64_t /*time_us*/) override {
+            ++count;
+            work = w;
+        }
+
+    }; // class AbortRecorder
+
+} // anonymous namespace
+
+TEST_CASE("Assembler work budget") {
+    // One outer ring containing a grid of inner rings.
+    const int grid = 10;
+
+    osmium::memory::Buffer buffer{1024 * 1024};
+    std::vector<osmium::object_id_type> way_ids;
+    osmium::object_id_type id = 1;
+
+    add_square(buffer, id, 0.0, 0.0, grid + 1.0);
+    way_ids.push_back(id++);
+    for (int i = 0; i < grid; ++i) {
+        for (int j = 0; j < grid; ++j) {
+            add_square(buffer, id, i + 1.0, j + 1.0, 0.5);
+            way_ids.push_back(id++);
+        }
+    }
+
+    const auto& relation = add_multipolygon(buffer, 1, way_ids);
+    const auto ways = member_ways(buffer, relation);
+
+    AbortRecorder recorder;
+    osmium::area::AssemblerConfig config;
+    config.problem_reporter = &recorder;
+
+    uint64_t work_needed = 0;
+    {
+        osmium::area::Assembler assembler{config};
+        osmium::memory::Buffer area_buffer{1024 * 1024};
+        REQUIRE(assembler(relation, ways, area_buffer));
+
+        const auto& s = assembler.stats();
+        REQUIRE(s.aborted == 0);
+        REQUIRE(s.segments == 4 * (1 + grid * grid));
+        REQUIRE(s.work > 0);
+        REQUIRE(recorder.count == 0);
+        work_needed = s.work;
+    }
+
+    SECTION("budget large enough") {
+        config.max_work = work_needed;
+        config.max_time = std::chrono::hours{1};
+        osmium::area::Assembler assembler{config};
+        osmium::memory::Buffer area_buffer{1024 * 1024};
+        REQUIRE(assembler(relation, ways, area_buffer));
+
+        REQUIRE(assembler.stats().aborted == 0);
+        REQUIRE(assembler.stats().work == work_needed);
+        REQUIRE(area_buffer.get<osmium::Area>(0).num_rings().second == grid * grid);
+        REQUIRE(recorder.count == 0);
+    }
+
+    SECTION("budget too small") {
+        config.max_work = work_needed / 2;
+        osmium::area::Assembler assembler{config};
+        osmium::memory::Buffer area_buffer{1024 * 1024};
+
+        // The area is created, but it is empty.
+        REQUIRE(assembler(relation, ways, area_buffer));
+        const auto& area = area_buffer.get<osmium::Area>(0);
+        REQUIRE(area.num_rings().first == 0);
+        REQUIRE(area.num_rings().second == 0);
+
+        REQUIRE(assembler.stats().aborted == 1);
+        REQUIRE(recorder.count == 1);
+        REQUIRE(recorder.work > work_needed / 2);
+    }
+}
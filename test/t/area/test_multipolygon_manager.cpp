@@ -0,0 +1,213 @@
+#include "catch.hpp"
+
+#include <osmium/area/area_cache.hpp>
+#include <osmium/area/assembler.hpp>
+#include <osmium/area/multipolygon_manager.hpp>
+#include <osmium/builder/attr.hpp>
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+// Creates a grid of closed ways. Every third way is untagged and the
+// outer way of a multipolygon relation, all others are tagged buildings.
+static osmium::memory::Buffer create_test_data() {
+    osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+
+    const int num_ways = 20000;
+    for (int i = 0; i < num_ways; ++i) {
+        const double x = (i % 200) * 0.01;
+        const double y = (i / 200) * 0.01; // NOLINT(bugprone-integer-division)
+        const osmium::object_id_type n = i * 4 + 1;
+        const std::vector<osmium::NodeRef> nodes = {
+            {n,     {x,         y}},
+            {n + 1, {x + 0.005, y}},
+            {n + 2, {x + 0.005, y + 0.005}},
+            {n + 3, {x,         y + 0.005}},
+            {n,     {x,         y}}
+        };
+        if (i % 3 == 0) {
+            osmium::builder::add_way(buffer, _id(i + 1), _nodes(nodes));
+        } else {
+            osmium::builder::add_way(buffer, _id(i + 1), _nodes(nodes), _tag("building", "yes"));
+        }
+    }
+
+    for (int i = 0; i < num_ways; i += 3) {
+        osmium::builder::add_relation(buffer,
+            _id(i + 1),
+            _member(osmium::item_type::way, i + 1, "outer"),
+            _tag("type", "multipolygon"),
+            _tag("landuse", "grass")
+        );
+    }
+
+    return buffer;
+}
+
+using manager_type = osmium::area::MultipolygonManager<osmium::area::Assembler>;
+
+static osmium::memory::Buffer run_manager(manager_type& manager, const osmium::memory::Buffer& input) {
+    for (const auto& relation : input.select<osmium::Relation>()) {
+        manager.relation(relation);
+    }
+    manager.prepare_for_lookup();
+
+    auto& handler = manager.handler();
+    for (const auto& way : input.select<osmium::Way>()) {
+        handler.way(way);
+    }
+    handler.flush();
+
+    return manager.read();
+}
+
+static std::vector<osmium::object_id_type> area_ids(const osmium::memory::Buffer& buffer) {
+    std::vector<osmium::object_id_type> ids;
+    for (const auto& area : buffer.select<osmium::Area>()) {
+        ids.push_back(area.id());
+    }
+    return ids;
+}
+
+TEST_CASE("Multipolygon manager assembling areas in a thread pool") {
+    const auto input = create_test_data();
+    const osmium::area::AssemblerConfig config;
+
+    manager_type manager{config};
+    const auto expected = run_manager(manager, input);
+    const auto expected_ids = area_ids(expected);
+    REQUIRE(expected_ids.size() == 20000);
+    REQUIRE(manager.stats().from_ways == 13333);
+    REQUIRE(manager.stats().from_relations == 6667);
+
+    osmium::thread::Pool pool{4};
+
+    SECTION("ordered") {
+        manager_type parallel_manager{config};
+        parallel_manager.use_thread_pool(pool);
+        const auto result = run_manager(parallel_manager, input);
+
+        REQUIRE(result.committed() == expected.committed());
+        REQUIRE(std::equal(result.data(), result.data() + result.committed(), expected.data()));
+        REQUIRE(parallel_manager.stats().from_ways == 13333);
+        REQUIRE(parallel_manager.stats().from_relations == 6667);
+    }
+
+    SECTION("unordered") {
+        manager_type parallel_manager{config};
+        parallel_manager.use_thread_pool(pool, false);
+        const auto result = run_manager(parallel_manager, input);
+
+        auto ids = area_ids(result);
+        auto sorted_expected_ids = expected_ids;
+        std::sort(ids.begin(), ids.end());
+        std::sort(sorted_expected_ids.begin(), sorted_expected_ids.end());
+        REQUIRE(ids == sorted_expected_ids);
+        REQUIRE(parallel_manager.stats().from_ways == 13333);
+        REQUIRE(parallel_manager.stats().from_relations == 6667);
+    }
+}
+
+TEST_CASE("Multipolygon manager with thread pool and callback") {
+    const auto input = create_test_data();
+    const osmium::area::AssemblerConfig config;
+
+    osmium::thread::Pool pool{2};
+    manager_type manager{config};
+    manager.use_thread_pool(pool);
+
+    for (const auto& relation : input.select<osmium::Relation>()) {
+        manager.relation(relation);
+    }
+    manager.prepare_for_lookup();
+
+    std::size_t count = 0;
+    auto& handler = manager.handler([&](osmium::memory::Buffer&& buffer) {
+        count += area_ids(buffer).size();
+    });
+    for (const auto& way : input.select<osmium::Way>()) {
+        handler.way(way);
+    }
+    handler.flush();
+
+    REQUIRE(count == 20000);
+}
+
+TEST_CASE("Multipolygon manager with area cache") {
+    auto input = create_test_data();
+    const osmium::area::AssemblerConfig config;
+
+    const int fd = osmium::detail::create_tmp_file();
+    osmium::memory::Buffer expected;
+    {
+        osmium::area::AreaCacheWriter writer{fd};
+        manager_type manager{config};
+        manager.use_area_cache(nullptr, &writer);
+        expected = run_manager(manager, input);
+        REQUIRE(manager.stats().from_cache == 0);
+        REQUIRE(writer.size() == 20000);
+        writer.close();
+    }
+
+    const osmium::area::AreaCache cache{fd};
+    REQUIRE(cache.size() == 20000);
+
+    SECTION("unchanged input") {
+        manager_type manager{config};
+        manager.use_area_cache(&cache);
+        const auto result = run_manager(manager, input);
+
+        REQUIRE(manager.stats().from_cache == 20000);
+        REQUIRE(manager.stats().from_ways == 0);
+        REQUIRE(manager.stats().from_relations == 0);
+        REQUIRE(result.committed() == expected.committed());
+        REQUIRE(std::equal(result.data(), result.data() + result.committed(), expected.data()));
+    }
+
+    SECTION("unchanged input with thread pool") {
+        osmium::thread::Pool pool{4};
+        const int fd2 = osmium::detail::create_tmp_file();
+        osmium::area::AreaCacheWriter writer{fd2};
+
+        manager_type manager{config};
+        manager.use_thread_pool(pool);
+        manager.use_area_cache(&cache, &writer);
+        const auto result = run_manager(manager, input);
+
+        REQUIRE(manager.stats().from_cache == 20000);
+        REQUIRE(result.committed() == expected.committed());
+        REQUIRE(std::equal(result.data(), result.data() + result.committed(), expected.data()));
+
+        writer.close();
+        const osmium::area::AreaCache cache2{fd2};
+        REQUIRE(cache2.size() == 20000);
+    }
+
+    SECTION("changed input") {
+        // Move one node of a tagged way and one node of a way that is the
+        // outer ring of a relation.
+        for (auto& way : input.select<osmium::Way>()) {
+            if (way.id() == 1 || way.id() == 2) {
+                auto& node_ref = way.nodes()[1];
+                node_ref.set_location(osmium::Location{node_ref.location().x() + 10, node_ref.location().y()});
+            }
+        }
+
+        manager_type manager{config};
+        manager.use_area_cache(&cache);
+        const auto result = run_manager(manager, input);
+
+        REQUIRE(manager.stats().from_cache == 19998);
+        REQUIRE(manager.stats().from_ways == 1);
+        REQUIRE(manager.stats().from_relations == 1);
+        REQUIRE(area_ids(result) == area_ids(expected));
+        REQUIRE_FALSE(std::equal(result.data(), result.data() + result.committed(), expected.data()));
+    }
+}
@@ -0,0 +1,116 @@
+#include "catch.hpp"
+
+#include <osmium/area/detail/segment_list.hpp>
+#include <osmium/area/problem_reporter.hpp>
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <random>
+#include <tuple>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+    class IntersectionRecorder : public osmium::area::ProblemReporter {
+
+    public:
+
+        using intersection_type = std::tuple<osmium::Location, osmium::Location, osmium::Location, osmium::Location, osmium::Location>;
+
+        std::vector<intersection_type> intersections;
+
+        void report_intersection(osmium::object_id_type /*way1_id*/, osmium::Location way1_seg_start, osmium::Location way1_seg_end,
+                                 osmium::object_id_type /*way2_id*/, osmium::Location way2_seg_start, osmium::Location way2_seg_end, osmium::Location intersection) override {
+            intersections.emplace_back(way1_seg_start, way1_seg_end, way2_seg_start, way2_seg_end, intersection);
+        }
+
+    }; // class IntersectionRecorder
+
+    void check_intersections(const osmium::Way& way, uint32_t expected) {
+        osmium::area::detail::SegmentList segment_list{false};
+        uint64_t duplicate_nodes = 0;
+        uint64_t duplicate_segments = 0;
+        uint64_t overlapping_segments = 0;
+        segment_list.extract_segments_from_way(nullptr, duplicate_nodes, way);
+        segment_list.sort();
+        segment_list.erase_duplicate_segments(nullptr, duplicate_segments, overlapping_segments);
+
+        IntersectionRecorder nested_loop;
+        IntersectionRecorder sweep;
+        IntersectionRecorder automatic;
+
+        REQUIRE(segment_list.find_intersections_nested_loop(&nested_loop) == expected);
+        REQUIRE(segment_list.find_intersections_sweep(&sweep) == expected);
+        REQUIRE(segment_list.find_intersections(&automatic) == expected);
+
+        REQUIRE(nested_loop.intersections.size() == expected);
+        REQUIRE(nested_loop.intersections == sweep.intersections);
+        REQUIRE(nested_loop.intersections == automatic.intersections);
+    }
+
+} // anonymous namespace
+
+TEST_CASE("Find intersections in segment list without intersections") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto pos = osmium::builder::add_way(buffer,
+        _id(1),
+        _nodes({
+            {1, {1.0, 1.0}},
+            {2, {1.0, 2.0}},
+            {3, {2.0, 2.0}},
+            {4, {2.0, 1.0}},
+            {1, {1.0, 1.0}}
+        })
+    );
+
+    check_intersections(buffer.get<osmium::Way>(pos), 0);
+}
+
+TEST_CASE("Find intersections in segment list with one intersection") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto pos = osmium::builder::add_way(buffer,
+        _id(1),
+        _nodes({
+            {1, {1.0, 1.0}},
+            {2, {2.0, 2.0}},
+            {3, {2.0, 1.0}},
+            {4, {1.0, 2.0}},
+            {1, {1.0, 1.0}}
+        })
+    );
+
+    check_intersections(buffer.get<osmium::Way>(pos), 1);
+}
+
+TEST_CASE("Find intersections in large segment lists") {
+    std::mt19937 gen{42}; // NOLINT(cert-msc32-c, cert-msc51-cpp)
+
+    for (const int32_t size : {10, 100, 1000, 1000000}) {
+        osmium::memory::Buffer buffer{1024 * 1024};
+        std::uniform_int_distribution<int32_t> dist{0, size};
+        std::vector<osmium::NodeRef> nodes;
+        for (int i = 1; i <= 1000; ++i) {
+            nodes.emplace_back(i, osmium::Location{dist(gen), dist(gen)});
+        }
+        const auto pos = osmium::builder::add_way(buffer, _id(1), _nodes(nodes));
+
+        const auto& way = buffer.get<osmium::Way>(pos);
+
+        osmium::area::detail::SegmentList segment_list{false};
+        uint64_t duplicate_nodes = 0;
+        uint64_t duplicate_segments = 0;
+        uint64_t overlapping_segments = 0;
+        segment_list.extract_segments_from_way(nullptr, duplicate_nodes, way);
+        segment_list.sort();
+        segment_list.erase_duplicate_segments(nullptr, duplicate_segments, overlapping_segments);
+
+        const auto expected = segment_list.find_intersections_nested_loop(nullptr);
+        REQUIRE(expected > 0);
+        check_intersections(way, expected);
+    }
+}
@@ -171,3 +171,19 @@ TEST_CASE("GeoJSON area geometry") {
 
 }
 
+TEST_CASE("GeoJSON append geometry factory") {
+    osmium::memory::Buffer buffer{1000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+    const auto& closed = create_test_wnl_closed(buffer);
+
+    std::string out;
+    osmium::geom::GeoJSONAppendFactory<> factory{out};
+    const auto size = factory.create_point(osmium::Location{3.2, 4.2});
+    REQUIRE(size == out.size());
+    factory.create_linestring(wnl);
+    factory.create_polygon(closed);
+
+    REQUIRE(out == "{\"type\":\"Point\",\"coordinates\":[3.2,4.2]}"
+                   "{\"type\":\"LineString\",\"coordinates\":[[3.2,4.2],[3.5,4.7],[3.6,4.9]]}"
+                   "{\"type\":\"Polygon\",\"coordinates\":[[[3,3],[4.1,4.1],[3.6,4.1],[3.1,3.5],[3,3]]]}");
+}
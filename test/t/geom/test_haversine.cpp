@@ -0,0 +1,71 @@
+#include "catch.hpp"
+
+#include "wnl_helper.hpp"
+
+#include <osmium/geom/haversine.hpp>
+
+#include <vector>
+
+namespace haversine = osmium::geom::haversine;
+
+TEST_CASE("Haversine distance between two coordinates") {
+    const osmium::geom::Coordinates c1{13.4, 52.5};
+    const osmium::geom::Coordinates c2{2.35, 48.86};
+    REQUIRE(haversine::distance(c1, c2) == Approx(877000).epsilon(0.01));
+    REQUIRE(haversine::distance(c1, c1) == Approx(0.0));
+}
+
+TEST_CASE("Haversine distance of way node lists") {
+    osmium::memory::Buffer buffer{10000};
+
+    const auto& wnl = create_test_wnl_closed(buffer);
+    const double expected = haversine::distance(osmium::geom::Coordinates{3.0, 3.0}, osmium::geom::Coordinates{4.1, 4.1}) +
+                            haversine::distance(osmium::geom::Coordinates{4.1, 4.1}, osmium::geom::Coordinates{3.6, 4.1}) +
+                            haversine::distance(osmium::geom::Coordinates{3.6, 4.1}, osmium::geom::Coordinates{3.1, 3.5}) +
+                            haversine::distance(osmium::geom::Coordinates{3.1, 3.5}, osmium::geom::Coordinates{3.0, 3.0});
+
+    REQUIRE(haversine::distance(wnl) == Approx(expected));
+    REQUIRE(haversine::distance<haversine::equirectangular>(wnl) == Approx(expected).epsilon(0.0001));
+
+    const auto& empty = create_test_wnl_empty(buffer);
+    REQUIRE(haversine::distance(empty) == Approx(0.0));
+    REQUIRE(haversine::distance<haversine::equirectangular>(empty) == Approx(0.0));
+}
+
+TEST_CASE("Haversine distance of coordinate arrays") {
+    const std::vector<double> lon{8.0, 8.01, 8.015, 8.015, 7.99};
+    const std::vector<double> lat{50.0, 50.002, 50.01, 50.01, 50.03};
+
+    std::vector<double> segments(lon.size() - 1);
+    haversine::distances(lon.data(), lat.data(), lon.size(), segments.data());
+
+    double sum = 0.0;
+    for (std::size_t i = 1; i < lon.size(); ++i) {
+        const double d = haversine::distance(osmium::geom::Coordinates{lon[i - 1], lat[i - 1]},
+                                             osmium::geom::Coordinates{lon[i], lat[i]});
+        REQUIRE(segments[i - 1] == Approx(d));
+        sum += d;
+    }
+    REQUIRE(segments[2] == Approx(0.0));
+    REQUIRE(haversine::distance(lon.data(), lat.data(), lon.size()) == Approx(sum));
+
+    std::vector<double> approx_segments(lon.size() - 1);
+    haversine::distances<haversine::equirectangular>(lon.data(), lat.data(), lon.size(), approx_segments.data());
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        REQUIRE(approx_segments[i] == Approx(segments[i]).epsilon(0.00001));
+    }
+    REQUIRE(haversine::distance<haversine::equirectangular>(lon.data(), lat.data(), lon.size()) == Approx(sum).epsilon(0.00001));
+
+    REQUIRE(haversine::distance(lon.data(), lat.data(), 1) == Approx(0.0));
+    REQUIRE(haversine::distance(lon.data(), lat.data(), 0) == Approx(0.0));
+    REQUIRE(haversine::distance<haversine::equirectangular>(lon.data(), lat.data(), 0) == Approx(0.0));
+}
+
+TEST_CASE("Equirectangular approximation error") {
+    for (double lat = -80.0; lat <= 80.0; lat += 10.0) {
+        const double lon[2] = {10.0, 10.05};
+        const double lats[2] = {lat, lat + 0.05};
+        const double exact = haversine::distance(lon, lats, 2);
+        REQUIRE(haversine::distance<haversine::equirectangular>(lon, lats, 2) == Approx(exact).epsilon(0.00001));
+    }
+}
@@ -2,6 +2,8 @@
 
 #include <osmium/geom/mercator_projection.hpp>
 
+#include <vector>
+
 TEST_CASE("Mercator projection") {
     const osmium::geom::MercatorProjection projection;
     REQUIRE(3857 == projection.epsg());
@@ -32,3 +34,29 @@ TEST_CASE("Mercator bounds") {
     REQUIRE(osmium::geom::detail::y_to_lat(osmium::geom::detail::lon_to_x(180.0)) == Approx(osmium::geom::MERCATOR_MAX_LAT).epsilon(0.0000001));
 }
 
+
+TEST_CASE("Batch mercator projection gives same results as single") {
+    std::vector<osmium::Location> locations;
+    for (int lat = -850; lat <= 850; lat += 7) {
+        locations.emplace_back(lat * 0.211 - 0.5, lat / 10.0);
+    }
+    locations.emplace_back(180.0, osmium::geom::MERCATOR_MAX_LAT);
+    locations.emplace_back(-180.0, -osmium::geom::MERCATOR_MAX_LAT);
+    locations.emplace_back(0.0, 78.0);
+    locations.emplace_back(0.0, 78.0000001);
+
+    std::vector<double> x(locations.size());
+    std::vector<double> y(locations.size());
+    const osmium::geom::MercatorProjection projection;
+    projection(locations.data(), locations.size(), x.data(), y.data());
+
+    for (std::size_t i = 0; i < locations.size(); ++i) {
+        const auto c = projection(locations[i]);
+        REQUIRE(x[i] == Approx(c.x).margin(0.000001));
+        REQUIRE(y[i] == Approx(c.y).margin(0.000001));
+    }
+}
+
+TEST_CASE("Batch mercator projection with empty input") {
+    osmium::geom::lonlat_to_mercator(nullptr, 0, nullptr, nullptr);
+}
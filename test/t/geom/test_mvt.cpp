@@ -0,0 +1,317 @@
+#include "catch.hpp"
+
+#include "area_helper.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/geom/mvt.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/tags/tags_filter.hpp>
+
+#include <protozero/pbf_message.hpp>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace mvt = osmium::geom::mvt;
+
+// Tile 1/0/0 (top left quarter of the world) with a small extent, so tile
+// coordinates are easy to calculate: lon -180..0 maps to 0..256.
+static const osmium::geom::Tile tile{1, 0, 0};
+
+TEST_CASE("MVT zigzag and command encoding") {
+    REQUIRE(mvt::detail::zigzag(0) == 0);
+    REQUIRE(mvt::detail::zigzag(-1) == 1);
+    REQUIRE(mvt::detail::zigzag(1) == 2);
+    REQUIRE(mvt::detail::zigzag(-2) == 3);
+    REQUIRE(mvt::detail::zigzag(2147483647) == 4294967294U);
+    REQUIRE(mvt::detail::zigzag(-2147483647 - 1) == 4294967295U);
+
+    REQUIRE(mvt::detail::command_integer(mvt::detail::move_to, 1) == 9);
+    REQUIRE(mvt::detail::command_integer(mvt::detail::line_to, 3) == 26);
+    REQUIRE(mvt::detail::command_integer(mvt::detail::close_path, 1) == 15);
+}
+
+TEST_CASE("MVT point geometry") {
+    const osmium::geom::MVTFactory factory{tile, 256};
+
+    const auto geom = factory.create_point(osmium::Location{-90.0, 0.0});
+    REQUIRE(geom.type == mvt::geom_type::point);
+    REQUIRE(geom.commands == (std::vector<uint32_t>{9, 256, 512}));
+}
+
+TEST_CASE("MVT linestring geometry") {
+    osmium::geom::MVTFactory factory{tile, 256};
+    osmium::memory::Buffer buffer{10000};
+
+    SECTION("simple linestring") {
+        const auto& wnl = buffer.get<osmium::WayNodeList>(osmium::builder::add_way_node_list(buffer, _nodes({
+            {1, {-180.0, 0.0}},
+            {2, {-90.0, 0.0}},
+            {3, {-90.0, 0.0}},
+            {4, {-45.0, 0.0}}
+        })));
+
+        const auto geom = factory.create_linestring(wnl);
+        REQUIRE(geom.type == mvt::geom_type::linestring);
+        REQUIRE(geom.commands == (std::vector<uint32_t>{9, 0, 512, 18, 256, 0, 128, 0}));
+    }
+
+    SECTION("points collapsing in tile coordinates are merged") {
+        const auto& wnl = buffer.get<osmium::WayNodeList>(osmium::builder::add_way_node_list(buffer, _nodes({
+            {1, {-90.0, 0.0}},
+            {2, {-90.0001, 0.0001}},
+            {3, {-45.0, 0.0}}
+        })));
+
+        const auto geom = factory.create_linestring(wnl);
+        REQUIRE(geom.commands == (std::vector<uint32_t>{9, 256, 512, 10, 128, 0}));
+    }
+
+    SECTION("linestring collapsing to a point throws") {
+        const auto& wnl = buffer.get<osmium::WayNodeList>(osmium::builder::add_way_node_list(buffer, _nodes({
+            {1, {-90.0, 0.0}},
+            {2, {-90.0001, 0.0001}}
+        })));
+
+        REQUIRE_THROWS_AS(factory.create_linestring(wnl), const osmium::geometry_error&);
+    }
+}
+
+TEST_CASE("MVT linestring far outside the tile on both sides") {
+    // Tile just to the right of lon 0 and below lat 0. Both ends of the
+    // linestring are clamped.
+    osmium::geom::MVTFactory factory{osmium::geom::Tile{20, 1U << 19U, 1U << 19U}, 4096};
+    osmium::memory::Buffer buffer{10000};
+
+    const auto& wnl = buffer.get<osmium::WayNodeList>(osmium::builder::add_way_node_list(buffer, _nodes({
+        {1, {-179.0, 0.0}},
+        {2, {179.0, 0.0}}
+    })));
+
+    constexpr const int32_t max = (1 << 30) - 1;
+    const auto geom = factory.create_linestring(wnl);
+    REQUIRE(geom.commands == (std::vector<uint32_t>{9, mvt::detail::zigzag(-max), 0, 10, mvt::detail::zigzag(2 * max), 0}));
+    REQUIRE(geom.commands[4] == 4294967292U);
+}
+
+// Calculate twice the signed area of the rings in a polygon geometry.
+static std::vector<int64_t> ring_areas(const std::vector<uint32_t>& commands) {
+    std::vector<int64_t> areas;
+    int32_t x = 0;
+    int32_t y = 0;
+    std::vector<std::pair<int32_t, int32_t>> ring;
+    std::size_t i = 0;
+    while (i < commands.size()) {
+        const auto id = commands[i] & 0x7U;
+        const auto count = commands[i] >> 3U;
+        ++i;
+        if (id == 7) {
+            int64_t area = 0;
+            for (std::size_t n = 0; n < ring.size(); ++n) {
+                const auto& p1 = ring[n];
+                const auto& p2 = ring[(n + 1) % ring.size()];
+                area += static_cast<int64_t>(p1.first) * p2.second - static_cast<int64_t>(p2.first) * p1.second;
+            }
+            areas.push_back(area);
+            ring.clear();
+            continue;
+        }
+        for (uint32_t n = 0; n < count; ++n) {
+            const auto dx = static_cast<int32_t>((commands[i] >> 1U) ^ -(commands[i] & 1U));
+            const auto dy = static_cast<int32_t>((commands[i + 1] >> 1U) ^ -(commands[i + 1] & 1U));
+            i += 2;
+            x += dx;
+            y += dy;
+            ring.emplace_back(x, y);
+        }
+    }
+    return areas;
+}
+
+TEST_CASE("MVT polygon geometry") {
+    osmium::geom::MVTFactory factory{tile, 256};
+    osmium::memory::Buffer buffer{10000};
+
+    SECTION("outer ring is written clockwise regardless of input orientation") {
+        const auto& ccw = buffer.get<osmium::WayNodeList>(osmium::builder::add_way_node_list(buffer, _nodes({
+            {1, {-90.0, 0.0}},
+            {2, {0.0, 0.0}},
+            {3, {0.0, 66.5}},
+            {4, {-90.0, 66.5}},
+            {1, {-90.0, 0.0}}
+        })));
+        const auto& cw = buffer.get<osmium::WayNodeList>(osmium::builder::add_way_node_list(buffer, _nodes({
+            {1, {-90.0, 0.0}},
+            {4, {-90.0, 66.5}},
+            {3, {0.0, 66.5}},
+            {2, {0.0, 0.0}},
+            {1, {-90.0, 0.0}}
+        })));
+
+        const auto geom_ccw = factory.create_polygon(ccw);
+        REQUIRE(geom_ccw.type == mvt::geom_type::polygon);
+        REQUIRE(geom_ccw.commands.size() == 11);
+        REQUIRE(geom_ccw.commands[0] == 9);
+        REQUIRE(geom_ccw.commands[3] == 26);
+        REQUIRE(geom_ccw.commands[10] == 15);
+
+        const auto areas_ccw = ring_areas(geom_ccw.commands);
+        REQUIRE(areas_ccw.size() == 1);
+        REQUIRE(areas_ccw[0] > 0);
+
+        const auto areas_cw = ring_areas(factory.create_polygon(cw).commands);
+        REQUIRE(areas_cw.size() == 1);
+        REQUIRE(areas_cw[0] == areas_ccw[0]);
+    }
+
+
+    SECTION("collapsed polygon throws") {
+        const auto& wnl = buffer.get<osmium::WayNodeList>(osmium::builder::add_way_node_list(buffer, _nodes({
+            {1, {-90.0, 0.0}},
+            {2, {-89.9999, 0.0}},
+            {3, {-89.9999, 0.0001}},
+            {4, {-90.0, 0.0001}},
+            {1, {-90.0, 0.0}}
+        })));
+
+        REQUIRE_THROWS_AS(factory.create_polygon(wnl), const osmium::geometry_error&);
+    }
+}
+
+TEST_CASE("MVT multipolygon geometry has correct ring orientation") {
+    osmium::geom::MVTFactory factory{osmium::geom::Tile{0, 0, 0}, 4096};
+    osmium::memory::Buffer buffer{10000};
+
+    const auto& area = create_test_area_1outer_1inner(buffer);
+    const auto geom = factory.create_multipolygon(area);
+    REQUIRE(geom.type == mvt::geom_type::polygon);
+
+    const auto areas = ring_areas(geom.commands);
+    REQUIRE(areas.size() == 2);
+    REQUIRE(areas[0] > 0);
+    REQUIRE(areas[1] < 0);
+}
+
+TEST_CASE("MVT layer and tile") {
+    osmium::memory::Buffer buffer{10000};
+    osmium::builder::add_way(buffer,
+        _id(17),
+        _tag("highway", "primary"),
+        _tag("name", "Main Street"),
+        _nodes({{1, {-180.0, 0.0}}, {2, {-90.0, 0.0}}})
+    );
+    osmium::builder::add_way(buffer,
+        _id(18),
+        _tag("highway", "primary"),
+        _tag("note", "ignore me"),
+        _nodes({{3, {-90.0, 0.0}}, {4, {-45.0, 0.0}}})
+    );
+
+    osmium::geom::MVTFactory factory{tile, 256};
+    mvt::layer_builder layer{"roads", 256};
+    REQUIRE(layer.empty());
+
+    osmium::TagsFilter filter{false};
+    filter.add_rule(true, "highway");
+    filter.add_rule(true, "name");
+
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        layer.add_feature(factory.create_linestring(way), way.tags(), static_cast<uint64_t>(way.id()), filter);
+    }
+    REQUIRE(layer.num_features() == 2);
+
+    mvt::layer_builder empty_layer{"empty"};
+
+    mvt::tile_builder tile_builder;
+    tile_builder.add_layer(layer);
+    tile_builder.add_layer(empty_layer);
+
+    protozero::pbf_message<mvt::detail::Tile> pbf_tile{tile_builder.data()};
+    int num_layers = 0;
+    while (pbf_tile.next()) {
+        REQUIRE(pbf_tile.tag() == mvt::detail::Tile::repeated_Layer_layers);
+        ++num_layers;
+
+        std::vector<std::string> keys;
+        std::vector<std::string> values;
+        std::vector<uint64_t> ids;
+        std::vector<std::vector<uint32_t>> tags;
+        std::vector<std::vector<uint32_t>> geometries;
+        std::string name;
+        uint32_t version = 0;
+        uint32_t extent = 0;
+
+        protozero::pbf_message<mvt::detail::Layer> pbf_layer{pbf_tile.get_view()};
+        while (pbf_layer.next()) {
+            switch (pbf_layer.tag()) {
+                case mvt::detail::Layer::required_string_name:
+                    name = pbf_layer.get_string();
+                    break;
+                case mvt::detail::Layer::required_uint32_version:
+                    version = pbf_layer.get_uint32();
+                    break;
+                case mvt::detail::Layer::optional_uint32_extent:
+                    extent = pbf_layer.get_uint32();
+                    break;
+                case mvt::detail::Layer::repeated_string_keys:
+                    keys.push_back(pbf_layer.get_string());
+                    break;
+                case mvt::detail::Layer::repeated_Value_values: {
+                        protozero::pbf_message<mvt::detail::Value> pbf_value{pbf_layer.get_view()};
+                        REQUIRE(pbf_value.next());
+                        REQUIRE(pbf_value.tag() == mvt::detail::Value::optional_string_string_value);
+                        values.push_back(pbf_value.get_string());
+                    }
+                    break;
+                case mvt::detail::Layer::repeated_Feature_features: {
+                        protozero::pbf_message<mvt::detail::Feature> pbf_feature{pbf_layer.get_view()};
+                        while (pbf_feature.next()) {
+                            switch (pbf_feature.tag()) {
+                                case mvt::detail::Feature::optional_uint64_id:
+                                    ids.push_back(pbf_feature.get_uint64());
+                                    break;
+                                case mvt::detail::Feature::packed_uint32_tags: {
+                                        const auto range = pbf_feature.get_packed_uint32();
+                                        tags.emplace_back(range.begin(), range.end());
+                                    }
+                                    break;
+                                case mvt::detail::Feature::optional_GeomType_type:
+                                    REQUIRE(pbf_feature.get_enum() == 2);
+                                    break;
+                                case mvt::detail::Feature::packed_uint32_geometry: {
+                                        const auto range = pbf_feature.get_packed_uint32();
+                                        geometries.emplace_back(range.begin(), range.end());
+                                    }
+                                    break;
+                                default:
+                                    pbf_feature.skip();
+                            }
+                        }
+                    }
+                    break;
+                default:
+                    pbf_layer.skip();
+            }
+        }
+
+        REQUIRE(name == "roads");
+        REQUIRE(version == 2);
+        REQUIRE(extent == 256);
+        REQUIRE(keys == (std::vector<std::string>{"highway", "name"}));
+        REQUIRE(values == (std::vector<std::string>{"primary", "Main Street"}));
+        REQUIRE(ids == (std::vector<uint64_t>{17, 18}));
+        REQUIRE(tags.size() == 2);
+        REQUIRE(tags[0] == (std::vector<uint32_t>{0, 0, 1, 1}));
+        REQUIRE(tags[1] == (std::vector<uint32_t>{0, 0}));
+        REQUIRE(geometries.size() == 2);
+        REQUIRE(geometries[0] == (std::vector<uint32_t>{9, 0, 512, 10, 256, 0}));
+        REQUIRE(geometries[1] == (std::vector<uint32_t>{9, 256, 512, 10, 128, 0}));
+    }
+
+    REQUIRE(num_layers == 1);
+}
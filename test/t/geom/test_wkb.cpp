@@ -128,6 +128,43 @@ TEST_CASE("WKB geometry factory (byte-order-dependent): polygon") {
     REQUIRE(wkb == "010300000001000000050000000000000000000840000000000000084066666666666610406666666666661040CDCCCCCCCCCC0C406666666666661040CDCCCCCCCCCC08400000000000000C4000000000000008400000000000000840");
 }
 
+TEST_CASE("WKB append geometry factory (byte-order-dependent)") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+    const auto& closed = create_test_wnl_closed(buffer);
+
+    osmium::geom::WKBFactory<> factory{osmium::geom::wkb_type::ewkb, osmium::geom::out_type::hex};
+    const std::string point{factory.create_point(osmium::Location{3.2, 4.2})};
+    const std::string linestring{factory.create_linestring(wnl)};
+    const std::string polygon{factory.create_polygon(closed)};
+
+    std::string out{"prefix|"};
+    osmium::geom::WKBAppendFactory<> append_factory{out, osmium::geom::wkb_type::ewkb, osmium::geom::out_type::hex};
+    REQUIRE(append_factory.create_point(osmium::Location{3.2, 4.2}) == point.size());
+    out += '|';
+    REQUIRE(append_factory.create_linestring(wnl) == linestring.size());
+    out += '|';
+    REQUIRE(append_factory.create_polygon(closed) == polygon.size());
+
+    REQUIRE(out == "prefix|" + point + "|" + linestring + "|" + polygon);
+}
+
+TEST_CASE("WKB append geometry factory (byte-order-dependent) doesn't append on error") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+    const auto& undefined = create_test_wnl_undefined_location(buffer);
+
+    osmium::geom::WKBFactory<> factory{osmium::geom::wkb_type::wkb, osmium::geom::out_type::binary};
+    const std::string linestring{factory.create_linestring(wnl)};
+
+    std::string out;
+    osmium::geom::WKBAppendFactory<> append_factory{out};
+    REQUIRE_THROWS_AS(append_factory.create_linestring(undefined), const osmium::invalid_location&);
+    REQUIRE(out.empty());
+    REQUIRE(append_factory.create_linestring(wnl) == linestring.size());
+    REQUIRE(out == linestring);
+}
+
 #endif
 
 TEST_CASE("WKB geometry (byte-order-independent) of empty point") {
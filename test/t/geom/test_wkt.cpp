@@ -153,3 +153,22 @@ TEST_CASE("WKT geometry factory") {
 
 }
 
+TEST_CASE("WKT append geometry factory") {
+    osmium::memory::Buffer area_buffer{10000};
+    const auto& area = create_test_area_1outer_1inner(area_buffer);
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+
+    std::string out;
+    osmium::geom::WKTAppendFactory<> factory{out, 7, osmium::geom::wkt_type::ewkt};
+    REQUIRE(factory.create_point(osmium::Location{3.2, 4.2}) == 24);
+    out += '\n';
+    factory.create_linestring(wnl);
+    out += '\n';
+    REQUIRE_THROWS_AS(factory.create_polygon(wnl), const osmium::geometry_error&);
+    factory.create_multipolygon(area);
+
+    REQUIRE(out == "SRID=4326;POINT(3.2 4.2)\n"
+                   "SRID=4326;LINESTRING(3.2 4.2,3.5 4.7,3.6 4.9)\n"
+                   "SRID=4326;MULTIPOLYGON(((0.1 0.1,9.1 0.1,9.1 9.1,0.1 9.1,0.1 0.1),(1 1,8 1,8 8,1 8,1 1)))");
+}
@@ -0,0 +1,70 @@
+#include "catch.hpp"
+
+#include <osmium/handler/node_locations_updater.hpp>
+#include <osmium/index/map/dense_mem_array.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/opl.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/visitor.hpp>
+
+using dense_index_type = osmium::index::map::DenseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+using sparse_index_type = osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+template <typename TIndex>
+static void test_updater() {
+    TIndex index;
+    index.set(10, osmium::Location{1.0, 1.0});
+    index.set(11, osmium::Location{1.1, 1.1});
+    index.set(12, osmium::Location{1.2, 1.2});
+    index.sort();
+
+    osmium::memory::Buffer buffer{1024};
+    REQUIRE(osmium::opl_parse("n11 v2 dV x2.1 y2.1", buffer));
+    REQUIRE(osmium::opl_parse("n12 v2 dD", buffer));
+    REQUIRE(osmium::opl_parse("n13 v1 dV x3.0 y3.0", buffer));
+    REQUIRE(osmium::opl_parse("n13 v2 dV x3.1 y3.1", buffer));
+    REQUIRE(osmium::opl_parse("n-5 v1 dV x5.0 y5.0", buffer));
+
+    osmium::handler::NodeLocationsUpdater<TIndex> updater{index};
+    osmium::apply(buffer, updater);
+
+    REQUIRE(updater.count_set() == 3);
+    REQUIRE(updater.count_removed() == 1);
+
+    REQUIRE(index.get(10) == osmium::Location(1.0, 1.0));
+    REQUIRE(index.get(11) == osmium::Location(2.1, 2.1));
+    REQUIRE_THROWS_AS(index.get(12), const osmium::not_found&);
+    REQUIRE(index.get(13) == osmium::Location(3.1, 3.1));
+    REQUIRE_THROWS_AS(index.get(5), const osmium::not_found&);
+}
+
+TEST_CASE("Update dense index with node changes") {
+    test_updater<dense_index_type>();
+}
+
+TEST_CASE("Update sparse index with node changes") {
+    test_updater<sparse_index_type>();
+}
+
+TEST_CASE("Updates to sparse index can be merged several times") {
+    sparse_index_type index;
+    osmium::handler::NodeLocationsUpdater<sparse_index_type> updater{index};
+
+    osmium::memory::Buffer buffer1{1024};
+    REQUIRE(osmium::opl_parse("n3 v1 dV x3.0 y3.0", buffer1));
+    REQUIRE(osmium::opl_parse("n1 v1 dV x1.0 y1.0", buffer1));
+    osmium::apply(buffer1, updater);
+    REQUIRE(index.size() == 2);
+
+    osmium::memory::Buffer buffer2{1024};
+    REQUIRE(osmium::opl_parse("n2 v1 dV x2.0 y2.0", buffer2));
+    REQUIRE(osmium::opl_parse("n3 v2 dD", buffer2));
+    osmium::apply(buffer2, updater);
+    REQUIRE(index.size() == 2);
+
+    REQUIRE(index.get(1) == osmium::Location(1.0, 1.0));
+    REQUIRE(index.get(2) == osmium::Location(2.0, 2.0));
+    REQUIRE_THROWS_AS(index.get(3), const osmium::not_found&);
+}
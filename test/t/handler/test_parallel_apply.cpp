@@ -0,0 +1,200 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/parallel_visitor.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+    // Source giving out prepared buffers, one for each read() like a Reader.
+    class buffer_source {
+
+        std::vector<osmium::memory::Buffer> m_buffers;
+        std::size_t m_next = 0;
+
+    public:
+
+        explicit buffer_source(std::vector<osmium::memory::Buffer>&& buffers) :
+            m_buffers(std::move(buffers)) {
+        }
+
+        osmium::memory::Buffer read() {
+            if (m_next == m_buffers.size()) {
+                return osmium::memory::Buffer{};
+            }
+            return std::move(m_buffers[m_next++]);
+        }
+
+    }; // class buffer_source
+
+    // 20 buffers with 50 nodes and 10 ways each. Ids are consecutive
+    // over all buffers.
+    buffer_source create_source() {
+        std::vector<osmium::memory::Buffer> buffers;
+        osmium::object_id_type id = 1;
+        for (int b = 0; b < 20; ++b) {
+            buffers.emplace_back(10240, osmium::memory::Buffer::auto_grow::yes);
+            auto& buffer = buffers.back();
+            for (int n = 0; n < 50; ++n, ++id) {
+                osmium::builder::add_node(buffer, _id(id), _tag("amenity", (id % 3 == 0) ? "bench" : "cafe"));
+            }
+            for (int n = 0; n < 10; ++n, ++id) {
+                osmium::builder::add_way(buffer, _id(id), _tag("highway", "primary"), _nodes({1, 2}));
+            }
+        }
+        return buffer_source{std::move(buffers)};
+    }
+
+    struct TagCounter : public osmium::handler::Handler {
+
+        std::map<std::string, std::size_t> counts;
+        std::size_t nodes = 0;
+        std::size_t ways = 0;
+        bool flushed = false;
+
+        void osm_object(const osmium::OSMObject& object) {
+            for (const auto& tag : object.tags()) {
+                ++counts[std::string{tag.key()} + "=" + tag.value()];
+            }
+        }
+
+        void node(const osmium::Node& /*node*/) {
+            ++nodes;
+        }
+
+        void way(const osmium::Way& /*way*/) {
+            ++ways;
+        }
+
+        void flush() {
+            flushed = true;
+        }
+
+        void merge(TagCounter&& other) {
+            for (const auto& c : other.counts) {
+                counts[c.first] += c.second;
+            }
+            nodes += other.nodes;
+            ways += other.ways;
+        }
+
+    }; // struct TagCounter
+
+} // anonymous namespace
+
+TEST_CASE("parallel_apply with handler factory") {
+    osmium::thread::Pool pool{4};
+    auto source = create_source();
+
+    const auto handlers = osmium::parallel_apply(source, []() {
+        return TagCounter{};
+    }, pool);
+
+    REQUIRE(handlers.size() == 4);
+
+    std::size_t nodes = 0;
+    std::size_t ways = 0;
+    for (const auto& handler : handlers) {
+        REQUIRE(handler.flushed);
+        nodes += handler.nodes;
+        ways += handler.ways;
+    }
+    REQUIRE(nodes == 1000);
+    REQUIRE(ways == 200);
+}
+
+TEST_CASE("parallel_apply with functor") {
+    osmium::thread::Pool pool{3};
+    auto source = create_source();
+
+    std::atomic<int> count_ways{0};
+
+    osmium::parallel_apply(source, [&]() {
+        return [&](const osmium::Way& /*way*/) {
+            ++count_ways;
+        };
+    }, pool);
+
+    REQUIRE(count_ways == 200);
+}
+
+TEST_CASE("parallel_apply_reduce gives same result as sequential apply") {
+    osmium::thread::Pool pool{4};
+
+    TagCounter sequential;
+    {
+        auto source = create_source();
+        while (auto buffer = source.read()) {
+            osmium::apply(buffer, sequential);
+        }
+    }
+
+    auto source = create_source();
+    const auto result = osmium::parallel_apply_reduce(source, []() {
+        return TagCounter{};
+    }, [](TagCounter& result, TagCounter&& other) {
+        result.merge(std::move(other));
+    }, pool);
+
+    REQUIRE(result.nodes == 1000);
+    REQUIRE(result.ways == 200);
+    REQUIRE(result.counts == sequential.counts);
+    REQUIRE(result.counts.at("highway=primary") == 200);
+}
+
+TEST_CASE("parallel_apply_ordered keeps buffer order") {
+    osmium::thread::Pool pool{4};
+    auto source = create_source();
+
+    std::vector<osmium::object_id_type> ids;
+    osmium::parallel_apply_ordered(source, []() {
+        return [](osmium::Node& node) {
+            // Slow down some buffers so they would finish late.
+            if (node.id() % 150 == 1) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            node.set_version(7);
+        };
+    }, [&](osmium::memory::Buffer&& buffer) {
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            ids.push_back(object.id());
+            if (object.type() == osmium::item_type::node) {
+                REQUIRE(object.version() == 7);
+            }
+        }
+    }, pool);
+
+    REQUIRE(ids.size() == 1200);
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        REQUIRE(ids[i] == static_cast<osmium::object_id_type>(i + 1));
+    }
+}
+
+TEST_CASE("parallel_apply forwards exceptions from handlers") {
+    osmium::thread::Pool pool{2};
+    auto source = create_source();
+
+    REQUIRE_THROWS_AS(osmium::parallel_apply(source, []() {
+        return [](const osmium::Node& node) {
+            if (node.id() == 555) {
+                throw std::runtime_error{"error in handler"};
+            }
+        };
+    }, pool), const std::runtime_error&);
+}
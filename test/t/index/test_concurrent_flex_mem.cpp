@@ -0,0 +1,109 @@
+#include "catch.hpp"
+
+#include <osmium/index/map/concurrent_flex_mem.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using index_type = osmium::index::map::ConcurrentFlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+
+static osmium::Location loc_for(std::uint64_t id) {
+    return osmium::Location{static_cast<int32_t>(id % 1000000), static_cast<int32_t>(id / 1000000)};
+}
+
+static void fill_from_threads(index_type& index, std::uint64_t num_ids, std::uint64_t step) {
+    constexpr const unsigned num_threads = 4;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&index, num_ids, step, t]() {
+            for (std::uint64_t i = t; i < num_ids; i += num_threads) {
+                index.set(i * step + 1, loc_for(i * step + 1));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    index.sort();
+}
+
+TEST_CASE("ConcurrentFlexMem: basic operations in sparse mode") {
+    index_type index;
+    REQUIRE_FALSE(index.is_dense());
+    REQUIRE(index.size() == 0);
+
+    const osmium::Location loc1{1.1, 1.2};
+    const osmium::Location loc2{2.2, -9.4};
+
+    index.set(99, loc2);
+    index.set(17, loc1);
+    index.set(99, loc1);
+    index.sort();
+
+    REQUIRE_FALSE(index.is_dense());
+    REQUIRE(index.size() == 2);
+    REQUIRE(index.get(17) == loc1);
+    REQUIRE(index.get(99) == loc1);
+    REQUIRE(index.get_noexcept(18) == osmium::Location{});
+    REQUIRE_THROWS_AS(index.get(18), const osmium::not_found&);
+
+    index.set(50, loc2);
+    index.sort();
+    REQUIRE(index.size() == 3);
+    REQUIRE(index.get(50) == loc2);
+
+    index.switch_to_dense();
+    REQUIRE(index.is_dense());
+    REQUIRE(index.get(17) == loc1);
+    REQUIRE(index.get(50) == loc2);
+    REQUIRE(index.get(99) == loc1);
+    REQUIRE(index.get_noexcept(2000000000) == osmium::Location{});
+
+    index.clear();
+    REQUIRE_FALSE(index.is_dense());
+    REQUIRE(index.get_noexcept(17) == osmium::Location{});
+}
+
+TEST_CASE("ConcurrentFlexMem: ids too large for dense mode") {
+    index_type index{true, 20};
+    REQUIRE(index.is_dense());
+    index.set(1000, osmium::Location{1, 1});
+    REQUIRE_THROWS_AS(index.set(1ULL << 20U, osmium::Location{1, 1}), const std::out_of_range&);
+    REQUIRE(index.get_noexcept(1ULL << 30U) == osmium::Location{});
+}
+
+TEST_CASE("ConcurrentFlexMem: fill sparse index from several threads") {
+    index_type index;
+    fill_from_threads(index, 100000, 1000);
+
+    REQUIRE_FALSE(index.is_dense());
+    REQUIRE(index.size() == 100000);
+    for (std::uint64_t i = 0; i < 100000; ++i) {
+        REQUIRE(index.get_noexcept(i * 1000 + 1) == loc_for(i * 1000 + 1));
+    }
+    REQUIRE(index.get_noexcept(2) == osmium::Location{});
+}
+
+TEST_CASE("ConcurrentFlexMem: fill dense index from several threads") {
+    index_type index{true};
+    fill_from_threads(index, 1000000, 3);
+
+    REQUIRE(index.is_dense());
+    for (std::uint64_t i = 0; i < 1000000; ++i) {
+        REQUIRE(index.get_noexcept(i * 3 + 1) == loc_for(i * 3 + 1));
+    }
+    REQUIRE(index.get_noexcept(2) == osmium::Location{});
+}
+
+TEST_CASE("ConcurrentFlexMem: switch to dense while filling from several threads") {
+    index_type index;
+    fill_from_threads(index, 0x1000000 + 100000, 1);
+
+    REQUIRE(index.is_dense());
+    for (std::uint64_t i = 1; i <= 0x1000000 + 100000; i += 997) {
+        REQUIRE(index.get_noexcept(i) == loc_for(i));
+    }
+}
@@ -158,3 +158,50 @@ TEST_CASE("File based sparse index") {
     }
 }
 
+
+TEST_CASE("File based sparse index with merged updates") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    const osmium::Location loc1{1.2, 4.5};
+    const osmium::Location loc2{3.5, -7.2};
+    const osmium::Location loc3{9.1, 3.3};
+
+    using index_type = osmium::index::map::SparseFileArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+    {
+        index_type index{fd};
+        index.set(3, loc1);
+        index.set(5, loc1);
+        index.set(8, loc1);
+        index.sort();
+        REQUIRE(index.size() == 3);
+    }
+
+    {
+        index_type index{fd};
+        REQUIRE(index.size() == 3);
+        const auto sorted_size = index.size();
+
+        index.set(7, loc2); // new id
+        index.set(5, loc2); // changed location
+        index.set(5, loc3); // changed again, this one wins
+        index.set(8, osmium::Location{}); // removed
+        index.set(1, loc2); // new id before all others
+
+        index.merge_updates(sorted_size);
+
+        REQUIRE(index.size() == 4);
+        REQUIRE(index.get(1) == loc2);
+        REQUIRE(index.get(3) == loc1);
+        REQUIRE(index.get(5) == loc3);
+        REQUIRE(index.get(7) == loc2);
+        REQUIRE_THROWS_AS(index.get(8), const osmium::not_found&);
+    }
+
+    {
+        index_type index{fd};
+        REQUIRE(index.size() == 4);
+        REQUIRE(index.get(5) == loc3);
+        REQUIRE_THROWS_AS(index.get(8), const osmium::not_found&);
+    }
+}
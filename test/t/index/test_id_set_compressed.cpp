@@ -0,0 +1,207 @@
+#include "catch.hpp"
+
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/id_set_compressed.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+using id_set_type = osmium::index::IdSetCompressed<osmium::unsigned_object_id_type>;
+using id_vector = std::vector<osmium::unsigned_object_id_type>;
+
+// Create Ids with different densities, so that all container types are used.
+static id_vector create_ids(unsigned int seed) {
+    std::mt19937 gen{seed};
+    std::set<osmium::unsigned_object_id_type> ids;
+
+    // sparse (array containers)
+    std::uniform_int_distribution<osmium::unsigned_object_id_type> sparse{0, 1ULL << 34U};
+    for (int i = 0; i < 2000; ++i) {
+        ids.insert(sparse(gen));
+    }
+
+    // dense (bitmap containers)
+    std::uniform_int_distribution<osmium::unsigned_object_id_type> dense{1000000, 1200000};
+    for (int i = 0; i < 50000; ++i) {
+        ids.insert(dense(gen));
+    }
+
+    // consecutive (run containers)
+    const osmium::unsigned_object_id_type start = 5000000 + seed * 1000;
+    for (osmium::unsigned_object_id_type id = start; id < start + 100000; ++id) {
+        ids.insert(id);
+    }
+
+    return id_vector(ids.begin(), ids.end());
+}
+
+static id_vector to_vector(const id_set_type& s) {
+    id_vector result;
+    std::copy(s.begin(), s.end(), std::back_inserter(result));
+    return result;
+}
+
+static id_set_type to_id_set(const id_vector& ids) {
+    id_set_type s;
+    for (const auto id : ids) {
+        s.set(id);
+    }
+    return s;
+}
+
+TEST_CASE("Basic functionality of IdSetCompressed") {
+    id_set_type s;
+
+    REQUIRE_FALSE(s.get(17));
+    REQUIRE(s.empty());
+    REQUIRE(s.size() == 0); // NOLINT(readability-container-size-empty)
+    REQUIRE(s.begin() == s.end());
+
+    s.set(17);
+    s.set(1ULL << 33U);
+    REQUIRE(s.get(17));
+    REQUIRE(s.get(1ULL << 33U));
+    REQUIRE_FALSE(s.get(28));
+    REQUIRE(s.size() == 2);
+
+    REQUIRE_FALSE(s.check_and_set(17));
+    REQUIRE(s.check_and_set(28));
+    REQUIRE(s.size() == 3);
+
+    s.unset(17);
+    s.unset(1ULL << 33U);
+    s.unset(99);
+    REQUIRE_FALSE(s.get(17));
+    REQUIRE(s.size() == 1);
+    REQUIRE(to_vector(s) == id_vector{28});
+
+    s.clear();
+    REQUIRE(s.empty());
+}
+
+TEST_CASE("IdSetCompressed with many Ids") {
+    const auto ids = create_ids(1);
+    auto s = to_id_set(ids);
+
+    REQUIRE(s.size() == ids.size());
+    REQUIRE(to_vector(s) == ids);
+    for (const auto id : ids) {
+        REQUIRE(s.get(id));
+    }
+    REQUIRE_FALSE(s.get(999999));
+
+    id_vector from_for_each;
+    s.for_each([&](osmium::unsigned_object_id_type id) {
+        from_for_each.push_back(id);
+    });
+    REQUIRE(from_for_each == ids);
+
+    const auto memory_before = s.used_memory();
+    s.run_optimize();
+    s.shrink_to_fit();
+    REQUIRE(s.used_memory() < memory_before);
+    REQUIRE(to_vector(s) == ids);
+    REQUIRE(s.get(5001001));
+
+    // changing a run container
+    s.unset(5001010);
+    REQUIRE_FALSE(s.get(5001010));
+    REQUIRE(s.get(5001011));
+    REQUIRE(s.size() == ids.size() - 1);
+
+    // removing many Ids from bitmap containers
+    std::size_t removed = 0;
+    for (const auto id : ids) {
+        if (id >= 1000000 && id <= 1200000) {
+            s.unset(id);
+            ++removed;
+        }
+    }
+    REQUIRE(s.size() == ids.size() - 1 - removed);
+    for (const auto id : s) {
+        REQUIRE((id < 1000000 || id > 1200000));
+    }
+}
+
+TEST_CASE("Bulk operations on IdSetCompressed") {
+    const auto ids1 = create_ids(1);
+    const auto ids2 = create_ids(2);
+
+    auto s1 = to_id_set(ids1);
+    auto s2 = to_id_set(ids2);
+
+    id_vector expected;
+
+    SECTION("union") {
+        std::set_union(ids1.begin(), ids1.end(), ids2.begin(), ids2.end(), std::back_inserter(expected));
+        REQUIRE(s1.union_size(s2) == expected.size());
+        s1 |= s2;
+    }
+
+    SECTION("intersection") {
+        std::set_intersection(ids1.begin(), ids1.end(), ids2.begin(), ids2.end(), std::back_inserter(expected));
+        REQUIRE(s1.intersection_size(s2) == expected.size());
+        s1 &= s2;
+    }
+
+    SECTION("difference") {
+        std::set_difference(ids1.begin(), ids1.end(), ids2.begin(), ids2.end(), std::back_inserter(expected));
+        s1 -= s2;
+    }
+
+    SECTION("union with run containers") {
+        s2.run_optimize();
+        std::set_union(ids1.begin(), ids1.end(), ids2.begin(), ids2.end(), std::back_inserter(expected));
+        REQUIRE(s1.union_size(s2) == expected.size());
+        s1 |= s2;
+    }
+
+    SECTION("intersection with run containers") {
+        s1.run_optimize();
+        s2.run_optimize();
+        std::set_intersection(ids1.begin(), ids1.end(), ids2.begin(), ids2.end(), std::back_inserter(expected));
+        REQUIRE(s1.intersection_size(s2) == expected.size());
+        s1 &= s2;
+    }
+
+    SECTION("difference with run containers") {
+        s1.run_optimize();
+        std::set_difference(ids1.begin(), ids1.end(), ids2.begin(), ids2.end(), std::back_inserter(expected));
+        s1 -= s2;
+    }
+
+    REQUIRE(s1.size() == expected.size());
+    REQUIRE(to_vector(s1) == expected);
+}
+
+TEST_CASE("Write IdSetCompressed to file and use it from there") {
+    const auto ids = create_ids(3);
+    auto s = to_id_set(ids);
+    s.run_optimize();
+
+    const int fd = osmium::detail::create_tmp_file();
+    s.dump(fd);
+
+    const osmium::index::IdSetCompressedView<osmium::unsigned_object_id_type> view{fd};
+    REQUIRE(view.size() == ids.size());
+    REQUIRE_FALSE(view.empty());
+    for (const auto id : ids) {
+        REQUIRE(view.get(id));
+    }
+    REQUIRE_FALSE(view.get(999999));
+    REQUIRE_FALSE(view.get(1ULL << 40U));
+
+    const id_set_type copy{view};
+    REQUIRE(copy.size() == ids.size());
+    REQUIRE(to_vector(copy) == ids);
+}
+
+TEST_CASE("Reading something that is not an IdSetCompressed file") {
+    const int fd = osmium::detail::create_tmp_file();
+    REQUIRE_THROWS_AS(osmium::index::IdSetCompressedView<osmium::unsigned_object_id_type>{fd}, const std::runtime_error&);
+}
@@ -0,0 +1,118 @@
+#include "catch.hpp"
+
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/node_ways_index.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/opl.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <string>
+#include <vector>
+
+using id_vector = std::vector<osmium::unsigned_object_id_type>;
+
+static osmium::index::NodeWaysIndex build_index(const osmium::memory::Buffer& buffer) {
+    osmium::index::NodeWaysIndexBuilder builder;
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        builder.count(way);
+    }
+    builder.prepare();
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        builder.add(way);
+    }
+    osmium::thread::Pool pool{2};
+    return builder.build(pool);
+}
+
+TEST_CASE("Empty node ways index") {
+    const osmium::memory::Buffer buffer{1024};
+    const auto index = build_index(buffer);
+
+    REQUIRE(index.empty());
+    REQUIRE(index.count(1) == 0);
+    REQUIRE(index.get(1).empty());
+}
+
+TEST_CASE("Node ways index") {
+    osmium::memory::Buffer buffer{1024};
+    REQUIRE(osmium::opl_parse("w20 Nn1,n2,n3", buffer));
+    REQUIRE(osmium::opl_parse("w10 Nn3,n4,n3", buffer));
+    REQUIRE(osmium::opl_parse("w30 Nn5,n1,n200,n5", buffer));
+    REQUIRE(osmium::opl_parse("w1000000 Nn1,n9999999", buffer));
+
+    const auto index = build_index(buffer);
+
+    REQUIRE(index.size() == 10);
+    REQUIRE(index.get(0).empty());
+    REQUIRE((index.get(1) == id_vector{20, 30, 1000000}));
+    REQUIRE((index.get(2) == id_vector{20}));
+    REQUIRE((index.get(3) == id_vector{10, 20}));
+    REQUIRE((index.get(4) == id_vector{10}));
+    REQUIRE((index.get(5) == id_vector{30}));
+    REQUIRE(index.get(6).empty());
+    REQUIRE((index.get(200) == id_vector{30}));
+    REQUIRE((index.get(9999999) == id_vector{1000000}));
+    REQUIRE(index.get(10000000).empty());
+    REQUIRE(index.count(1) == 3);
+    REQUIRE(index.count(3) == 2);
+    REQUIRE(index.count(99999999) == 0);
+
+    SECTION("dump and map") {
+        const int fd = osmium::detail::create_tmp_file();
+        index.dump(fd);
+
+        const osmium::index::NodeWaysIndex mapped{fd};
+        REQUIRE(mapped.size() == 10);
+        REQUIRE(mapped.used_memory() == index.used_memory());
+        REQUIRE((mapped.get(1) == id_vector{20, 30, 1000000}));
+        REQUIRE((mapped.get(3) == id_vector{10, 20}));
+        REQUIRE((mapped.get(200) == id_vector{30}));
+        REQUIRE((mapped.get(9999999) == id_vector{1000000}));
+        REQUIRE(mapped.get(6).empty());
+    }
+}
+
+TEST_CASE("Node ways index with many ways") {
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+    for (int i = 1; i <= 5000; ++i) {
+        std::string way{"w"};
+        way += std::to_string(i);
+        way += " Nn";
+        way += std::to_string(i * 1000);
+        way += ",n";
+        way += std::to_string(i * 1000 + 1);
+        way += ",n7";
+        REQUIRE(osmium::opl_parse(way.c_str(), buffer));
+    }
+
+    const auto index = build_index(buffer);
+    REQUIRE(index.size() == 15000);
+    REQUIRE(index.count(7) == 5000);
+    REQUIRE((index.get(4999001) == id_vector{4999}));
+
+    const auto ways = index.get(7);
+    REQUIRE(ways.front() == 1);
+    REQUIRE(ways.back() == 5000);
+}
+
+TEST_CASE("Node ways index builder detects changed input") {
+    osmium::memory::Buffer buffer1{1024};
+    REQUIRE(osmium::opl_parse("w1 Nn1,n2", buffer1));
+    osmium::memory::Buffer buffer2{1024};
+    REQUIRE(osmium::opl_parse("w2 Nn1,n3,n2", buffer2));
+
+    osmium::index::NodeWaysIndexBuilder builder;
+    for (const auto& way : buffer1.select<osmium::Way>()) {
+        builder.count(way);
+    }
+    builder.prepare();
+    for (const auto& way : buffer2.select<osmium::Way>()) {
+        REQUIRE_THROWS_AS(builder.add(way), const std::runtime_error&);
+    }
+}
+
+TEST_CASE("Mapping something that is not a node ways index file") {
+    const int fd = osmium::detail::create_tmp_file();
+    REQUIRE_THROWS_AS(osmium::index::NodeWaysIndex{fd}, const std::runtime_error&);
+}
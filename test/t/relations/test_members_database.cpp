@@ -6,6 +6,8 @@
 #include <osmium/relations/relations_database.hpp>
 #include <osmium/storage/item_stash.hpp>
 
+#include <vector>
+
 osmium::memory::Buffer fill_buffer() {
     using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
     osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
@@ -192,3 +194,105 @@ TEST_CASE("Remove non-existing object from members database doesn't do anything"
     REQUIRE(mdb.size() == 6);
 }
 
+TEST_CASE("Report missing members and skip removed relations in members database") {
+    const auto buffer = fill_buffer();
+
+    osmium::ItemStash stash;
+    osmium::relations::RelationsDatabase rdb{stash};
+    osmium::relations::MembersDatabase<osmium::Way> mdb{stash, rdb};
+
+    for (const auto& relation : buffer.select<osmium::Relation>()) {
+        auto handle = rdb.add(relation);
+        int n = 0;
+        for (const auto& member : relation.members()) {
+            mdb.track(handle, member.ref(), n);
+            ++n;
+        }
+    }
+
+    mdb.prepare_for_lookup();
+    REQUIRE(mdb.stashed_bytes() == 0);
+
+    const auto& w10 = *buffer.select<osmium::Way>().begin();
+    REQUIRE(w10.id() == 10);
+    REQUIRE(mdb.add(w10, [](osmium::relations::RelationHandle& /*rel_handle*/) {}));
+    REQUIRE(mdb.stashed_bytes() == w10.padded_size());
+
+    // Way 11 was not added before way 12, so relation 21 is incomplete.
+    std::vector<osmium::object_id_type> missing;
+    mdb.for_each_missing_before(12, [&](osmium::relations::RelationHandle& rel_handle) {
+        missing.push_back(rel_handle->id());
+        for (const auto& member : rel_handle->members()) {
+            mdb.remove(member.ref(), rel_handle->id());
+        }
+        rel_handle.remove();
+        REQUIRE(rel_handle.removed());
+    });
+    REQUIRE(missing == std::vector<osmium::object_id_type>{21});
+
+    // Reported members are not reported again.
+    mdb.for_each_missing_before(12, [](osmium::relations::RelationHandle& /*rel_handle*/) {
+        REQUIRE(false);
+    });
+
+    // Nobody needs way 12 any more.
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        if (way.id() == 12) {
+            REQUIRE_FALSE(mdb.add(way, [](osmium::relations::RelationHandle& /*rel_handle*/) {
+                REQUIRE(false);
+            }));
+        }
+    }
+
+    missing.clear();
+    mdb.for_each_missing([&](osmium::relations::RelationHandle& rel_handle) {
+        missing.push_back(rel_handle->id());
+    });
+    REQUIRE(missing == std::vector<osmium::object_id_type>({22, 22}));
+}
+
+TEST_CASE("Members database with many members only finds members") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+    osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+
+    {
+        osmium::builder::RelationBuilder builder{buffer};
+        builder.set_id(1);
+        osmium::builder::RelationMemberListBuilder members{buffer, &builder};
+        for (osmium::object_id_type id = 2; id <= 20000; id += 2) {
+            members.add_member(osmium::item_type::way, id, "");
+        }
+    }
+    buffer.commit();
+
+    osmium::ItemStash stash;
+    osmium::relations::RelationsDatabase rdb{stash};
+    osmium::relations::MembersDatabase<osmium::Way> mdb{stash, rdb};
+
+    const auto& relation = buffer.get<osmium::Relation>(0);
+    auto handle = rdb.add(relation);
+    std::size_t n = 0;
+    for (const auto& member : relation.members()) {
+        mdb.track(handle, member.ref(), n++);
+    }
+    mdb.prepare_for_lookup();
+    REQUIRE(mdb.size() == 10000);
+
+    osmium::memory::Buffer ways{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+    for (osmium::object_id_type id = -10; id <= 20010; ++id) {
+        osmium::builder::add_way(ways, _id(id));
+    }
+
+    int complete = 0;
+    for (const auto& way : ways.select<osmium::Way>()) {
+        const bool added = mdb.add(way, [&](osmium::relations::RelationHandle& rel_handle) {
+            REQUIRE(rel_handle->id() == 1);
+            ++complete;
+        });
+        REQUIRE(added == (way.id() > 0 && way.id() <= 20000 && way.id() % 2 == 0));
+    }
+
+    REQUIRE(complete == 1);
+    REQUIRE(mdb.get(4) != nullptr);
+    REQUIRE(mdb.get(5) == nullptr);
+}
@@ -6,7 +6,9 @@
 #include <osmium/osm/relation.hpp>
 #include <osmium/relations/relations_manager.hpp>
 
+#include <algorithm>
 #include <iterator>
+#include <vector>
 
 struct EmptyRM : public osmium::relations::RelationsManager<EmptyRM, true, true, true> {
 };
@@ -108,6 +110,41 @@ struct AnyRM : public osmium::relations::RelationsManager<AnyRM, true, true, tru
     }
 };
 
+struct StreamRM : public osmium::relations::RelationsManager<StreamRM, true, true, true> {
+
+    std::vector<osmium::object_id_type> deferred_ids;
+    std::vector<osmium::object_id_type> complete_ids;
+    std::vector<osmium::object_id_type> incomplete_ids;
+    std::vector<std::size_t> incomplete_seen;
+    std::size_t count_seen = 0;
+
+    bool new_relation(const osmium::Relation& relation) const {
+        return deferred_ids.empty() || std::binary_search(deferred_ids.cbegin(), deferred_ids.cend(), relation.id());
+    }
+
+    void complete_relation(const osmium::Relation& relation) {
+        complete_ids.push_back(relation.id());
+    }
+
+    void incomplete_relation(const osmium::Relation& relation) {
+        incomplete_ids.push_back(relation.id());
+        incomplete_seen.push_back(count_seen);
+    }
+
+    void after_node(const osmium::Node& /*node*/) noexcept {
+        ++count_seen;
+    }
+
+    void after_way(const osmium::Way& /*way*/) noexcept {
+        ++count_seen;
+    }
+
+    void after_relation(const osmium::Relation& /*relation*/) noexcept {
+        ++count_seen;
+    }
+
+};
+
 TEST_CASE("Use RelationsManager without any overloaded functions in derived class") {
     osmium::io::File file{with_data_dir("t/relations/data.osm")};
 
@@ -320,3 +357,83 @@ TEST_CASE("Check handling of missing members") {
     REQUIRE(missing_relations == 2);
 }
 
+
+TEST_CASE("Relations manager in streaming mode releases incomplete relations early") {
+    osmium::io::File file{with_data_dir("t/relations/missing_members.osm")};
+
+    StreamRM manager;
+    manager.set_streaming();
+    REQUIRE(manager.streaming());
+
+    osmium::relations::read_relations(file, manager);
+
+    osmium::io::Reader reader{file};
+    osmium::apply(reader, manager.handler());
+    reader.close();
+
+    REQUIRE(manager.complete_ids.empty());
+
+    // Relation 31 is missing node 15 which is noticed at the first way,
+    // relation 32 is missing all its ways which is noticed at the first
+    // relation.
+    REQUIRE(manager.incomplete_ids == std::vector<osmium::object_id_type>({31, 32}));
+    REQUIRE(manager.incomplete_seen == std::vector<std::size_t>({5, 7}));
+
+    int n = 0;
+    manager.for_each_incomplete_relation([&](const osmium::relations::RelationHandle& /*handle*/) {
+        ++n;
+    });
+    REQUIRE(n == 0);
+    REQUIRE(manager.stash().size() == 0);
+    REQUIRE(manager.member_nodes_database().stashed_bytes() == 0);
+    REQUIRE(manager.member_ways_database().stashed_bytes() == 0);
+    REQUIRE(manager.member_relations_database().stashed_bytes() == 0);
+}
+
+TEST_CASE("Relations manager with member memory budget defers relations to third pass") {
+    osmium::io::File file{with_data_dir("t/relations/data.osm")};
+
+    StreamRM manager;
+    manager.set_member_memory_budget(1);
+    REQUIRE(manager.member_memory_budget() == 1);
+
+    osmium::relations::read_relations(file, manager);
+
+    osmium::io::Reader reader{file};
+    osmium::apply(reader, manager.handler());
+    reader.close();
+
+    // Relation 31 has to wait for its other members after node 11 was
+    // found, so it is removed to keep within the budget.
+    REQUIRE(manager.complete_ids == std::vector<osmium::object_id_type>({30, 32}));
+    REQUIRE(manager.incomplete_ids.empty());
+    REQUIRE(manager.deferred_relations() == std::vector<osmium::object_id_type>({31}));
+    REQUIRE(manager.stash().size() == 0);
+
+    StreamRM third_pass;
+    third_pass.deferred_ids = manager.deferred_relations();
+
+    osmium::relations::read_relations(file, third_pass);
+
+    osmium::io::Reader reader3{file};
+    osmium::apply(reader3, third_pass.handler());
+    reader3.close();
+
+    REQUIRE(third_pass.complete_ids.empty());
+
+    int n = 0;
+    third_pass.for_each_incomplete_relation([&](const osmium::relations::RelationHandle& handle) {
+        ++n;
+        REQUIRE(handle->id() == 31);
+        for (const auto& member : handle->members()) {
+            const auto* obj = third_pass.get_member_object(member);
+            if (member.ref() == 22) {
+                REQUIRE_FALSE(obj);
+            } else {
+                REQUIRE(obj);
+            }
+        }
+    });
+    REQUIRE(n == 1);
+}
+
@@ -166,3 +166,138 @@ TEST_CASE("Fill item stash until it garbage collects") {
     REQUIRE(stash.count_removed() == 0);
 }
 
+
+TEST_CASE("Item stash with small segments") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+    for (osmium::object_id_type id = 1; id <= 1000; ++id) {
+        osmium::builder::add_node(buffer, _id(id));
+    }
+
+    osmium::ItemStash stash{1024};
+    REQUIRE(stash.count_segments() == 1);
+
+    std::vector<osmium::ItemStash::handle_type> handles;
+    for (const auto& node : buffer.select<osmium::Node>()) {
+        handles.push_back(stash.add_item(node));
+    }
+    REQUIRE(stash.size() == 1000);
+
+    const auto segments = stash.count_segments();
+    REQUIRE(segments > 10);
+
+    SECTION("removing all items in a segment frees it") {
+        for (std::size_t i = 0; i < 500; ++i) {
+            stash.remove_item(handles[i]);
+        }
+        REQUIRE(stash.size() == 500);
+        REQUIRE(stash.count_segments() < segments);
+        REQUIRE(stash.count_removed() < 500);
+
+        for (std::size_t i = 500; i < 1000; ++i) {
+            REQUIRE(stash.get<osmium::Node>(handles[i]).id() == static_cast<osmium::object_id_type>(i + 1));
+        }
+    }
+
+    SECTION("segments are compacted incrementally") {
+        for (std::size_t i = 0; i < 1000; i += 2) {
+            stash.remove_item(handles[i]);
+        }
+        REQUIRE(stash.count_removed() == 500);
+
+        std::vector<osmium::ItemStash::handle_type> new_handles;
+        for (const auto& node : buffer.select<osmium::Node>()) {
+            new_handles.push_back(stash.add_item(node));
+        }
+
+        REQUIRE(stash.size() == 1500);
+        REQUIRE(stash.count_removed() < 500);
+        REQUIRE(stash.count_segments() < 2 * segments);
+
+        for (std::size_t i = 1; i < 1000; i += 2) {
+            REQUIRE(stash.get<osmium::Node>(handles[i]).id() == static_cast<osmium::object_id_type>(i + 1));
+        }
+        for (std::size_t i = 0; i < 1000; ++i) {
+            REQUIRE(stash.get<osmium::Node>(new_handles[i]).id() == static_cast<osmium::object_id_type>(i + 1));
+        }
+
+        stash.garbage_collect();
+        REQUIRE(stash.count_removed() == 0);
+        for (std::size_t i = 1; i < 1000; i += 2) {
+            REQUIRE(stash.get<osmium::Node>(handles[i]).id() == static_cast<osmium::object_id_type>(i + 1));
+        }
+    }
+}
+
+TEST_CASE("Item stash with item larger than segment") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(1));
+    std::vector<osmium::object_id_type> nodes(1000);
+    osmium::builder::add_way(buffer, _id(2), _nodes(nodes));
+
+    osmium::ItemStash stash{1024};
+    const auto h1 = stash.add_item(buffer.get<osmium::Node>(0));
+    const auto& way = *buffer.select<osmium::Way>().begin();
+    REQUIRE(way.padded_size() > 1024);
+    const auto h2 = stash.add_item(way);
+    const auto h3 = stash.add_item(buffer.get<osmium::Node>(0));
+    REQUIRE(stash.count_segments() == 2);
+
+    REQUIRE(stash.get<osmium::Way>(h2).nodes().size() == 1000);
+    stash.remove_item(h2);
+    REQUIRE(stash.count_segments() == 1);
+    REQUIRE(stash.count_removed() == 0);
+    REQUIRE(stash.get<osmium::Node>(h1).id() == 1);
+    REQUIRE(stash.get<osmium::Node>(h3).id() == 1);
+}
+
+TEST_CASE("Item stash with memory limit") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+    for (osmium::object_id_type id = 1; id <= 2000; ++id) {
+        osmium::builder::add_node(buffer, _id(id));
+    }
+
+    osmium::ItemStash stash{4096};
+    stash.set_memory_limit(4 * 4096);
+    REQUIRE(stash.memory_limit() == 4 * 4096);
+
+    std::vector<osmium::ItemStash::handle_type> handles;
+    for (const auto& node : buffer.select<osmium::Node>()) {
+        handles.push_back(stash.add_item(node));
+    }
+
+    REQUIRE(stash.count_spilled_segments() > 0);
+    REQUIRE(stash.count_segments() > stash.count_spilled_segments());
+    REQUIRE(stash.count_segments() - stash.count_spilled_segments() <= 5);
+
+    for (std::size_t i = 0; i < handles.size(); ++i) {
+        REQUIRE(stash.get<osmium::Node>(handles[i]).id() == static_cast<osmium::object_id_type>(i + 1));
+    }
+
+    SECTION("remove items from spilled segments") {
+        const auto spilled = stash.count_spilled_segments();
+        for (std::size_t i = 0; i < 1000; ++i) {
+            stash.remove_item(handles[i]);
+        }
+        REQUIRE(stash.count_spilled_segments() < spilled);
+
+        stash.garbage_collect();
+        REQUIRE(stash.count_removed() == 0);
+        for (std::size_t i = 1000; i < handles.size(); ++i) {
+            REQUIRE(stash.get<osmium::Node>(handles[i]).id() == static_cast<osmium::object_id_type>(i + 1));
+        }
+    }
+
+    SECTION("clear stash") {
+        stash.clear();
+        REQUIRE(stash.size() == 0);
+        REQUIRE(stash.count_spilled_segments() == 0);
+        const auto handle = stash.add_item(buffer.get<osmium::Node>(0));
+        REQUIRE(stash.get<osmium::Node>(handle).id() == 1);
+    }
+}
@@ -0,0 +1,93 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/tags/buffer_filter.hpp>
+#include <osmium/tags/matcher.hpp>
+#include <osmium/tags/tags_filter.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <cstddef>
+#include <vector>
+
+static osmium::memory::Buffer fill_buffer() {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+
+    osmium::builder::add_node(buffer, _id(1), _tag("amenity", "bench"));
+    osmium::builder::add_node(buffer, _id(2), _tag("highway", "crossing"));
+    osmium::builder::add_node(buffer, _id(3), _tag("amenity", "cafe"));
+    osmium::builder::add_node(buffer, _id(4));
+    osmium::builder::add_tag_list(buffer, _tag("amenity", "bench"));
+    osmium::builder::add_way(buffer, _id(10), _tag("highway", "primary"), _tag("amenity", "parking"));
+    osmium::builder::add_way(buffer, _id(11), _tag("building", "yes"));
+
+    return buffer;
+}
+
+TEST_CASE("Select objects in buffer") {
+    const auto buffer = fill_buffer();
+
+    osmium::TagsFilter filter;
+    filter.add_rule(true, "amenity");
+    const auto compiled = filter.compile();
+
+    const auto offsets = osmium::tags::select_objects(buffer, filter);
+    REQUIRE(offsets.size() == 3);
+    REQUIRE(buffer.get<osmium::Node>(offsets[0]).id() == 1);
+    REQUIRE(buffer.get<osmium::Node>(offsets[1]).id() == 3);
+    REQUIRE(buffer.get<osmium::Way>(offsets[2]).id() == 10);
+
+    REQUIRE(osmium::tags::select_objects(buffer, compiled) == offsets);
+    REQUIRE(osmium::tags::select_objects(buffer, osmium::TagMatcher{"amenity"}) == offsets);
+
+    const auto way_offsets = osmium::tags::select_objects(buffer, filter, osmium::osm_entity_bits::way);
+    REQUIRE(way_offsets.size() == 1);
+    REQUIRE(way_offsets[0] == offsets[2]);
+
+    const auto bitmap = osmium::tags::select_objects_bitmap(buffer, compiled);
+    REQUIRE(bitmap == std::vector<bool>({true, false, true, false, true, false}));
+
+    const auto node_bitmap = osmium::tags::select_objects_bitmap(buffer, compiled, osmium::osm_entity_bits::node);
+    REQUIRE(node_bitmap == std::vector<bool>({true, false, true, false, false, false}));
+}
+
+TEST_CASE("Select objects in buffer using the pool") {
+    const auto buffer = fill_buffer();
+    const auto filter = osmium::TagsFilter{}.add_rule(true, "highway").compile();
+
+    osmium::thread::Pool pool{2};
+    auto future = osmium::tags::select_objects_async(pool, buffer, filter);
+    const auto offsets = future.get();
+    REQUIRE(offsets.size() == 2);
+    REQUIRE(buffer.get<osmium::Node>(offsets[0]).id() == 2);
+    REQUIRE(buffer.get<osmium::Way>(offsets[1]).id() == 10);
+}
+
+TEST_CASE("Copy selected objects into other buffer") {
+    auto buffer = fill_buffer();
+
+    osmium::TagsFilter filter;
+    filter.add_rule(true, "amenity", "bench");
+    filter.add_rule(true, "highway");
+
+    const auto offsets = osmium::tags::select_objects(buffer, filter);
+    REQUIRE(offsets.size() == 3);
+
+    osmium::memory::Buffer output{1024, osmium::memory::Buffer::auto_grow::yes};
+    osmium::tags::copy_selected(buffer, offsets, output);
+
+    std::vector<osmium::object_id_type> ids;
+    for (const auto& object : output.select<osmium::OSMObject>()) {
+        ids.push_back(object.id());
+    }
+    REQUIRE(ids == std::vector<osmium::object_id_type>({1, 2, 10}));
+
+    SECTION("Removed objects are not selected") {
+        buffer.get<osmium::Node>(offsets[1]).set_removed(true);
+        REQUIRE(osmium::tags::select_objects(buffer, filter).size() == 2);
+    }
+}
+
@@ -221,6 +221,41 @@ TEST_CASE("RegexFilter matches some tags with lvalue regex") {
     check_filter(tag_list, filter, {false, true});
 }
 
+TEST_CASE("DFARegexFilter matches some tags") {
+    osmium::memory::Buffer buffer{10240};
+
+    osmium::tags::DFARegexFilter filter{false};
+    filter.add(true, "highway", osmium::DFARegex{".*_link", true});
+
+    const osmium::TagList& tag_list1 = make_tag_list(buffer, {
+        { "highway", "primary_link" },
+        { "source", "GPS" }
+    });
+    const osmium::TagList& tag_list2 = make_tag_list(buffer, {
+        { "highway", "primary_links" },
+        { "source", "GPS" }
+    });
+
+    check_filter(tag_list1, filter, {true, false});
+    check_filter(tag_list2, filter, {false, false});
+}
+
+TEST_CASE("DFARegexKeyFilter matches some keys") {
+    osmium::memory::Buffer buffer{10240};
+
+    osmium::tags::DFARegexKeyFilter filter{false};
+    filter.add(true, osmium::DFARegex{"name:(de|en)", true});
+
+    const osmium::TagList& tag_list = make_tag_list(buffer, {
+        { "name:de", "Hauptstraße" },
+        { "name:fr", "Rue principale" },
+        { "name:en", "Main Street" },
+        { "name:de_old", "Hauptstrasse" }
+    });
+
+    check_filter(tag_list, filter, {true, false, true, false});
+}
+
 TEST_CASE("KeyPrefixFilter matches some keys") {
     osmium::memory::Buffer buffer{10240};
 
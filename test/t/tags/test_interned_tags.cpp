@@ -0,0 +1,61 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/tags/interned_tags.hpp>
+#include <osmium/util/string_pool.hpp>
+
+#include <cstring>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+TEST_CASE("Interned tag list") {
+    osmium::memory::Buffer buffer{10240};
+    osmium::StringPool pool;
+
+    const auto& node1 = buffer.get<osmium::Node>(osmium::builder::add_node(buffer,
+        _id(1),
+        _tag("highway", "bus_stop"),
+        _tag("name", "Main Street")
+    ));
+    const auto& node2 = buffer.get<osmium::Node>(osmium::builder::add_node(buffer,
+        _id(2),
+        _tag("name", "Main Street"),
+        _tag("highway", "crossing")
+    ));
+
+    const osmium::tags::InternedTagList tags1{pool, node1.tags()};
+    REQUIRE(tags1.size() == 2);
+    REQUIRE(pool.size() == 4);
+
+    const auto highway = pool.find("highway");
+    const auto name = pool.find("name");
+    REQUIRE(tags1[0].key == highway);
+    REQUIRE(tags1[1].key == name);
+    REQUIRE(std::strcmp(pool.get(tags1[0].value), "bus_stop") == 0);
+
+    osmium::tags::InternedTagList tags2;
+    REQUIRE(tags2.empty());
+    tags2.assign(pool, node2.tags());
+    REQUIRE(tags2.size() == 2);
+    REQUIRE(pool.size() == 5);
+
+    REQUIRE(tags1.get_value_by_key(name) == tags2.get_value_by_key(name));
+    REQUIRE(tags1.get_value_by_key(highway) != tags2.get_value_by_key(highway));
+    REQUIRE(tags2.get_value_by_key(highway) == pool.find("crossing"));
+
+    const auto amenity = pool.add("amenity");
+    REQUIRE_FALSE(tags1.has_key(amenity));
+    REQUIRE(tags1.get_value_by_key(amenity) == osmium::StringPool::invalid_id);
+    REQUIRE(tags1.has_key(highway));
+    REQUIRE(tags1.has_tag(highway, pool.find("bus_stop")));
+    REQUIRE_FALSE(tags2.has_tag(highway, pool.find("bus_stop")));
+
+    int count = 0;
+    for (const auto& tag : tags2) {
+        REQUIRE(tag != tags1[0]);
+        ++count;
+    }
+    REQUIRE(count == 2);
+}
@@ -5,7 +5,9 @@
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/tag.hpp>
 
+#include <cstring>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -213,6 +215,86 @@ TEST_CASE("empty keys and values are okay") {
     REQUIRE(std::string("empty key") == tl.get_value_by_key(""));
 }
 
+TEST_CASE("get value by key with long and similar keys") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto pos = osmium::builder::add_tag_list(buffer,
+        _tag("name", "Main Street"),
+        _tag("name:en", "Main Street EN"),
+        _tag("addr:housenumber", "10"),
+        _tag("addr:housenumbers", "11"),
+        _tag("a", "b"),
+        _tag("nam", "x")
+    );
+    const osmium::TagList& tl = buffer.get<osmium::TagList>(pos);
+
+    REQUIRE(std::string("Main Street") == tl.get_value_by_key("name"));
+    REQUIRE(std::string("Main Street EN") == tl.get_value_by_key("name:en"));
+    REQUIRE(std::string("10") == tl.get_value_by_key("addr:housenumber"));
+    REQUIRE(std::string("11") == tl.get_value_by_key("addr:housenumbers"));
+    REQUIRE(std::string("b") == tl.get_value_by_key("a"));
+    REQUIRE(std::string("x") == tl.get_value_by_key("nam"));
+    REQUIRE(nullptr == tl.get_value_by_key("na"));
+    REQUIRE(nullptr == tl.get_value_by_key("name:e"));
+    REQUIRE(nullptr == tl.get_value_by_key("addr:housenumb"));
+    REQUIRE(nullptr == tl.get_value_by_key("addr:housenumberss"));
+    REQUIRE(nullptr == tl.get_value_by_key(""));
+    REQUIRE(tl.has_tag("addr:housenumbers", "11"));
+    REQUIRE_FALSE(tl.has_tag("addr:housenumbers", "10"));
+}
+
+TEST_CASE("get value by long key never reads beyond the tag list") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto pos = osmium::builder::add_tag_list(buffer,
+        _tag("abcdefghij", "v")
+    );
+    const osmium::TagList& orig = buffer.get<osmium::TagList>(pos);
+
+    // Copy tag list into memory of exactly the right size, so that any
+    // read beyond its end is detected by the address sanitizer.
+    const std::unique_ptr<unsigned char[]> data{new unsigned char[orig.padded_size()]};
+    std::memcpy(data.get(), orig.data(), orig.padded_size());
+    const auto& tl = *reinterpret_cast<const osmium::TagList*>(data.get());
+
+    const std::string long_key = "abcdefgh" + std::string(100, 'X');
+    REQUIRE(nullptr == tl.get_value_by_key(long_key.c_str()));
+    REQUIRE(nullptr == tl.get_value_by_key("abcdefghijk"));
+    REQUIRE(std::string("v") == tl.get_value_by_key("abcdefghij"));
+}
+
+TEST_CASE("get values by several keys") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto pos = osmium::builder::add_tag_list(buffer,
+        _tag("highway", "primary"),
+        _tag("name", "Main Street"),
+        _tag("ref", "B 1")
+    );
+    const osmium::TagList& tl = buffer.get<osmium::TagList>(pos);
+
+    const char* keys[] = {"name", "oneway", "highway", "name"};
+    const char* values[4] = {"x", "x", "x", "x"};
+    REQUIRE(tl.get_values_by_keys(keys, values) == 3);
+    REQUIRE(std::string("Main Street") == values[0]);
+    REQUIRE(nullptr == values[1]);
+    REQUIRE(std::string("primary") == values[2]);
+    REQUIRE(std::string("Main Street") == values[3]);
+
+    REQUIRE(tl.get_values_by_keys(keys, values, 1) == 1);
+    REQUIRE(std::string("Main Street") == values[0]);
+
+    const auto empty_pos = buffer.committed();
+    {
+        osmium::builder::TagListBuilder builder{buffer};
+    }
+    buffer.commit();
+    const osmium::TagList& empty = buffer.get<osmium::TagList>(empty_pos);
+    REQUIRE(empty.get_values_by_keys(keys, values) == 0);
+    REQUIRE(nullptr == values[0]);
+    REQUIRE(nullptr == values[2]);
+}
+
 TEST_CASE("tag key or value is too long") {
     osmium::memory::Buffer buffer{10240};
     osmium::builder::TagListBuilder builder{buffer};
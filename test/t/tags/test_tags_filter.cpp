@@ -172,3 +172,99 @@ TEST_CASE("TagsFilterBase") {
 
 }
 
+
+TEST_CASE("Compiled tags filter gives same results as tags filter") {
+    osmium::memory::Buffer buffer{10240};
+
+    const auto pos = osmium::builder::add_tag_list(buffer,
+        osmium::builder::attr::_tags({
+            { "highway", "primary" },
+            { "highway", "motorway" },
+            { "name", "Main Street" },
+            { "name:de", "Hauptstrasse" },
+            { "name_old", "High Street" },
+            { "source", "GPS" },
+            { "amenity", "restaurant" },
+            { "amenity", "bench" },
+            { "building", "yes" },
+            { "addr:street", "Main Street" },
+            { "n", "x" },
+            { "", "empty" }
+    }));
+    const osmium::TagList& tag_list = buffer.get<osmium::TagList>(pos);
+
+    using result_type = int;
+    osmium::TagsFilterBase<result_type> filter{-1};
+    filter.add_rule(1, "highway", "motorway")
+          .add_rule(2, osmium::StringMatcher::prefix{"name:"})
+          .add_rule(3, osmium::StringMatcher::list{{"amenity", "building"}}, osmium::StringMatcher::equal{"bench"}, true)
+          .add_rule(4, osmium::StringMatcher::substring{"Street"}) // key substring, never matches here
+          .add_rule(5, osmium::StringMatcher::always_true{}, osmium::StringMatcher::substring{"Street"})
+          .add_rule(6, osmium::StringMatcher::prefix{"name"})
+          .add_rule(7, "highway")
+          .add_rule(8, osmium::StringMatcher::always_false{})
+          .add_rule(9, osmium::StringMatcher::prefix{""}, osmium::StringMatcher::equal{"bench"})
+          .add_rule(10, osmium::StringMatcher::prefix{"n"});
+
+    const auto compiled = filter.compile();
+    REQUIRE(compiled.count() == filter.count());
+    REQUIRE_FALSE(compiled.empty());
+
+    for (const auto& tag : tag_list) {
+        REQUIRE(compiled(tag) == filter(tag));
+    }
+
+    auto it = tag_list.begin();
+    REQUIRE(compiled(*it++) == 7);  // highway=primary
+    REQUIRE(compiled(*it++) == 1);  // highway=motorway
+    REQUIRE(compiled(*it++) == 5);  // name=Main Street
+    REQUIRE(compiled(*it++) == 2);  // name:de=...
+    REQUIRE(compiled(*it++) == 5);  // name_old=High Street
+    REQUIRE(compiled(*it++) == -1); // source=GPS
+    REQUIRE(compiled(*it++) == 3);  // amenity=restaurant
+    REQUIRE(compiled(*it++) == 9);  // amenity=bench
+    REQUIRE(compiled(*it++) == 3);  // building=yes
+    REQUIRE(compiled(*it++) == 5);  // addr:street=Main Street
+    REQUIRE(compiled(*it++) == 10); // n=x
+    REQUIRE(compiled(*it++) == -1); // =empty
+
+    SECTION("Compiled filter is independent of original filter") {
+        filter.add_rule(11, "source");
+        REQUIRE(filter(*std::next(tag_list.begin(), 5)) == 11);
+        REQUIRE(compiled(*std::next(tag_list.begin(), 5)) == -1);
+    }
+
+    SECTION("Compiled filter with many rules") {
+        osmium::TagsFilterBase<result_type> big{-1};
+        for (int n = 0; n < 300; ++n) {
+            big.add_rule(n, "key" + std::to_string(n));
+        }
+        big.add_rule(1000, osmium::StringMatcher::prefix{"addr:"});
+        big.add_rule(1001, "highway", "primary");
+        big.add_rule(1002, osmium::StringMatcher::string_set{{"building", "source", "key7"}});
+        big.add_rule(1003, osmium::StringMatcher::always_true{}, osmium::StringMatcher::substrings{{"Street", "Goose"}});
+        const auto big_compiled = big.compile();
+        for (const auto& tag : tag_list) {
+            REQUIRE(big_compiled(tag) == big(tag));
+        }
+        REQUIRE(big_compiled(*std::next(tag_list.begin(), 5)) == 1002); // source=GPS
+        REQUIRE(big_compiled(*std::next(tag_list.begin(), 2)) == 1003); // name=Main Street
+    }
+
+    SECTION("Compiled empty filter") {
+        const auto empty = osmium::TagsFilter{}.compile();
+        REQUIRE(empty.empty());
+        REQUIRE_FALSE(empty(*tag_list.begin()));
+    }
+
+    SECTION("Compiled filter iterator filters tags") {
+        const auto bool_filter = osmium::TagsFilter{}
+            .add_rule(true, osmium::StringMatcher::prefix{"name"})
+            .compile();
+
+        const osmium::CompiledTagsFilter::iterator begin{std::cref(bool_filter), tag_list.begin(), tag_list.end()};
+        const osmium::CompiledTagsFilter::iterator end{std::cref(bool_filter), tag_list.end(), tag_list.end()};
+        REQUIRE(3 == std::distance(begin, end));
+    }
+}
+
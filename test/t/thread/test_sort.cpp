@@ -0,0 +1,71 @@
+#include "catch.hpp"
+
+#include <osmium/thread/pool.hpp>
+#include <osmium/thread/sort.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+static std::vector<uint64_t> random_data(std::size_t size) {
+    std::mt19937_64 gen{17}; // NOLINT(cert-msc32-c, cert-msc51-cpp)
+    std::uniform_int_distribution<uint64_t> dist{0, 100000};
+    std::vector<uint64_t> data;
+    data.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data.push_back(dist(gen));
+    }
+    return data;
+}
+
+TEST_CASE("Parallel sort of small range") {
+    osmium::thread::Pool pool{4};
+    auto data = random_data(1000);
+    auto expected = data;
+    std::sort(expected.begin(), expected.end());
+
+    osmium::thread::parallel_sort(pool, data.begin(), data.end());
+    REQUIRE(data == expected);
+}
+
+TEST_CASE("Parallel sort of empty range") {
+    osmium::thread::Pool pool{4};
+    std::vector<uint64_t> data;
+    osmium::thread::parallel_sort(pool, data.begin(), data.end());
+    REQUIRE(data.empty());
+}
+
+TEST_CASE("Parallel sort of large range") {
+    const auto data = random_data(500000);
+
+    for (const int num_threads : {2, 3, 4, 7}) {
+        osmium::thread::Pool pool{num_threads};
+
+        auto expected = data;
+        std::sort(expected.begin(), expected.end());
+        auto sorted = data;
+        osmium::thread::parallel_sort(pool, sorted.begin(), sorted.end());
+        REQUIRE(sorted == expected);
+
+        std::sort(expected.begin(), expected.end(), std::greater<>{});
+        sorted = data;
+        osmium::thread::parallel_sort(pool, sorted.begin(), sorted.end(), std::greater<>{});
+        REQUIRE(sorted == expected);
+    }
+}
+
+TEST_CASE("Parallel sort forwards exception from comparison") {
+    osmium::thread::Pool pool{4};
+    auto data = random_data(500000);
+    data[0] = 1000000; // only in the first part
+
+    REQUIRE_THROWS_AS(osmium::thread::parallel_sort(pool, data.begin(), data.end(), [](uint64_t a, uint64_t b) {
+        if (a == 1000000 || b == 1000000) {
+            throw std::runtime_error{"compare failed"};
+        }
+        return a < b;
+    }), const std::runtime_error&);
+}
@@ -0,0 +1,60 @@
+#include "catch.hpp"
+
+#include <osmium/util/aho_corasick.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+TEST_CASE("Aho-Corasick without patterns never matches") {
+    const osmium::AhoCorasick empty;
+    REQUIRE(empty.size() == 0);
+    REQUIRE_FALSE(empty("foo"));
+    REQUIRE_FALSE(empty(""));
+
+    const osmium::AhoCorasick none{std::vector<std::string>{}};
+    REQUIRE_FALSE(none("foo"));
+}
+
+TEST_CASE("Aho-Corasick with empty pattern always matches") {
+    const osmium::AhoCorasick ac{{"foo", ""}};
+    REQUIRE(ac("bar"));
+    REQUIRE(ac(""));
+}
+
+TEST_CASE("Aho-Corasick finds patterns") {
+    const osmium::AhoCorasick ac{{"he", "she", "his", "hers"}};
+    REQUIRE(ac.size() == 4);
+    REQUIRE(ac.count_nodes() == 10);
+
+    REQUIRE(ac("ushers"));
+    REQUIRE(ac("ahishers"));
+    REQUIRE(ac(std::string{"the"}));
+    REQUIRE(ac("sh_his"));
+    REQUIRE_FALSE(ac("hi"));
+    REQUIRE_FALSE(ac("sh"));
+    REQUIRE_FALSE(ac("h_e"));
+    REQUIRE_FALSE(ac(""));
+}
+
+TEST_CASE("Aho-Corasick gives same results as strstr") {
+    const std::vector<std::string> patterns{"abab", "bab", "aab", "bba", "abba", "babb"};
+    const osmium::AhoCorasick ac{patterns};
+
+    // All strings over {a, b} up to length 8.
+    for (int length = 0; length <= 8; ++length) {
+        for (int bits = 0; bits < (1 << length); ++bits) {
+            std::string str;
+            for (int i = 0; i < length; ++i) {
+                str += (bits & (1 << i)) ? 'b' : 'a';
+            }
+            const bool expected = std::any_of(patterns.cbegin(), patterns.cend(), [&](const std::string& pattern) {
+                return std::strstr(str.c_str(), pattern.c_str()) != nullptr;
+            });
+            INFO("string '" << str << "'");
+            REQUIRE(ac(str) == expected);
+        }
+    }
+}
+
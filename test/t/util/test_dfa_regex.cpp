@@ -0,0 +1,106 @@
+#include "catch.hpp"
+
+#include <osmium/util/dfa_regex.hpp>
+#include <osmium/util/string_matcher.hpp>
+
+#include <regex>
+#include <sstream>
+#include <string>
+
+TEST_CASE("DFA regex matches like regex_search") {
+    const osmium::DFARegex regex{"foo"};
+    REQUIRE(regex.pattern() == "foo");
+    REQUIRE(regex("foo"));
+    REQUIRE(regex("xfoox"));
+    REQUIRE(regex(std::string{"barfoo"}));
+    REQUIRE_FALSE(regex("fo"));
+    REQUIRE_FALSE(regex(""));
+}
+
+TEST_CASE("DFA regex with anchors") {
+    const osmium::DFARegex begin{"^foo"};
+    REQUIRE(begin("foobar"));
+    REQUIRE_FALSE(begin("xfoo"));
+
+    const osmium::DFARegex end{"foo$"};
+    REQUIRE(end("xfoo"));
+    REQUIRE_FALSE(end("foobar"));
+
+    const osmium::DFARegex both{"^foo$"};
+    REQUIRE(both("foo"));
+    REQUIRE_FALSE(both("foofoo"));
+}
+
+TEST_CASE("DFA regex with full match") {
+    const osmium::DFARegex regex{"name:(de|en)", true};
+    REQUIRE(regex("name:de"));
+    REQUIRE(regex("name:en"));
+    REQUIRE_FALSE(regex("name:de_x"));
+    REQUIRE_FALSE(regex("xname:de"));
+}
+
+TEST_CASE("DFA regex with classes and quantifiers") {
+    const osmium::DFARegex regex{"^[A-Z][a-z]*(-[A-Z][a-z]*)?\\s\\d{1,3}[^.]?$"};
+    REQUIRE(regex("Hauptstrasse 12"));
+    REQUIRE(regex("Ober-Ursel 7a"));
+    REQUIRE_FALSE(regex("hauptstrasse 12"));
+    REQUIRE_FALSE(regex("Hauptstrasse 12345"));
+    REQUIRE_FALSE(regex("Hauptstrasse 12."));
+    REQUIRE(regex.count_states() > 1);
+}
+
+TEST_CASE("DFA regex throws on invalid or unsupported patterns") {
+    REQUIRE_THROWS_AS(osmium::DFARegex{"("}, const osmium::dfa_regex_error&);
+    REQUIRE_THROWS_AS(osmium::DFARegex{"a)"}, const osmium::dfa_regex_error&);
+    REQUIRE_THROWS_AS(osmium::DFARegex{"[a-"}, const osmium::dfa_regex_error&);
+    REQUIRE_THROWS_AS(osmium::DFARegex{"[z-a]"}, const osmium::dfa_regex_error&);
+    REQUIRE_THROWS_AS(osmium::DFARegex{"*a"}, const osmium::dfa_regex_error&);
+    REQUIRE_THROWS_AS(osmium::DFARegex{"a{2"}, const osmium::dfa_regex_error&);
+    REQUIRE_THROWS_AS(osmium::DFARegex{"a{3,2}"}, const osmium::dfa_regex_error&);
+    REQUIRE_THROWS_AS(osmium::DFARegex{"a\\"}, const osmium::dfa_regex_error&);
+    REQUIRE_THROWS_AS(osmium::DFARegex{"(a)\\1"}, const osmium::dfa_regex_error&);
+    REQUIRE_THROWS_AS(osmium::DFARegex{"\\bword"}, const osmium::dfa_regex_error&);
+    REQUIRE_THROWS_AS(osmium::DFARegex{"(?=a)"}, const osmium::dfa_regex_error&);
+    REQUIRE_THROWS_AS(osmium::DFARegex{"a^b"}, const osmium::dfa_regex_error&);
+    REQUIRE_THROWS_AS(osmium::DFARegex{"^a|b"}, const osmium::dfa_regex_error&);
+    REQUIRE_THROWS_AS(osmium::DFARegex{"(a|b)*a.{20}$"}, const osmium::dfa_regex_error&);
+}
+
+TEST_CASE("String matcher: dfa_regex") {
+    const osmium::StringMatcher m{osmium::StringMatcher::dfa_regex{"^name:"}};
+    REQUIRE(m("name:de"));
+    REQUIRE_FALSE(m("name"));
+
+    std::ostringstream out;
+    out << m;
+    REQUIRE(out.str() == "dfa_regex[^name:]");
+}
+
+#ifdef OSMIUM_WITH_REGEX
+TEST_CASE("DFA regex gives same results as std::regex") {
+    const char* patterns[] = {
+        "", "abc", "^abc", "abc$", "^abc$", "a.c", "^a*$", "(ab|cd)+e",
+        "[^a-c]", "^\\d{2,3}$", "^\\w+:\\w+$", "^a{2,}$", "^(?:foo|bar)baz",
+        "colou?r", "\\.", "^.*$", "^$", "a|b|c", "[-a]", "[]a]", "^[\\d.]+$",
+        "^\\S+$", "name:(de|en|fr)$", "(a|ab)(c|bcd)(d*)", "\\x41"
+    };
+    const char* strings[] = {
+        "", "a", "abc", "xabc", "abcx", "aXc", "aaa", "b", "ababcde", "cde",
+        "123", "1234", "foo:bar", "barbaz", "color", "colour", "a.b",
+        "line\nbreak", "]", "-", "1.5", "two words", "name:de", "name:de_x",
+        "abcd", "A"
+    };
+
+    for (const auto* pattern : patterns) {
+        const std::regex std_regex{pattern};
+        const osmium::DFARegex search{pattern};
+        const osmium::DFARegex match{pattern, true};
+        for (const auto* str : strings) {
+            INFO("pattern '" << pattern << "' string '" << str << "'");
+            REQUIRE(search(str) == std::regex_search(str, std_regex));
+            REQUIRE(match(str) == std::regex_match(str, std_regex));
+        }
+    }
+}
+#endif
+
@@ -225,3 +225,38 @@ TEST_CASE("Move assign StringMatcher") {
     REQUIRE(print(m2) == "equal[foo]");
 }
 
+
+TEST_CASE("Access matcher inside StringMatcher") {
+    const osmium::StringMatcher m1{"foo"};
+    const osmium::StringMatcher m2{osmium::StringMatcher::prefix{"bar"}};
+    const osmium::StringMatcher m3{std::vector<std::string>{"a", "b"}};
+
+    REQUIRE(m1.get_if<osmium::StringMatcher::equal>());
+    REQUIRE(m1.get_if<osmium::StringMatcher::equal>()->str() == "foo");
+    REQUIRE_FALSE(m1.get_if<osmium::StringMatcher::prefix>());
+
+    REQUIRE(m2.get_if<osmium::StringMatcher::prefix>());
+    REQUIRE(m2.get_if<osmium::StringMatcher::prefix>()->str() == "bar");
+
+    REQUIRE(m3.get_if<osmium::StringMatcher::list>());
+    REQUIRE(m3.get_if<osmium::StringMatcher::list>()->strings().size() == 2);
+}
+
+TEST_CASE("String matcher: string_set") {
+    const osmium::StringMatcher m{osmium::StringMatcher::string_set{{"foo", "bar"}}};
+    REQUIRE(m("foo"));
+    REQUIRE(m("bar"));
+    REQUIRE_FALSE(m("foobar"));
+    REQUIRE_FALSE(m(""));
+    REQUIRE(print(m) == "string_set[[foo][bar]]");
+}
+
+TEST_CASE("String matcher: substrings") {
+    const osmium::StringMatcher m{osmium::StringMatcher::substrings{{"foo", "bar"}}};
+    REQUIRE(m("foo"));
+    REQUIRE(m("xbarx"));
+    REQUIRE(m("fobar"));
+    REQUIRE_FALSE(m("fo"));
+    REQUIRE_FALSE(m(""));
+    REQUIRE(print(m) == "substrings[[foo][bar]]");
+}
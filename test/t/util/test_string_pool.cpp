@@ -0,0 +1,84 @@
+#include "catch.hpp"
+
+#include <osmium/util/string_pool.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Empty string pool") {
+    const osmium::StringPool pool;
+    REQUIRE(pool.size() == 0);
+    REQUIRE(pool.find("foo") == osmium::StringPool::invalid_id);
+    REQUIRE(pool.find("") == osmium::StringPool::invalid_id);
+}
+
+TEST_CASE("Add strings to string pool") {
+    osmium::StringPool pool;
+
+    const auto foo = pool.add("foo");
+    const auto bar = pool.add(std::string{"bar"});
+    const auto empty = pool.add("");
+    REQUIRE(pool.size() == 3);
+
+    REQUIRE(foo != bar);
+    REQUIRE(foo != empty);
+    REQUIRE(bar != empty);
+
+    REQUIRE(pool.add("foo") == foo);
+    REQUIRE(pool.add("foobar", 3) == foo);
+    REQUIRE(pool.size() == 3);
+
+    REQUIRE(pool.find("foo") == foo);
+    REQUIRE(pool.find("bar") == bar);
+    REQUIRE(pool.find("") == empty);
+    REQUIRE(pool.find("baz") == osmium::StringPool::invalid_id);
+
+    REQUIRE(std::strcmp(pool.get(foo), "foo") == 0);
+    REQUIRE(std::strcmp(pool.get(bar), "bar") == 0);
+    REQUIRE(std::strcmp(pool.get(empty), "") == 0);
+}
+
+TEST_CASE("Pointers from string pool stay valid") {
+    osmium::StringPool pool;
+    const char* foo = pool.get(pool.add("foo"));
+
+    std::vector<uint32_t> ids;
+    for (int n = 0; n < 100000; ++n) {
+        ids.push_back(pool.add("value" + std::to_string(n)));
+    }
+    REQUIRE(pool.size() == 100001);
+
+    REQUIRE(std::strcmp(foo, "foo") == 0);
+    for (int n = 0; n < 100000; ++n) {
+        REQUIRE(pool.get(ids[n]) == "value" + std::to_string(n));
+    }
+}
+
+TEST_CASE("Add strings to string pool from several threads") {
+    osmium::StringPool pool;
+
+    const int num_threads = 4;
+    std::vector<std::vector<uint32_t>> ids(num_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&pool, &ids, t]() {
+            for (int n = 0; n < 10000; ++n) {
+                ids[t].push_back(pool.add("key" + std::to_string(n)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(pool.size() == 10000);
+    for (int t = 1; t < num_threads; ++t) {
+        REQUIRE(ids[t] == ids[0]);
+    }
+    for (int n = 0; n < 10000; ++n) {
+        REQUIRE(pool.get(ids[0][n]) == "key" + std::to_string(n));
+    }
+}
@@ -0,0 +1,53 @@
+#include "catch.hpp"
+
+#include <osmium/util/string_set.hpp>
+
+#include <string>
+#include <vector>
+
+TEST_CASE("Empty string set") {
+    const osmium::StringSet set;
+    REQUIRE(set.empty());
+    REQUIRE(set.size() == 0);
+    REQUIRE_FALSE(set.contains("foo"));
+    REQUIRE_FALSE(set.contains(""));
+    REQUIRE(set.find("foo") == osmium::StringSet::npos);
+}
+
+TEST_CASE("String set") {
+    const osmium::StringSet set{{"foo", "bar", "", "foo", "foobar"}};
+    REQUIRE_FALSE(set.empty());
+    REQUIRE(set.size() == 4);
+
+    REQUIRE(set.contains("foo"));
+    REQUIRE(set.contains(std::string{"bar"}));
+    REQUIRE(set.contains(""));
+    REQUIRE(set.contains("foobar"));
+    REQUIRE_FALSE(set.contains("fo"));
+    REQUIRE_FALSE(set.contains("foob"));
+    REQUIRE_FALSE(set.contains("baz"));
+
+    REQUIRE(set.find("foo") == 0);
+    REQUIRE(set.find("bar") == 1);
+    REQUIRE(set.find("") == 2);
+    REQUIRE(set.find("foobar") == 4);
+}
+
+TEST_CASE("String set with many strings") {
+    std::vector<std::string> strings;
+    for (int n = 0; n < 10000; n += 2) {
+        strings.push_back("brand" + std::to_string(n));
+    }
+    const osmium::StringSet set{strings};
+    REQUIRE(set.size() == 5000);
+
+    for (int n = 0; n < 10000; ++n) {
+        const auto str = "brand" + std::to_string(n);
+        if (n % 2 == 0) {
+            REQUIRE(set.find(str.c_str()) == static_cast<std::size_t>(n / 2));
+        } else {
+            REQUIRE_FALSE(set.contains(str));
+        }
+    }
+}
+